@@ -0,0 +1,464 @@
+#include <batch.h>
+#include <binder.h>
+#include <buffer.h>
+#include <objectpool.h>
+#include <foreignregistry.h>
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Measures binding every foreign method of a set of plugins, as Wren does
+// while it compiles their module code: once by asking each plugin in turn
+// with a freshly formatted key, and once through the shared registry.
+
+static const int FUNCTIONS_PER_PLUGIN = 50;
+
+static void foreign_stub(WrenVM*)
+{
+}
+
+struct Plugins
+{
+	std::vector<std::unique_ptr<ForeignFunctions>>	plugins;
+	std::vector<std::string>						modules;
+	ForeignRegistry									registry;
+
+	explicit Plugins(int count)
+	{
+		for (int p = 0; p < count; ++p)
+		{
+			auto plugin = std::make_unique<ForeignFunctions>();
+			std::string module_name = "plugin" + std::to_string(p);
+			for (int f = 0; f < FUNCTIONS_PER_PLUGIN; ++f)
+				plugin->bind((module_name + ".Native.function" + std::to_string(f) + "(_,_)").c_str(), foreign_stub);
+			plugin->enumerate([](void* context, const char* name, void (*func)(WrenVM*))
+			{
+				static_cast<ForeignRegistry*>(context)->add(name, func, "plugin");
+			}, &registry);
+			modules.push_back(module_name);
+			plugins.push_back(std::move(plugin));
+		}
+	}
+};
+
+static std::string signature(int f)
+{
+	return "function" + std::to_string(f) + "(_,_)";
+}
+
+static void BM_BindPerPlugin(benchmark::State& state)
+{
+	Plugins plugins(int(state.range(0)));
+	std::vector<std::string> signatures;
+	for (int f = 0; f < FUNCTIONS_PER_PLUGIN; ++f)
+		signatures.push_back(signature(f));
+	for (auto _ : state)
+	{
+		for (const auto& module_name : plugins.modules)
+		{
+			for (const auto& sig : signatures)
+			{
+				std::ostringstream os;
+				os << module_name << "." << "Native" << "." << sig;
+				std::string key = os.str();
+				void* func = nullptr;
+				for (const auto& plugin : plugins.plugins)
+				{
+					func = (void*)plugin->get(key);
+					if (func) break;
+				}
+				benchmark::DoNotOptimize(func);
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * FUNCTIONS_PER_PLUGIN);
+}
+BENCHMARK(BM_BindPerPlugin)->Arg(1)->Arg(8)->Arg(32);
+
+static void BM_BindRegistry(benchmark::State& state)
+{
+	Plugins plugins(int(state.range(0)));
+	std::vector<std::string> signatures;
+	for (int f = 0; f < FUNCTIONS_PER_PLUGIN; ++f)
+		signatures.push_back(signature(f));
+	std::string key;
+	for (auto _ : state)
+	{
+		for (const auto& module_name : plugins.modules)
+		{
+			for (const auto& sig : signatures)
+			{
+				key.assign(module_name).append(".").append("Native").append(".").append(sig);
+				WrenForeignMethodFn func = plugins.registry.find(key);
+				benchmark::DoNotOptimize(func);
+			}
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0) * FUNCTIONS_PER_PLUGIN);
+}
+BENCHMARK(BM_BindRegistry)->Arg(1)->Arg(8)->Arg(32);
+
+// What a plugin's GetFunction costs per name: the runtime map needs a
+// std::string for every lookup, the generated sorted table doesn't.
+static void BM_GetFunctionMap(benchmark::State& state)
+{
+	Plugins plugins(1);
+	std::vector<std::string> names;
+	for (int f = 0; f < FUNCTIONS_PER_PLUGIN; ++f)
+		names.push_back("plugin0.Native." + signature(f));
+	const ForeignFunctions& plugin = *plugins.plugins[0];
+	for (auto _ : state)
+	{
+		for (const auto& name : names)
+			benchmark::DoNotOptimize(plugin.get(name.c_str()));
+	}
+	state.SetItemsProcessed(state.iterations() * FUNCTIONS_PER_PLUGIN);
+}
+BENCHMARK(BM_GetFunctionMap);
+
+static void BM_GetFunctionTable(benchmark::State& state)
+{
+	std::vector<std::string> names;
+	for (int f = 0; f < FUNCTIONS_PER_PLUGIN; ++f)
+		names.push_back("plugin0.Native." + signature(f));
+	std::vector<ForeignBinding> table;
+	for (const auto& name : names)
+		table.push_back({ name, foreign_stub });
+	std::sort(table.begin(), table.end(), [](const ForeignBinding& a, const ForeignBinding& b)
+	{
+		return a.name < b.name;
+	});
+	for (auto _ : state)
+	{
+		for (const auto& name : names)
+			benchmark::DoNotOptimize(find_binding(table.data(), table.data() + table.size(), name.c_str()));
+	}
+	state.SetItemsProcessed(state.iterations() * FUNCTIONS_PER_PLUGIN);
+}
+BENCHMARK(BM_GetFunctionTable);
+
+// A generated wrapper against the one bind<> deduces, called on a VM whose
+// slots hold the arguments, as Wren leaves them for a foreign method.
+struct Native
+{
+	static double Add(double a, double b) { return a + b; }
+	static bool Contains(const std::string& text, const char* part) { return text.find(part) != std::string::npos; }
+};
+
+static void native_Native_Add_wrapper(WrenVM* vm)
+{
+	double a = wrenGetSlotDouble(vm, 1);
+	double b = wrenGetSlotDouble(vm, 2);
+	double result = Native::Add(a,b);
+	wrenSetSlotDouble(vm, 0, result);
+}
+
+static void native_Native_Contains_wrapper(WrenVM* vm)
+{
+	std::string text = wrenGetSlotString(vm, 1);
+	const char* part = wrenGetSlotString(vm, 2);
+	bool result = Native::Contains(text,part);
+	wrenSetSlotBool(vm, 0, result);
+}
+
+struct SlotVM
+{
+	WrenVM*		vm;
+
+	SlotVM(bool strings)
+	{
+		WrenConfiguration config;
+		wrenInitConfiguration(&config);
+		vm = wrenNewVM(&config);
+		wrenEnsureSlots(vm, 3);
+		if (strings)
+		{
+			wrenSetSlotString(vm, 1, "a line of text to look in");
+			wrenSetSlotString(vm, 2, "look");
+		}
+		else
+		{
+			wrenSetSlotDouble(vm, 1, 1.5);
+			wrenSetSlotDouble(vm, 2, 2.5);
+		}
+	}
+
+	~SlotVM()
+	{
+		wrenFreeVM(vm);
+	}
+};
+
+static void run_wrapper(benchmark::State& state, ForeignFunctions::wrapper func, bool strings)
+{
+	SlotVM slots(strings);
+	for (auto _ : state)
+	{
+		func(slots.vm);
+		benchmark::ClobberMemory();
+	}
+}
+
+static void BM_WrapperGenerated(benchmark::State& state)
+{
+	run_wrapper(state, native_Native_Add_wrapper, false);
+}
+BENCHMARK(BM_WrapperGenerated);
+
+static void BM_WrapperTemplate(benchmark::State& state)
+{
+	run_wrapper(state, foreign_wrapper<&Native::Add>, false);
+}
+BENCHMARK(BM_WrapperTemplate);
+
+static void BM_WrapperGeneratedStrings(benchmark::State& state)
+{
+	run_wrapper(state, native_Native_Contains_wrapper, true);
+}
+BENCHMARK(BM_WrapperGeneratedStrings);
+
+static void BM_WrapperTemplateStrings(benchmark::State& state)
+{
+	run_wrapper(state, foreign_wrapper<&Native::Contains>, true);
+}
+BENCHMARK(BM_WrapperTemplateStrings);
+
+// A payload through a plugin function that changes it.  Bytes are copied
+// into the string the function returns, and again into the Wren string made
+// from it; a Buffer is changed in place and handed back.
+static std::string invert_bytes(const Bytes& data)
+{
+	std::string result(data.data, size_t(data.length));
+	for (auto& c : result)
+		c = char(~c);
+	return result;
+}
+
+static Buffer invert_buffer(const Buffer& data)
+{
+	uint8_t* bytes = data.data();
+	size_t size = data.size();
+	for (size_t i = 0; i < size; ++i)
+		bytes[i] = uint8_t(~bytes[i]);
+	return data;
+}
+
+static void native_invert_bytes_wrapper(WrenVM* vm)
+{
+	Bytes data;
+	data.data = wrenGetSlotBytes(vm, 1, &data.length);
+	std::string result = invert_bytes(data);
+	wrenSetSlotBytes(vm, 0, result.data(), result.size());
+}
+
+static void BM_PayloadBytes(benchmark::State& state)
+{
+	SlotVM slots(false);
+	std::string payload(size_t(state.range(0)), 'x');
+	wrenSetSlotBytes(slots.vm, 1, payload.data(), payload.size());
+	for (auto _ : state)
+	{
+		native_invert_bytes_wrapper(slots.vm);
+		benchmark::ClobberMemory();
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PayloadBytes)->Arg(64 << 10)->Arg(8 << 20);
+
+static void BM_PayloadBuffer(benchmark::State& state)
+{
+	SlotVM slots(false);
+	SlotTraits<Buffer>::set(slots.vm, 1, Buffer(size_t(state.range(0))));
+	for (auto _ : state)
+	{
+		foreign_wrapper<&invert_buffer>(slots.vm);
+		benchmark::ClobberMemory();
+		// What the finalizer does when the result is collected
+		std::destroy_at(&SlotTraits<Buffer>::get(slots.vm, 0));
+	}
+	std::destroy_at(&SlotTraits<Buffer>::get(slots.vm, 1));
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_PayloadBuffer)->Arg(64 << 10)->Arg(8 << 20);
+
+// Small native objects created and dropped in bulk: from an ObjectPool, or
+// new/delete.  Foreign objects of scripts use neither, as they are stored in
+// the object Wren allocates for them.
+struct Point
+{
+	double x, y, z;
+	Point(double x, double y, double z) : x(x), y(y), z(z) {}
+};
+
+static void BM_ObjectsHeap(benchmark::State& state)
+{
+	std::vector<Point*> live(size_t(state.range(0)));
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < live.size(); ++i)
+			live[i] = new Point(double(i), 0, 0);
+		benchmark::ClobberMemory();
+		for (auto* point : live)
+			delete point;
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ObjectsHeap)->Arg(1000)->Arg(1000000);
+
+static void BM_ObjectsPool(benchmark::State& state)
+{
+	ObjectPool<Point> pool;
+	std::vector<Point*> live(size_t(state.range(0)));
+	for (auto _ : state)
+	{
+		for (size_t i = 0; i < live.size(); ++i)
+			live[i] = pool.create(double(i), 0, 0);
+		benchmark::ClobberMemory();
+		for (auto* point : live)
+			pool.destroy(point);
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ObjectsPool)->Arg(1000)->Arg(1000000);
+
+// Numbers to and from a plugin: as a Wren List through SlotTraits, or the
+// way plugins did it before, as one comma-joined string.  The Wren side of
+// the string path (split and Num.fromString) comes on top of this.
+static std::vector<double> sample_values(size_t count)
+{
+	std::vector<double> values(count);
+	for (size_t i = 0; i < count; ++i)
+		values[i] = double(i) * 0.25;
+	return values;
+}
+
+static void BM_ListOut(benchmark::State& state)
+{
+	SlotVM slots(false);
+	std::vector<double> values = sample_values(size_t(state.range(0)));
+	for (auto _ : state)
+	{
+		SlotTraits<std::vector<double>>::set(slots.vm, 0, values);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListOut)->Arg(100)->Arg(10000);
+
+static void BM_StringOut(benchmark::State& state)
+{
+	SlotVM slots(false);
+	std::vector<double> values = sample_values(size_t(state.range(0)));
+	for (auto _ : state)
+	{
+		std::ostringstream os;
+		for (size_t i = 0; i < values.size(); ++i)
+			os << (i ? "," : "") << values[i];
+		wrenSetSlotString(slots.vm, 0, os.str().c_str());
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StringOut)->Arg(100)->Arg(10000);
+
+static void BM_ListIn(benchmark::State& state)
+{
+	SlotVM slots(false);
+	SlotTraits<std::vector<double>>::set(slots.vm, 1, sample_values(size_t(state.range(0))));
+	for (auto _ : state)
+	{
+		std::vector<double> values = SlotTraits<std::vector<double>>::get(slots.vm, 1);
+		benchmark::DoNotOptimize(values.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ListIn)->Arg(100)->Arg(10000);
+
+static void BM_StringIn(benchmark::State& state)
+{
+	SlotVM slots(false);
+	std::ostringstream os;
+	std::vector<double> input = sample_values(size_t(state.range(0)));
+	for (size_t i = 0; i < input.size(); ++i)
+		os << (i ? "," : "") << input[i];
+	wrenSetSlotString(slots.vm, 1, os.str().c_str());
+	for (auto _ : state)
+	{
+		const char* text = wrenGetSlotString(slots.vm, 1);
+		std::vector<double> values;
+		char* end = nullptr;
+		while (*text)
+		{
+			values.push_back(std::strtod(text, &end));
+			text = *end == ',' ? end + 1 : end;
+		}
+		benchmark::DoNotOptimize(values.data());
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_StringIn)->Arg(100)->Arg(10000);
+
+// Native.Add over N pairs: one foreign call per pair, each with its slot
+// traffic, or one batch call over two Lists.  Wren's own cost per call
+// (dispatch, fiber switch to the foreign method) only applies to the first.
+static void BM_AddOneByOne(benchmark::State& state)
+{
+	SlotVM slots(false);
+	std::vector<double> a = sample_values(size_t(state.range(0)));
+	double sum = 0;
+	for (auto _ : state)
+	{
+		for (double value : a)
+		{
+			wrenSetSlotDouble(slots.vm, 1, value);
+			wrenSetSlotDouble(slots.vm, 2, value);
+			native_Native_Add_wrapper(slots.vm);
+			sum += wrenGetSlotDouble(slots.vm, 0);
+		}
+	}
+	benchmark::DoNotOptimize(sum);
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddOneByOne)->Arg(10000);
+
+static void BM_AddBatch(benchmark::State& state)
+{
+	SlotVM slots(false);
+	std::vector<double> a = sample_values(size_t(state.range(0)));
+	SlotTraits<std::vector<double>>::set(slots.vm, 1, a);
+	SlotTraits<std::vector<double>>::set(slots.vm, 2, a);
+	for (auto _ : state)
+	{
+		foreign_batch_wrapper<&Native::Add>(slots.vm);
+		benchmark::ClobberMemory();
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddBatch)->Arg(10000);
+
+static void BM_AddBatchBuffer(benchmark::State& state)
+{
+	SlotVM slots(false);
+	std::vector<double> a = sample_values(size_t(state.range(0)));
+	Buffer values(a.size() * sizeof(double));
+	std::memcpy(values.data(), a.data(), values.size());
+	SlotTraits<Buffer>::set(slots.vm, 1, values);
+	SlotTraits<Buffer>::set(slots.vm, 2, values);
+	for (auto _ : state)
+	{
+		foreign_batch_wrapper<&Native::Add>(slots.vm);
+		benchmark::ClobberMemory();
+		std::destroy_at(&SlotTraits<Buffer>::get(slots.vm, 0));
+	}
+	std::destroy_at(&SlotTraits<Buffer>::get(slots.vm, 1));
+	std::destroy_at(&SlotTraits<Buffer>::get(slots.vm, 2));
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_AddBatchBuffer)->Arg(10000);
+
+BENCHMARK_MAIN();
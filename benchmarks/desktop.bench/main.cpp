@@ -0,0 +1,166 @@
+#include <conwin.h>
+#include <console.h>
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+
+// Measures Desktop::draw on the memory console, so only conwin's own work is
+// timed and no terminal is needed.  cells/draw is what a terminal backend
+// would have been handed.
+
+enum LayoutKind
+{
+	Single,		// One full screen window
+	Debugger,	// Project, Code, Vars and Output, like gubed's default layout
+	Grid		// Four by four small windows
+};
+
+struct Layout
+{
+	Console					console;
+	Desktop					desktop;
+	std::vector<WindowPtr>	windows;
+	WindowPtr				code;
+
+	Layout(LayoutKind kind, size_t code_lines)
+		: console(ConsoleBackend::Memory, 300, 90)
+		, desktop(console)
+	{
+		Rect r = console.get_rect();
+		switch (kind)
+		{
+			case Single:
+				add(Rect(0, 0, r.width, r.height));
+				break;
+			case Debugger:
+			{
+				int top = r.height * 60 / 100;
+				int left = r.width * 30 / 100;
+				int half = r.width / 2;
+				add(Rect(0, 0, left, top));
+				add(Rect(left, 0, r.width - left, top));
+				add(Rect(0, top, half, r.height - top));
+				add(Rect(half, top, r.width - half, r.height - top));
+				code = windows[1];
+			} break;
+			case Grid:
+				for (int y = 0; y < 4; ++y)
+					for (int x = 0; x < 4; ++x)
+						add(Rect(x * r.width / 4, y * r.height / 4, r.width / 4, r.height / 4));
+				break;
+		}
+		if (!code)
+			code = windows[0];
+
+		std::vector<xstring> lines;
+		for (size_t i = 0; i < code_lines; ++i)
+			lines.push_back("\tvar value" + std::to_string(i) + " = compute(" + std::to_string(i) + ") // step here");
+		for (auto& w : windows)
+			w->set_content(w == code ? lines : std::vector<xstring>(lines.begin(), lines.begin() + std::min<size_t>(lines.size(), 100)));
+		code->set_highlight_line(0);
+		desktop.draw(code);
+	}
+
+	void add(const Rect& rect)
+	{
+		auto w = std::make_shared<Window>(rect);
+		w->set_title("Window " + std::to_string(windows.size()));
+		windows.push_back(w);
+		desktop.add_window(w);
+	}
+};
+
+static void report_cells(benchmark::State& state, const Layout& layout, size_t start_cells)
+{
+	state.counters["cells/draw"] = benchmark::Counter(double(layout.console.get_stats().cells - start_cells) / double(state.iterations()));
+}
+
+// The highlighted line moves in the Code window, as on a debugger step
+static void BM_Step(benchmark::State& state)
+{
+	Layout layout(LayoutKind(state.range(0)), size_t(state.range(1)));
+	size_t start = layout.console.get_stats().cells;
+	int direction = 1;
+	for (auto _ : state)
+	{
+		int line = layout.code->get_highlight_line();
+		if (line + direction < 0 || line + direction >= int(layout.code->get_line_count()))
+			direction = -direction;
+		layout.code->change_highlight_line(direction);
+		layout.desktop.draw(layout.code);
+	}
+	report_cells(state, layout, start);
+}
+BENCHMARK(BM_Step)->ArgsProduct({ { Single, Debugger, Grid }, { 100, 100000 } });
+
+// Colors every other word, standing in for syntax highlighting
+class WordStyler : public LineStyler
+{
+	std::vector<StyleRun>	m_Runs;
+public:
+	StyleRunRange style_line(size_t /*index*/, std::string_view text) override
+	{
+		m_Runs.clear();
+		bool odd = false;
+		for (size_t i = 0; i < text.size(); ++i)
+		{
+			if (text[i] != ' ' && (i == 0 || text[i - 1] == ' ') && (odd = !odd))
+			{
+				size_t end = text.find(' ', i);
+				m_Runs.push_back({ uint16_t(i), uint16_t(std::min(end, text.size()) - i), Color::Cyan });
+			}
+		}
+		return { m_Runs.data(), m_Runs.data() + m_Runs.size() };
+	}
+
+	void invalidate(size_t /*first_line*/) override {}
+};
+
+// The same step with the Code window styled
+static void BM_StyledStep(benchmark::State& state)
+{
+	Layout layout(Debugger, size_t(state.range(0)));
+	layout.code->set_line_styler(std::make_shared<WordStyler>());
+	layout.desktop.draw(layout.code);
+	size_t start = layout.console.get_stats().cells;
+	int direction = 1;
+	for (auto _ : state)
+	{
+		int line = layout.code->get_highlight_line();
+		if (line + direction < 0 || line + direction >= int(layout.code->get_line_count()))
+			direction = -direction;
+		layout.code->change_highlight_line(direction);
+		layout.desktop.draw(layout.code);
+	}
+	report_cells(state, layout, start);
+}
+BENCHMARK(BM_StyledStep)->Arg(100)->Arg(50000);
+
+// Every window redrawn, as after a resize or a new layout
+static void BM_FullRedraw(benchmark::State& state)
+{
+	Layout layout(LayoutKind(state.range(0)), size_t(state.range(1)));
+	size_t start = layout.console.get_stats().cells;
+	for (auto _ : state)
+	{
+		layout.console.clear();
+		for (auto& w : layout.windows)
+			w->invalidate();
+		layout.desktop.draw(layout.code);
+	}
+	report_cells(state, layout, start);
+}
+BENCHMARK(BM_FullRedraw)->ArgsProduct({ { Single, Debugger, Grid }, { 100, 100000 } });
+
+// Nothing changed since the last draw
+static void BM_IdleRedraw(benchmark::State& state)
+{
+	Layout layout(LayoutKind(state.range(0)), 1000);
+	size_t start = layout.console.get_stats().cells;
+	for (auto _ : state)
+		layout.desktop.draw(layout.code);
+	report_cells(state, layout, start);
+}
+BENCHMARK(BM_IdleRedraw)->Arg(Single)->Arg(Debugger)->Arg(Grid);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,81 @@
+#include <fileio.h>
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+
+// Reading a whole file for a script: into a string, as a plugin returning
+// the content as a Wren string does, against read_file, which maps large
+// files into a Buffer.  Each pass reads every 4096th byte, as a script
+// touching the data would.
+
+static std::string make_file(size_t size)
+{
+	std::string path = (std::filesystem::temp_directory_path() / ("fileio_bench_" + std::to_string(size))).string();
+	if (!std::filesystem::exists(path) || std::filesystem::file_size(path) != size)
+	{
+		std::ofstream f(path, std::ios::binary);
+		std::string block(1 << 16, 'x');
+		for (size_t written = 0; written < size; written += block.size())
+			f.write(block.data(), std::streamsize(std::min(block.size(), size - written)));
+	}
+	return path;
+}
+
+static uint64_t touch(const uint8_t* data, size_t size)
+{
+	uint64_t sum = 0;
+	for (size_t i = 0; i < size; i += 4096)
+		sum += data[i];
+	return sum;
+}
+
+static void BM_ReadString(benchmark::State& state)
+{
+	size_t size = size_t(state.range(0));
+	std::string path = make_file(size);
+	for (auto _ : state)
+	{
+		std::ifstream f(path, std::ios::binary);
+		std::ostringstream os;
+		os << f.rdbuf();
+		std::string content = os.str();
+		benchmark::DoNotOptimize(touch(reinterpret_cast<const uint8_t*>(content.data()), content.size()));
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ReadString)->Arg(64 << 10)->Arg(64 << 20);
+
+static void BM_ReadBuffer(benchmark::State& state)
+{
+	size_t size = size_t(state.range(0));
+	std::string path = make_file(size);
+	for (auto _ : state)
+	{
+		Buffer buffer = read_file(path);
+		benchmark::DoNotOptimize(touch(buffer.data(), buffer.size()));
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_ReadBuffer)->Arg(64 << 10)->Arg(64 << 20);
+
+static void BM_Stream(benchmark::State& state)
+{
+	size_t size = 64 << 20;
+	std::string path = make_file(size);
+	for (auto _ : state)
+	{
+		FileReader reader(path, size_t(state.range(0)));
+		uint64_t sum = 0;
+		for (Buffer chunk = reader.read(); !chunk.empty(); chunk = reader.read())
+			sum += touch(chunk.data(), chunk.size());
+		benchmark::DoNotOptimize(sum);
+	}
+	state.SetBytesProcessed(state.iterations() * int64_t(size));
+}
+BENCHMARK(BM_Stream)->Arg(64 << 10)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,187 @@
+#include "kernels.h"
+#include <benchmark/benchmark.h>
+#include <string>
+#include <vector>
+#include <wren.hpp>
+
+// Each numeric kernel of native_numeric, scalar and AVX2, against the same
+// loop written in Wren over a List, as a script does it without the plugin.
+//
+//   ./numeric.bench --benchmark_filter=sum
+
+enum class Kernel { Add, Mul, Fma, Sum, Dot, Min, Max, PrefixSum };
+
+struct Arrays
+{
+	std::vector<double>	a, b, c;
+
+	explicit Arrays(size_t n)
+		: a(n), b(n, 1.0), c(n, 0.5)
+	{
+		for (size_t i = 0; i < n; ++i)
+			a[i] = double(i % 7) * 0.5;
+	}
+};
+
+static double run_kernel(const NumericKernels& k, Kernel kernel, Arrays& arrays)
+{
+	double* a = arrays.a.data();
+	size_t n = arrays.a.size();
+	switch (kernel)
+	{
+	case Kernel::Add:		k.add(a, arrays.b.data(), n); return a[0];
+	case Kernel::Mul:		k.mul(a, arrays.b.data(), n); return a[0];
+	case Kernel::Fma:		k.fma(a, arrays.b.data(), arrays.c.data(), n); return a[0];
+	case Kernel::Sum:		return k.sum(a, n);
+	case Kernel::Dot:		return k.dot(a, arrays.b.data(), n);
+	case Kernel::Min:		return k.min(a, n);
+	case Kernel::Max:		return k.max(a, n);
+	case Kernel::PrefixSum:	k.prefix_sum(a, n); return a[n - 1];
+	}
+	return 0;
+}
+
+static void run_native(benchmark::State& state, const NumericKernels* k, Kernel kernel)
+{
+	if (!k)
+	{
+		state.SkipWithError("not supported by this CPU");
+		return;
+	}
+	Arrays arrays(size_t(state.range(0)));
+	for (auto _ : state)
+	{
+		// The prefix sum would overflow if it kept running on its own output
+		if (kernel == Kernel::PrefixSum)
+			std::fill(arrays.a.begin(), arrays.a.end(), 1.0);
+		benchmark::DoNotOptimize(run_kernel(*k, kernel, arrays));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+static void BM_Scalar(benchmark::State& state, Kernel kernel)
+{
+	run_native(state, &get_scalar_kernels(), kernel);
+}
+
+static void BM_AVX2(benchmark::State& state, Kernel kernel)
+{
+	run_native(state, get_avx2_kernels(), kernel);
+}
+
+// The Wren side keeps its arrays in static fields, filled once by init(_)
+static const char* wren_loops = R"(
+class Loop {
+	static init(n) {
+		__a = List.filled(n, 0)
+		__b = List.filled(n, 1)
+		__c = List.filled(n, 0.5)
+		for (i in 0...n) __a[i] = (i % 7) * 0.5
+	}
+	static add() {
+		for (i in 0...__a.count) __a[i] = __a[i] + __b[i]
+		return __a[0]
+	}
+	static mul() {
+		for (i in 0...__a.count) __a[i] = __a[i] * __b[i]
+		return __a[0]
+	}
+	static fma() {
+		for (i in 0...__a.count) __a[i] = __a[i] * __b[i] + __c[i]
+		return __a[0]
+	}
+	static sum() {
+		var s = 0
+		for (x in __a) s = s + x
+		return s
+	}
+	static dot() {
+		var s = 0
+		for (i in 0...__a.count) s = s + __a[i] * __b[i]
+		return s
+	}
+	static min() {
+		var m = __a[0]
+		for (x in __a) if (x < m) m = x
+		return m
+	}
+	static max() {
+		var m = __a[0]
+		for (x in __a) if (x > m) m = x
+		return m
+	}
+	static prefixSum() {
+		for (i in 0...__a.count) __a[i] = 1
+		var s = 0
+		for (i in 0...__a.count) {
+			s = s + __a[i]
+			__a[i] = s
+		}
+		return s
+	}
+}
+)";
+
+static const char* wren_signature(Kernel kernel)
+{
+	switch (kernel)
+	{
+	case Kernel::Add:		return "add()";
+	case Kernel::Mul:		return "mul()";
+	case Kernel::Fma:		return "fma()";
+	case Kernel::Sum:		return "sum()";
+	case Kernel::Dot:		return "dot()";
+	case Kernel::Min:		return "min()";
+	case Kernel::Max:		return "max()";
+	case Kernel::PrefixSum:	return "prefixSum()";
+	}
+	return "";
+}
+
+static void BM_WrenLoop(benchmark::State& state, Kernel kernel)
+{
+	WrenConfiguration config;
+	wrenInitConfiguration(&config);
+	WrenVM* vm = wrenNewVM(&config);
+	if (wrenInterpret(vm, "main", wren_loops) != WREN_RESULT_SUCCESS)
+	{
+		state.SkipWithError("the Wren loops do not compile");
+		wrenFreeVM(vm);
+		return;
+	}
+	wrenEnsureSlots(vm, 2);
+	wrenGetVariable(vm, "main", "Loop", 0);
+	WrenHandle* loop = wrenGetSlotHandle(vm, 0);
+	WrenHandle* init = wrenMakeCallHandle(vm, "init(_)");
+	WrenHandle* method = wrenMakeCallHandle(vm, wren_signature(kernel));
+	wrenSetSlotDouble(vm, 1, double(state.range(0)));
+	wrenCall(vm, init);
+	for (auto _ : state)
+	{
+		wrenEnsureSlots(vm, 1);
+		wrenSetSlotHandle(vm, 0, loop);
+		wrenCall(vm, method);
+		benchmark::DoNotOptimize(wrenGetSlotDouble(vm, 0));
+	}
+	state.SetItemsProcessed(state.iterations() * state.range(0));
+	wrenReleaseHandle(vm, method);
+	wrenReleaseHandle(vm, init);
+	wrenReleaseHandle(vm, loop);
+	wrenFreeVM(vm);
+}
+
+#define NUMERIC_BENCHMARKS(name, kernel) \
+	BENCHMARK_CAPTURE(BM_Scalar, name, kernel)->Arg(1000)->Arg(1000000); \
+	BENCHMARK_CAPTURE(BM_AVX2, name, kernel)->Arg(1000)->Arg(1000000); \
+	BENCHMARK_CAPTURE(BM_WrenLoop, name, kernel)->Arg(1000)->Arg(1000000)
+
+NUMERIC_BENCHMARKS(add, Kernel::Add);
+NUMERIC_BENCHMARKS(mul, Kernel::Mul);
+NUMERIC_BENCHMARKS(fma, Kernel::Fma);
+NUMERIC_BENCHMARKS(sum, Kernel::Sum);
+NUMERIC_BENCHMARKS(dot, Kernel::Dot);
+NUMERIC_BENCHMARKS(min, Kernel::Min);
+NUMERIC_BENCHMARKS(max, Kernel::Max);
+NUMERIC_BENCHMARKS(prefix_sum, Kernel::PrefixSum);
+
+BENCHMARK_MAIN();
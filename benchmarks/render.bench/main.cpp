@@ -0,0 +1,101 @@
+#include <conwin.h>
+#include <benchmark/benchmark.h>
+#include <iostream>
+#ifndef _WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// Measures what one debugger step costs on the terminal console: the
+// highlighted line moves in the Code pane and the desktop is redrawn.
+//
+// The console writes to stdout, so redirect stdout to a file to get the
+// number of bytes sent to the terminal per step.  The report goes to stderr:
+//
+//   TERM=xterm-256color COLUMNS=300 LINES=90 ./render.bench > /tmp/render.tty
+
+static double bytes_written()
+{
+#ifndef _WIN32
+	struct stat st;
+	if (fstat(STDOUT_FILENO, &st) == 0 && S_ISREG(st.st_mode))
+		return double(st.st_size);
+#endif
+	return 0;
+}
+
+struct Layout
+{
+	Desktop		desktop;
+	WindowPtr	code;
+
+	explicit Layout(size_t code_lines)
+	{
+		Rect r = desktop.get_rect();
+		int top = r.height * 60 / 100;
+		int left = r.width * 30 / 100;
+		int half = r.width / 2;
+		auto project = std::make_shared<Window>(Rect(0, 0, left, top));
+		code = std::make_shared<Window>(Rect(left, 0, r.width - left, top));
+		auto vars = std::make_shared<Window>(Rect(0, top, half, r.height - top));
+		auto output = std::make_shared<Window>(Rect(half, top, r.width - half, r.height - top));
+		project->set_title("Project");
+		code->set_title("Code");
+		vars->set_title("Vars");
+		output->set_title("Output");
+
+		std::vector<xstring> lines;
+		for (size_t i = 0; i < code_lines; ++i)
+			lines.push_back("\tvar value" + std::to_string(i) + " = compute(" + std::to_string(i) + ") // step here");
+		code->set_content(lines);
+		code->set_highlight_line(0);
+		project->set_content({ "main", "parser", "util_math", "util_strings" });
+		vars->set_content({ "a\t\t\t1", "b\t\t\t2" });
+		for (int i = 0; i < 100; ++i)
+			output->append_content("output line " + std::to_string(i));
+
+		desktop.add_window(project);
+		desktop.add_window(code);
+		desktop.add_window(vars);
+		desktop.add_window(output);
+		desktop.draw(code);
+	}
+};
+
+static void BM_Step(benchmark::State& state)
+{
+	Layout layout(size_t(state.range(0)));
+	double start = bytes_written();
+	int direction = 1;
+	for (auto _ : state)
+	{
+		int line = layout.code->get_highlight_line();
+		if (line + direction < 0 || line + direction >= int(layout.code->get_content().size()))
+			direction = -direction;
+		layout.code->change_highlight_line(direction);
+		layout.desktop.draw(layout.code);
+	}
+	state.counters["bytes/step"] = benchmark::Counter((bytes_written() - start) / double(state.iterations()));
+}
+BENCHMARK(BM_Step)->Arg(100)->Arg(50000);
+
+static void BM_IdleRedraw(benchmark::State& state)
+{
+	Layout layout(1000);
+	double start = bytes_written();
+	for (auto _ : state)
+		layout.desktop.draw(layout.code);
+	state.counters["bytes/step"] = benchmark::Counter((bytes_written() - start) / double(state.iterations()));
+}
+BENCHMARK(BM_IdleRedraw);
+
+int main(int argc, char* argv[])
+{
+	benchmark::Initialize(&argc, argv);
+	benchmark::ConsoleReporter reporter;
+	reporter.SetOutputStream(&std::cerr);
+	reporter.SetErrorStream(&std::cerr);
+	benchmark::RunSpecifiedBenchmarks(&reporter);
+	benchmark::Shutdown();
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include <threadpool.h>
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// The kind of work the jobs module runs: a map over doubles split in chunks,
+// and independent hashes of byte payloads, on the calling thread against a
+// ThreadPool of Arg threads.  Wall time is what a waiting fiber sees.
+
+constexpr size_t MAP_COUNT = 4 << 20;
+constexpr size_t MAP_GRAIN = 64 * 1024;
+constexpr size_t HASH_JOBS = 32;
+constexpr size_t HASH_SIZE = 1 << 20;
+
+static void map_range(const std::vector<double>& source, std::vector<double>& result, size_t begin, size_t end)
+{
+	for (size_t i = begin; i < end; ++i)
+		result[i] = std::pow(source[i], 1.5);
+}
+
+static uint64_t fnv1a(const std::vector<uint8_t>& data)
+{
+	uint64_t hash = 14695981039346656037ull;
+	for (uint8_t byte : data)
+	{
+		hash ^= byte;
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+static void BM_MapSerial(benchmark::State& state)
+{
+	std::vector<double> source(MAP_COUNT, 2.0), result(MAP_COUNT);
+	for (auto _ : state)
+	{
+		map_range(source, result, 0, MAP_COUNT);
+		benchmark::DoNotOptimize(result.data());
+	}
+	state.SetItemsProcessed(state.iterations() * MAP_COUNT);
+}
+BENCHMARK(BM_MapSerial)->UseRealTime();
+
+static void BM_MapPool(benchmark::State& state)
+{
+	ThreadPool pool(size_t(state.range(0)));
+	std::vector<double> source(MAP_COUNT, 2.0), result(MAP_COUNT);
+	for (auto _ : state)
+	{
+		pool.parallel_for(MAP_COUNT, MAP_GRAIN, [&](size_t begin, size_t end)
+		{
+			map_range(source, result, begin, end);
+		});
+		benchmark::DoNotOptimize(result.data());
+	}
+	state.SetItemsProcessed(state.iterations() * MAP_COUNT);
+}
+BENCHMARK(BM_MapPool)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+static void BM_HashSerial(benchmark::State& state)
+{
+	std::vector<std::vector<uint8_t>> payloads(HASH_JOBS, std::vector<uint8_t>(HASH_SIZE, 7));
+	for (auto _ : state)
+	{
+		for (const auto& payload : payloads)
+			benchmark::DoNotOptimize(fnv1a(payload));
+	}
+	state.SetBytesProcessed(state.iterations() * HASH_JOBS * HASH_SIZE);
+}
+BENCHMARK(BM_HashSerial)->UseRealTime();
+
+// One job per payload, waited for as the scheduler waits for completions
+static void BM_HashPool(benchmark::State& state)
+{
+	ThreadPool pool(size_t(state.range(0)));
+	std::vector<std::vector<uint8_t>> payloads(HASH_JOBS, std::vector<uint8_t>(HASH_SIZE, 7));
+	std::vector<uint64_t> hashes(HASH_JOBS);
+	for (auto _ : state)
+	{
+		std::mutex mutex;
+		std::condition_variable done;
+		size_t remaining = HASH_JOBS;
+		for (size_t i = 0; i < HASH_JOBS; ++i)
+		{
+			pool.submit([&, i]
+			{
+				hashes[i] = fnv1a(payloads[i]);
+				std::lock_guard<std::mutex> lock(mutex);
+				if (--remaining == 0)
+					done.notify_one();
+			});
+		}
+		std::unique_lock<std::mutex> lock(mutex);
+		done.wait(lock, [&] { return remaining == 0; });
+	}
+	state.SetBytesProcessed(state.iterations() * HASH_JOBS * HASH_SIZE);
+}
+BENCHMARK(BM_HashPool)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+BENCHMARK_MAIN();
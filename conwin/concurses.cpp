@@ -1,15 +1,104 @@
 #ifndef _WIN32
 
-#include "console.h"
+#include "consoleimpl.h"
 #include <ncurses.h>
 #include <locale.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <algorithm>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
-class ConsoleImpl
+// Self-pipe that wakes a blocking get_key().  The SIGWINCH handler writes
+// 'w' into it, wake() writes 'i'.
+static int g_WakePipe[2] = { -1, -1 };
+static struct sigaction g_PreviousWinchAction;
+
+static void on_sigwinch(int sig, siginfo_t* info, void* context)
+{
+    int saved_errno = errno;
+    char c = 'w';
+    if (write(g_WakePipe[1], &c, 1) < 0) {
+        // Pipe full, a wake up is already pending
+    }
+    // Chain to the ncurses handler, which records the new size for getch()
+    if (g_PreviousWinchAction.sa_flags & SA_SIGINFO) {
+        if (g_PreviousWinchAction.sa_sigaction)
+            g_PreviousWinchAction.sa_sigaction(sig, info, context);
+    } else if (g_PreviousWinchAction.sa_handler != SIG_DFL && g_PreviousWinchAction.sa_handler != SIG_IGN) {
+        g_PreviousWinchAction.sa_handler(sig);
+    }
+    errno = saved_errno;
+}
+
+class CursesConsole : public ConsoleImpl
 {
+    // A screen cell as composed by the windows.  Cells are only turned into
+    // cchar_t when they differ from what was last presented.
+    struct Cell {
+        wchar_t ch;
+        short pair_number;
+        bool operator==(const Cell& other) const {
+            return ch == other.ch && pair_number == other.pair_number;
+        }
+        bool operator!=(const Cell& other) const {
+            return !(*this == other);
+        }
+    };
+    static constexpr Cell unknown_cell = { 0, -1 };     // Never equal to a drawn cell
+    static constexpr int color_count = 8;
+
+    // Pair number for every foreground / background combination
+    short pair_table[color_count][color_count] = {};
+    Cell blank_cell = { L' ', 0 };                      // White on black
+
     Rect console_rect;
-    std::vector<std::vector<cchar_t>> frame_buffer;
+    std::vector<Cell> frame_buffer;         // Row major, width * height
+    std::vector<Cell> presented_buffer;     // What the terminal currently shows
+    std::vector<char> touched_rows;         // Rows written since the last draw_frame()
+    std::vector<cchar_t> run_buffer;
+    bool input_closed = false;              // stdin hung up, only wake() ends a wait
+
+    void init_color_pairs() {
+        // Indexed by Color
+        static const short curses_colors[color_count] = {
+            COLOR_BLACK, COLOR_RED, COLOR_GREEN, COLOR_BLUE,
+            COLOR_YELLOW, COLOR_MAGENTA, COLOR_CYAN, COLOR_WHITE
+        };
+        if (COLOR_PAIRS > color_count * color_count) {
+            // One pair per combination
+            for (int fg = 0; fg < color_count; ++fg) {
+                for (int bg = 0; bg < color_count; ++bg) {
+                    short pair_number = short(1 + fg * color_count + bg);
+                    init_pair(pair_number, curses_colors[fg], curses_colors[bg]);
+                    pair_table[fg][bg] = pair_number;
+                }
+            }
+        } else {
+            // Pair 0 is default terminal colors.  Pairs 1-8 are the foreground
+            // colors on black, pairs 9-16 white on the background colors.
+            for (short c = 0; c < color_count; ++c) {
+                init_pair(1 + c, c, COLOR_BLACK);
+                init_pair(9 + c, COLOR_WHITE, c);
+            }
+            for (int fg = 0; fg < color_count; ++fg) {
+                for (int bg = 0; bg < color_count; ++bg) {
+                    pair_table[fg][bg] = (bg == int(Color::Black))
+                        ? short(1 + curses_colors[fg])
+                        : short(9 + curses_colors[bg]);
+                }
+            }
+        }
+        blank_cell.pair_number = pair_number(ColorPair(Color::White, Color::Black));
+    }
+
+    short pair_number(const ColorPair& color) const {
+        return pair_table[int(color.foreground)][int(color.background)];
+    }
 
     // Utility method to create a cchar_t from a wchar_t and attributes
     void create_cchar(cchar_t* dest, wchar_t ch, short pair_number) {
@@ -18,7 +107,7 @@ class ConsoleImpl
         setcchar(dest, wch, attr, pair_number, nullptr);
     }
 public:
-    ConsoleImpl() {
+    CursesConsole() {
         // Set up locale for Unicode support
         setlocale(LC_ALL, "");
 
@@ -28,43 +117,43 @@ public:
         cbreak();
         noecho();
         keypad(stdscr, TRUE);
-        nodelay(stdscr, TRUE);  // Non-blocking input
+        nodelay(stdscr, TRUE);  // Non-blocking input, waiting is done with poll()
+        set_escdelay(25);       // Don't hold a lone Escape for a full second
         curs_set(0);            // Hide cursor
 
-        // Initialize color pairs
-        // Pair 0 is default terminal colors
-        init_pair(1, COLOR_BLACK, COLOR_BLACK);
-        init_pair(2, COLOR_RED, COLOR_BLACK);
-        init_pair(3, COLOR_GREEN, COLOR_BLACK);
-        init_pair(4, COLOR_YELLOW, COLOR_BLACK);
-        init_pair(5, COLOR_BLUE, COLOR_BLACK);
-        init_pair(6, COLOR_MAGENTA, COLOR_BLACK);
-        init_pair(7, COLOR_CYAN, COLOR_BLACK);
-        init_pair(8, COLOR_WHITE, COLOR_BLACK);
-
-        // Background colors (pairs 9-16)
-        init_pair(9, COLOR_WHITE, COLOR_BLACK);
-        init_pair(10, COLOR_WHITE, COLOR_RED);
-        init_pair(11, COLOR_WHITE, COLOR_GREEN);
-        init_pair(12, COLOR_WHITE, COLOR_YELLOW);
-        init_pair(13, COLOR_WHITE, COLOR_BLUE);
-        init_pair(14, COLOR_WHITE, COLOR_MAGENTA);
-        init_pair(15, COLOR_WHITE, COLOR_CYAN);
-        init_pair(16, COLOR_WHITE, COLOR_WHITE);
+        if (pipe(g_WakePipe) == 0) {
+            for (int fd : g_WakePipe) {
+                fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+                fcntl(fd, F_SETFD, FD_CLOEXEC);
+            }
+            struct sigaction action = {};
+            action.sa_sigaction = on_sigwinch;
+            action.sa_flags = SA_SIGINFO | SA_RESTART;
+            sigemptyset(&action.sa_mask);
+            sigaction(SIGWINCH, &action, &g_PreviousWinchAction);
+        }
+
+        init_color_pairs();
 
         update();
         clear();
     }
 
-    ~ConsoleImpl() {
+    ~CursesConsole() override {
+        if (g_WakePipe[0] >= 0) {
+            sigaction(SIGWINCH, &g_PreviousWinchAction, nullptr);
+            close(g_WakePipe[0]);
+            close(g_WakePipe[1]);
+            g_WakePipe[0] = g_WakePipe[1] = -1;
+        }
         endwin();
     }
 
-    const Rect& get_rect() {
+    const Rect& get_rect() override {
         return console_rect;
     }
 
-    Key get_key(bool wait) {
+    Key get_key(bool wait) override {
         static const std::unordered_map<int, Key> keyMap = {
             {KEY_UP, Key::Up},
             {KEY_DOWN, Key::Down},
@@ -72,6 +161,9 @@ public:
             {KEY_RIGHT, Key::Right},
             {'\n', Key::Enter},
             {27, Key::Escape},
+            {KEY_BACKSPACE, Key::Backspace},
+            {127, Key::Backspace},
+            {8, Key::Backspace},
             {KEY_PPAGE, Key::PageUp},
             {KEY_NPAGE, Key::PageDown},
             {KEY_HOME, Key::Home},
@@ -93,154 +185,190 @@ public:
         while (true)
         {
             int ch = getch();
+            if (ch == KEY_RESIZE) {
+                return Key::None;  // The next update() picks up the new size
+            }
             if (ch != ERR) {
                 auto it = keyMap.find(ch);
                 if (it != keyMap.end()) {
                     return it->second;
                 }
+                if (ch >= ' ' && ch <= '~') {
+                    typed_character = char(ch);
+                    return Key::Character;
+                }
+                continue;  // Unmapped key, look at what follows it
             }
 
             if (!wait) {
                 return Key::None;
             }
 
-            if (update()) {
-                clear();
+            if (g_WakePipe[0] < 0) {
+                napms(100);  // No wake pipe, fall back to polling
+                continue;
+            }
+
+            // Sleep until a key arrives, the terminal is resized or wake() is called
+            // A closed stdin reports POLLHUP on every call, so it stops being
+            // watched (poll() skips a negative fd); getch() still drains what
+            // was left in it
+            struct pollfd fds[2] = {
+                { input_closed ? -1 : STDIN_FILENO, POLLIN, 0 },
+                { g_WakePipe[0], POLLIN, 0 }
+            };
+            if (poll(fds, 2, -1) < 0 && errno != EINTR) {
+                return Key::None;
+            }
+            if (fds[0].revents & (POLLHUP | POLLERR | POLLNVAL)) {
+                input_closed = true;
                 return Key::None;
             }
+            if (fds[1].revents & POLLIN) {
+                bool interrupted = false;
+                char buffer[64];
+                ssize_t n;
+                while ((n = read(g_WakePipe[0], buffer, sizeof(buffer))) > 0) {
+                    for (ssize_t i = 0; i < n; ++i)
+                        interrupted |= (buffer[i] == 'i');
+                }
+                if (interrupted) {
+                    return Key::None;
+                }
+                // A resize: the next getch() returns KEY_RESIZE
+            }
+        }
+    }
 
-            napms(100);  // Sleep for 100ms
+    void wake() override {
+        char c = 'i';
+        if (g_WakePipe[1] >= 0 && write(g_WakePipe[1], &c, 1) < 0) {
+            // Pipe full, a wake up is already pending
         }
     }
 
-    bool update() {
+    bool update() override {
         int new_width, new_height;
         getmaxyx(stdscr, new_height, new_width);
 
         if (new_width != console_rect.width || new_height != console_rect.height) {
             console_rect = Rect(0, 0, new_width, new_height);
 
-            // Resize the frame buffer
-            frame_buffer.resize(new_height);
-            for (auto& row : frame_buffer) {
-                row.resize(new_width);
-
-                // Initialize with spaces
-                cchar_t space;
-                create_cchar(&space, L' ', 8);  // White on black
-                std::fill(row.begin(), row.end(), space);
-            }
+            // Resize the frame buffer, initialized with spaces.  assign() keeps
+            // the allocation, so only growing past the largest size allocates.
+            // The terminal isn't cleared: every cell is handed to ncurses again
+            // and it only sends what differs from the screen.
+            frame_buffer.assign(size_t(new_width) * new_height, blank_cell);
+            presented_buffer.assign(frame_buffer.size(), unknown_cell);
+            touched_rows.assign(new_height, 1);
 
             return true;
         }
         return false;
     }
 
-    void clear() {
+    void clear() override {
         // Clear the frame buffer with spaces
-        for (auto& row : frame_buffer) {
-            cchar_t space;
-            create_cchar(&space, L' ', 8);  // White on black
-            std::fill(row.begin(), row.end(), space);
-        }
+        std::fill(frame_buffer.begin(), frame_buffer.end(), blank_cell);
+        // The screen no longer matches anything that was presented
+        std::fill(presented_buffer.begin(), presented_buffer.end(), unknown_cell);
+        std::fill(touched_rows.begin(), touched_rows.end(), 1);
 
         // Clear the screen
         ::clear();
         refresh();
     }
 
-    static void set_cursor(int x, int y) {
+    void set_cursor(int x, int y) override {
         move(y, x);
     }
 
-    void set_character(int x, int y, wchar_t ch, const ColorPair& color) {
+    void set_character(int x, int y, wchar_t ch, const ColorPair& color) override {
         if (x < 0 || x >= console_rect.width || y < 0 || y >= console_rect.height) {
             return;  // Silently ignore out-of-bounds
         }
 
-        // Calculate color pair number
-        short pair_number;
+        // Set the character in the frame buffer
+        frame_buffer[size_t(y) * console_rect.width + x] = { ch, pair_number(color) };
+        touched_rows[y] = 1;
+    }
 
-        // Create pairs for all foreground/background combinations
-        if (color.background == Color::Black) {
-            // Use first 8 pairs for foreground colors on black background
-            switch (color.foreground) {
-                case Color::Black: pair_number = 1; break;
-                case Color::Red: pair_number = 2; break;
-                case Color::Green: pair_number = 3; break;
-                case Color::Yellow: pair_number = 4; break;
-                case Color::Blue: pair_number = 5; break;
-                case Color::Magenta: pair_number = 6; break;
-                case Color::Cyan: pair_number = 7; break;
-                case Color::White:
-                default: pair_number = 8; break;  // Default to white on black
-            }
-        } else {
-            // Use pairs 9-16 for white foreground on colored backgrounds
-            switch (color.background) {
-                case Color::Red: pair_number = 10; break;
-                case Color::Green: pair_number = 11; break;
-                case Color::Yellow: pair_number = 12; break;
-                case Color::Blue: pair_number = 13; break;
-                case Color::Magenta: pair_number = 14; break;
-                case Color::Cyan: pair_number = 15; break;
-                case Color::White: pair_number = 16; break;
-                case Color::Black:
-                default: pair_number = 9; break;  // Default to white on black
-            }
+    void write_run(int x, int y, std::string_view text, const ColorPair& color) override {
+        if (y < 0 || y >= console_rect.height) {
+            return;
+        }
+        if (x < 0) {
+            if (size_t(-x) >= text.size()) return;
+            text.remove_prefix(size_t(-x));
+            x = 0;
+        }
+        if (x >= console_rect.width) {
+            return;
         }
+        size_t n = std::min(text.size(), size_t(console_rect.width - x));
+        const short pair = pair_number(color);
+        Cell* cell = &frame_buffer[size_t(y) * console_rect.width + x];
+        for (size_t i = 0; i < n; ++i) {
+            cell[i] = { wchar_t((unsigned char)text[i]), pair };
+        }
+        touched_rows[y] = 1;
+    }
 
-        // Set the character in the frame buffer
-        create_cchar(&frame_buffer[y][x], ch, pair_number);
+    void fill(const Rect& rect, wchar_t ch, const ColorPair& color) override {
+        Rect r = rect.intersection(console_rect);
+        if (r.width <= 0 || r.height <= 0) {
+            return;
+        }
+        const Cell cell = { ch, pair_number(color) };
+        for (int y = r.y; y < r.bottom(); ++y) {
+            Cell* row = &frame_buffer[size_t(y) * console_rect.width];
+            std::fill(row + r.x, row + r.right(), cell);
+            touched_rows[y] = 1;
+        }
     }
 
-    void draw_frame() {
-        // Draw the frame buffer to the screen
-        for (int y = 0; y < console_rect.height && y < (int)frame_buffer.size(); y++) {
-            for (int x = 0; x < console_rect.width && x < (int)frame_buffer[y].size(); x++) {
-                mvadd_wch(y, x, &frame_buffer[y][x]);
+    void draw_frame() override {
+        // Hand ncurses only the runs of cells that changed since the last frame
+        const int width = console_rect.width;
+        bool changed = false;
+        ++stats.frames;
+        for (int y = 0; y < console_rect.height; y++) {
+            if (!touched_rows[y]) {
+                continue;
+            }
+            touched_rows[y] = 0;
+            const Cell* row = &frame_buffer[size_t(y) * width];
+            Cell* presented = &presented_buffer[size_t(y) * width];
+            int x = 0;
+            while (x < width) {
+                if (row[x] == presented[x]) {
+                    ++x;
+                    continue;
+                }
+                int start = x;
+                while (x < width && row[x] != presented[x]) {
+                    presented[x] = row[x];
+                    ++x;
+                }
+                run_buffer.resize(x - start);
+                for (int i = start; i < x; ++i) {
+                    create_cchar(&run_buffer[i - start], row[i].ch, row[i].pair_number);
+                }
+                mvadd_wchnstr(y, start, run_buffer.data(), x - start);
+                ++stats.runs;
+                stats.cells += x - start;
+                changed = true;
             }
         }
-        refresh();
+        if (changed) {
+            refresh();
+        }
     }
 };
 
-// Implement Console class methods
-Console::Console() : m_Impl(std::make_unique<ConsoleImpl>())
-{
-}
-
-Console::~Console()
+std::unique_ptr<ConsoleImpl> create_terminal_console()
 {
-    m_Impl.reset();
-}
-
-const Rect& Console::get_rect() {
-    return m_Impl->get_rect();
-}
-
-Key Console::get_key(bool wait) {
-    return m_Impl->get_key(wait);
-}
-
-bool Console::update() {
-    return m_Impl->update();
-}
-
-void Console::clear() {
-    m_Impl->clear();
-}
-
-void Console::set_cursor(int x, int y) {
-    ConsoleImpl::set_cursor(x, y);
-}
-
-void Console::set_character(int x, int y, wchar_t ch, const ColorPair& color) {
-    m_Impl->set_character(x, y, ch, color);
-}
-
-void Console::draw_frame() {
-    m_Impl->draw_frame();
+    return std::make_unique<CursesConsole>();
 }
 
 #endif // ! _WIN32
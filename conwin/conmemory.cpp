@@ -0,0 +1,155 @@
+#include "consoleimpl.h"
+#include <algorithm>
+#include <vector>
+
+// Keeps the frame in memory and diffs it against the last presented frame
+// the way the terminal backends do, counting what would have been written.
+class MemoryConsole : public ConsoleImpl
+{
+	struct Cell
+	{
+		wchar_t		ch;
+		ColorPair	color;
+		bool operator==(const Cell& other) const { return ch == other.ch && color == other.color; }
+		bool operator!=(const Cell& other) const { return !(*this == other); }
+	};
+	const Cell				blank_cell = { L' ', ColorPair(Color::White, Color::Black) };
+	const Cell				unknown_cell = { 0, ColorPair(Color::Black, Color::Black) };
+
+	Point					requested_size;
+	Rect					console_rect;
+	std::vector<Cell>		frame_buffer;
+	std::vector<Cell>		presented_buffer;
+	std::vector<char>		touched_rows;		// Rows written since the last draw_frame()
+public:
+	MemoryConsole(int width, int height)
+		: requested_size(std::max(width, 0), std::max(height, 0))
+	{
+		update();
+		clear();
+	}
+
+	const Rect& get_rect() override
+	{
+		return console_rect;
+	}
+
+	Key get_key(bool /*wait*/) override
+	{
+		return Key::None;
+	}
+
+	void wake() override {}
+
+	bool update() override
+	{
+		if (requested_size.x == console_rect.width && requested_size.y == console_rect.height)
+			return false;
+		console_rect = Rect(0, 0, requested_size.x, requested_size.y);
+		frame_buffer.assign(size_t(console_rect.width) * console_rect.height, blank_cell);
+		presented_buffer.assign(frame_buffer.size(), unknown_cell);
+		touched_rows.assign(console_rect.height, 1);
+		return true;
+	}
+
+	void resize(int width, int height) override
+	{
+		requested_size = Point(std::max(width, 0), std::max(height, 0));
+	}
+
+	void clear() override
+	{
+		std::fill(frame_buffer.begin(), frame_buffer.end(), blank_cell);
+		std::fill(presented_buffer.begin(), presented_buffer.end(), unknown_cell);
+		std::fill(touched_rows.begin(), touched_rows.end(), 1);
+	}
+
+	void set_cursor(int /*x*/, int /*y*/) override {}
+
+	void set_character(int x, int y, wchar_t ch, const ColorPair& color) override
+	{
+		if (x < 0 || x >= console_rect.width || y < 0 || y >= console_rect.height)
+			return;
+		frame_buffer[size_t(y) * console_rect.width + x] = { ch, color };
+		touched_rows[y] = 1;
+	}
+
+	void write_run(int x, int y, std::string_view text, const ColorPair& color) override
+	{
+		if (y < 0 || y >= console_rect.height)
+			return;
+		if (x < 0)
+		{
+			if (size_t(-x) >= text.size()) return;
+			text.remove_prefix(size_t(-x));
+			x = 0;
+		}
+		if (x >= console_rect.width)
+			return;
+		size_t n = std::min(text.size(), size_t(console_rect.width - x));
+		Cell* cell = &frame_buffer[size_t(y) * console_rect.width + x];
+		for (size_t i = 0; i < n; ++i)
+			cell[i] = { wchar_t((unsigned char)text[i]), color };
+		touched_rows[y] = 1;
+	}
+
+	void fill(const Rect& rect, wchar_t ch, const ColorPair& color) override
+	{
+		Rect r = rect.intersection(console_rect);
+		if (r.width <= 0 || r.height <= 0)
+			return;
+		const Cell cell = { ch, color };
+		for (int y = r.y; y < r.bottom(); ++y)
+		{
+			Cell* row = &frame_buffer[size_t(y) * console_rect.width];
+			std::fill(row + r.x, row + r.right(), cell);
+			touched_rows[y] = 1;
+		}
+	}
+
+	void draw_frame() override
+	{
+		++stats.frames;
+		const int width = console_rect.width;
+		for (int y = 0; y < console_rect.height; ++y)
+		{
+			if (!touched_rows[y])
+				continue;
+			touched_rows[y] = 0;
+			const Cell* row = &frame_buffer[size_t(y) * width];
+			Cell* presented = &presented_buffer[size_t(y) * width];
+			int x = 0;
+			while (x < width)
+			{
+				if (row[x] == presented[x])
+				{
+					++x;
+					continue;
+				}
+				int start = x;
+				while (x < width && row[x] != presented[x])
+				{
+					presented[x] = row[x];
+					++x;
+				}
+				++stats.runs;
+				stats.cells += x - start;
+			}
+		}
+	}
+
+	bool get_cell(int x, int y, wchar_t& ch, ColorPair& color) const override
+	{
+		if (x < 0 || x >= console_rect.width || y < 0 || y >= console_rect.height)
+			return false;
+		const Cell& cell = presented_buffer[size_t(y) * console_rect.width + x];
+		ch = cell.ch;
+		color = cell.color;
+		return true;
+	}
+};
+
+std::unique_ptr<ConsoleImpl> create_memory_console(int width, int height)
+{
+	return std::make_unique<MemoryConsole>(width, height);
+}
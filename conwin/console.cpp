@@ -0,0 +1,85 @@
+#include "console.h"
+#include "consoleimpl.h"
+
+Console::Console(ConsoleBackend backend, int width, int height)
+{
+	if (backend == ConsoleBackend::Memory)
+		m_Impl = create_memory_console(width, height);
+	else
+		m_Impl = create_terminal_console();
+}
+
+Console::~Console()
+{
+	m_Impl.reset();
+}
+
+const Rect& Console::get_rect()
+{
+	return m_Impl->get_rect();
+}
+
+Key Console::get_key(bool wait)
+{
+	return m_Impl->get_key(wait);
+}
+
+char Console::get_typed_character() const
+{
+	return m_Impl->get_typed_character();
+}
+
+void Console::wake()
+{
+	m_Impl->wake();
+}
+
+bool Console::update()
+{
+	return m_Impl->update();
+}
+
+void Console::resize(int width, int height)
+{
+	m_Impl->resize(width, height);
+}
+
+void Console::clear()
+{
+	m_Impl->clear();
+}
+
+void Console::set_cursor(int x, int y)
+{
+	m_Impl->set_cursor(x, y);
+}
+
+void Console::set_character(int x, int y, wchar_t ch, const ColorPair& color)
+{
+	m_Impl->set_character(x, y, ch, color);
+}
+
+void Console::write_run(int x, int y, std::string_view text, const ColorPair& color)
+{
+	m_Impl->write_run(x, y, text, color);
+}
+
+void Console::fill(const Rect& rect, wchar_t ch, const ColorPair& color)
+{
+	m_Impl->fill(rect, ch, color);
+}
+
+void Console::draw_frame()
+{
+	m_Impl->draw_frame();
+}
+
+bool Console::get_cell(int x, int y, wchar_t& ch, ColorPair& color) const
+{
+	return m_Impl->get_cell(x, y, ch, color);
+}
+
+const ConsoleStats& Console::get_stats() const
+{
+	return m_Impl->get_stats();
+}
@@ -1,21 +1,54 @@
 #pragma once
 
 #include <memory>
+#include <string_view>
 #include "types.h"
 #include "conwin.h"
 
+enum class ConsoleBackend
+{
+	Terminal,	// ncurses, or the Windows console
+	Memory		// Off screen frame buffer, for tests and benchmarks
+};
+
+// What draw_frame() handed to the screen so far
+struct ConsoleStats
+{
+	size_t	frames = 0;		// draw_frame() calls
+	size_t	runs = 0;		// Runs of changed cells presented
+	size_t	cells = 0;		// Changed cells presented
+};
+
 class Console
 {
 	std::unique_ptr<class ConsoleImpl> m_Impl;
 public:
-	Console();
+	// The size is only used by the memory backend, the terminal has its own
+	explicit Console(ConsoleBackend backend = ConsoleBackend::Terminal, int width = 80, int height = 25);
 	~Console();
 	const Rect& get_rect();
 	Key get_key(bool wait);
-	// Query window size and update frame buffer size
+	// The character of the last Key::Character returned by get_key()
+	char get_typed_character() const;
+	// Makes a blocking get_key() return Key::None.  May be called from any thread.
+	void wake();
+	// Query window size and update frame buffer size.  Returns true when the
+	// size changed; the frame buffer is then blank and nothing is considered
+	// presented, so the next draw_frame() repaints every cell.
 	bool update();
+	// Sets the size the next update() picks up.  Only the memory backend can
+	// be resized this way, the terminal follows its window.
+	void resize(int width, int height);
 	void clear();
 	void set_cursor(int x, int y);
 	void set_character(int x, int y, wchar_t ch, const ColorPair& color);
+	// Writes one cell per byte of text, clipped to the console
+	void write_run(int x, int y, std::string_view text, const ColorPair& color);
+	void fill(const Rect& rect, wchar_t ch, const ColorPair& color);
 	void draw_frame();
+
+	// The cell presented by the last draw_frame().  Returns false when the
+	// backend can't tell, which is the case for the terminal.
+	bool get_cell(int x, int y, wchar_t& ch, ColorPair& color) const;
+	const ConsoleStats& get_stats() const;
 };
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <memory>
+#include <string_view>
+#include "console.h"
+
+// A console backend.  Console forwards to the one chosen at construction.
+class ConsoleImpl
+{
+protected:
+	ConsoleStats	stats;
+	char			typed_character = 0;
+public:
+	virtual ~ConsoleImpl() = default;
+	virtual const Rect& get_rect() = 0;
+	virtual Key get_key(bool wait) = 0;
+	virtual void wake() = 0;
+	virtual bool update() = 0;
+	virtual void clear() = 0;
+	virtual void set_cursor(int x, int y) = 0;
+	virtual void set_character(int x, int y, wchar_t ch, const ColorPair& color) = 0;
+	virtual void write_run(int x, int y, std::string_view text, const ColorPair& color) = 0;
+	virtual void fill(const Rect& rect, wchar_t ch, const ColorPair& color) = 0;
+	virtual void draw_frame() = 0;
+
+	virtual void resize(int /*width*/, int /*height*/) {}
+
+	// Only backends that keep what they presented can answer this
+	virtual bool get_cell(int /*x*/, int /*y*/, wchar_t& /*ch*/, ColorPair& /*color*/) const
+	{
+		return false;
+	}
+
+	char get_typed_character() const
+	{
+		return typed_character;
+	}
+
+	const ConsoleStats& get_stats() const
+	{
+		return stats;
+	}
+};
+
+// Implemented by concurses.cpp or conwindows.cpp
+std::unique_ptr<ConsoleImpl> create_terminal_console();
+// Implemented by conmemory.cpp
+std::unique_ptr<ConsoleImpl> create_memory_console(int width, int height);
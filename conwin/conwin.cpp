@@ -1,7 +1,15 @@
 #include "conwin.h"
 #include "console.h"
+#include <algorithm>
+#include <string_view>
 
-static Console console;
+// The terminal is taken over when something is first drawn or read, so
+// programs that link conwin but never show a window leave it alone
+static Console& terminal_console()
+{
+	static Console console;
+	return console;
+}
 
 Window::Window(const Rect& border_rect)
 	: m_BorderRect(border_rect)
@@ -15,12 +23,20 @@ Window::Window(const Pointd& size_percent)
 
 void Window::set_title(const xstring& title)
 {
-	m_Title = title;
+	if (title != m_Title)
+	{
+		m_Title = title;
+		m_Dirty |= DirtyFrame;
+	}
 }
 
 void Window::set_status_line(const xstring& status_line)
 {
-	m_StatusLine = status_line;
+	if (status_line != m_StatusLine)
+	{
+		m_StatusLine = status_line;
+		m_Dirty |= DirtyFrame;
+	}
 }
 
 const Rect& Window::get_border_rect() const { return m_BorderRect; }
@@ -38,6 +54,7 @@ void Window::set_line_foreground_color(size_t line, const Color& color)
 	{
 		m_HighlightLines[line] = ColorPair(color, Color::Black);
 	}
+	m_Dirty |= DirtyColors;
 }
 
 void Window::set_line_background_color(size_t line, const Color& color)
@@ -51,6 +68,7 @@ void Window::set_line_background_color(size_t line, const Color& color)
 	{
 		m_HighlightLines[line] = ColorPair(Color::White, color);
 	}
+	m_Dirty |= DirtyColors;
 }
 
 const ColorPair& Window::get_line_color(size_t line) const
@@ -64,7 +82,11 @@ const ColorPair& Window::get_line_color(size_t line) const
 
 void Window::clear_line_colors()
 {
-	m_HighlightLines.clear();
+	if (!m_HighlightLines.empty())
+	{
+		m_HighlightLines.clear();
+		m_Dirty |= DirtyColors;
+	}
 }
 
 static xstring normalize_line(const xstring& line)
@@ -77,9 +99,12 @@ static xstring normalize_line(const xstring& line)
 
 void Window::set_content(const std::vector<xstring>& content_lines)
 {
+	m_Provider.reset();
+	m_Styler.reset();
 	m_ContentLines.assign(content_lines.size(), "");
 	std::transform(content_lines.begin(), content_lines.end(), m_ContentLines.begin(),
 				   [](const xstring& line) { return normalize_line(line); });
+	m_Dirty |= DirtyContent;
 }
 
 const std::vector<xstring>& Window::get_content() const
@@ -90,6 +115,42 @@ const std::vector<xstring>& Window::get_content() const
 void Window::append_content(const xstring& line)
 {
 	m_ContentLines.push_back(line);
+	m_Dirty |= DirtyContent;
+}
+
+void Window::set_content_provider(const ContentProviderPtr& provider)
+{
+	m_ContentLines.clear();
+	m_Provider = provider;
+	m_Styler.reset();
+	m_Dirty |= DirtyContent;
+}
+
+void Window::content_changed()
+{
+	if (m_Styler)
+		m_Styler->invalidate(0);
+	m_Dirty |= DirtyContent;
+}
+
+void Window::set_line_styler(const LineStylerPtr& styler)
+{
+	m_Styler = styler;
+	m_Dirty |= DirtyContent;
+}
+
+size_t Window::get_line_count() const
+{
+	return m_Provider ? m_Provider->get_line_count() : m_ContentLines.size();
+}
+
+std::string_view Window::get_line(size_t index) const
+{
+	if (index >= get_line_count())
+		return {};
+	if (m_Provider)
+		return m_Provider->get_line(index);
+	return m_ContentLines[index];
 }
 
 struct Border
@@ -104,43 +165,25 @@ struct Border
 	wchar_t right_limiter = 0x2523;
 };
 
-void Window::draw(bool active) const
+void Window::draw_frame(Console& console, bool active) const
 {
 	const Border border;
 	const ColorPair border_color = active ? ColorPair(Color::White, Color::Cyan) : ColorPair(Color::White, Color::Black);
+	const int left = m_BorderRect.x;
+	const int top = m_BorderRect.y;
+	const int right = m_BorderRect.x + m_BorderRect.width - 1;
+	const int bottom = m_BorderRect.y + m_BorderRect.height - 1;
 	// Draw the window border
-	// Top-left corner
-	console.set_character(m_BorderRect.x, m_BorderRect.y, 
-						  border.top_left, border_color);
-	// Top-right corner
-	console.set_character(m_BorderRect.x + m_BorderRect.width - 1, m_BorderRect.y, 
-						  border.top_right, border_color);
-	// Bottom-left corner
-	console.set_character(m_BorderRect.x, m_BorderRect.y + m_BorderRect.height - 1, 
-						  border.bottom_left, border_color);
-	// Bottom-right corner
-	console.set_character(m_BorderRect.x + m_BorderRect.width - 1, m_BorderRect.y + m_BorderRect.height - 1,
-						  border.bottom_right, border_color);
-
-	// Draw top and bottom borders
-	for (int ix = 1; ix < m_BorderRect.width - 1; ++ix)
-	{
-		// Top border
-		console.set_character(m_BorderRect.x + ix, m_BorderRect.y, border.horizontal, border_color);
-		// Bottom border
-		console.set_character(m_BorderRect.x + ix, m_BorderRect.y + m_BorderRect.height - 1, border.horizontal, border_color);
-	}
-
-	// Draw left and right borders
-	for (int iy = 1; iy < m_BorderRect.height - 1; ++iy)
-	{
-		// Left border
-		console.set_character(m_BorderRect.x, m_BorderRect.y + iy, 
-							  border.vertical, border_color);
-		// Right border
-		console.set_character(m_BorderRect.x + m_BorderRect.width - 1, m_BorderRect.y + iy,
-							  border.vertical, border_color);
-	}
+	console.set_character(left, top, border.top_left, border_color);
+	console.set_character(right, top, border.top_right, border_color);
+	console.set_character(left, bottom, border.bottom_left, border_color);
+	console.set_character(right, bottom, border.bottom_right, border_color);
+	// Top and bottom borders
+	console.fill(Rect(left + 1, top, m_BorderRect.width - 2, 1), border.horizontal, border_color);
+	console.fill(Rect(left + 1, bottom, m_BorderRect.width - 2, 1), border.horizontal, border_color);
+	// Left and right borders
+	console.fill(Rect(left, top + 1, 1, m_BorderRect.height - 2), border.vertical, border_color);
+	console.fill(Rect(right, top + 1, 1, m_BorderRect.height - 2), border.vertical, border_color);
 
 	if (!m_Title.empty())
 	{
@@ -148,10 +191,8 @@ void Window::draw(bool active) const
 		int y = m_BorderRect.y;
 		console.set_character(x++, y, border.left_limiter, border_color); // Draw title connector
 		console.set_character(x++, y, ' ', border_color); // Draw title connector
-		for (size_t i = 0; i < m_Title.length(); ++i)
-		{
-			console.set_character(x++, y, m_Title[i], ColorPair(Color::White, Color::Black)); // Draw title text
-		}
+		console.write_run(x, y, m_Title, ColorPair(Color::White, Color::Black)); // Draw title text
+		x += int(m_Title.length());
 		console.set_character(x++, y, ' ', border_color); // Draw title connector
 		console.set_character(x, y, border.right_limiter, border_color); // Draw title connector
 	}
@@ -162,62 +203,116 @@ void Window::draw(bool active) const
 		int y = m_BorderRect.y + m_BorderRect.height - 1;
 		console.set_character(x++, y, 0x252B, border_color); // Draw title connector
 		console.set_character(x++, y, ' ', border_color); // Draw title connector
-		for (size_t i = 0; i < m_StatusLine.length() && x < m_BorderRect.x + m_BorderRect.width - 2; ++i)
-		{
-			console.set_character(x++, y, m_StatusLine[i], ColorPair(Color::White, Color::Black));
-		}
+		size_t n = std::min(m_StatusLine.length(), size_t(std::max(0, m_BorderRect.x + m_BorderRect.width - 2 - x)));
+		console.write_run(x, y, std::string_view(m_StatusLine).substr(0, n), ColorPair(Color::White, Color::Black));
+		x += int(n);
 		console.set_character(x++, y, ' ', border_color); // Draw title connector
 		console.set_character(x, y, 0x2523, border_color); // Draw title connector
 	}
+}
 
-	// Draw the content
-	int y = m_ContentRect.y;
-	for (size_t i = 0; i < m_ContentLines.size(); ++i)
+ColorPair Window::get_draw_color(int line) const
+{
+	if (line == m_HighlightLine)
 	{
-		int iy = int(i) - m_StartOffset;
-		y = m_ContentRect.y + iy;
-		if (y >= m_ContentRect.y && y < m_ContentRect.bottom())
+		// If this line is selected, use a special color
+		return ColorPair(Color::White, Color::Blue);
+	}
+	auto it = m_HighlightLines.find(line);
+	if (it != m_HighlightLines.end())
+		return it->second;
+	return ColorPair();
+}
+
+void Window::draw_content_line(Console& console, int line) const
+{
+	if (line < 0 || line >= int(get_line_count()))
+		return;
+	int y = m_ContentRect.y + line - m_StartOffset;
+	if (y < m_ContentRect.y || y >= m_ContentRect.bottom())
+		return;
+	// Provided lines are normalized only when they come on screen
+	xstring normalized;
+	if (m_Provider)
+		normalized = normalize_line(m_Provider->get_line(line));
+	std::string_view line_text = m_Provider ? normalized : m_ContentLines[line];
+	std::string_view text = line_text.substr(0, std::max(m_ContentRect.width, 0));
+	ColorPair color = get_draw_color(line);
+	// Draw the content line, padded with spaces to the content rect width
+	if (m_Styler && color == ColorPair())
+	{
+		// Styled whole, so the cached runs hold whatever the width; runs past
+		// the window are clipped below
+		size_t x = 0;
+		for (const StyleRun& run : m_Styler->style_line(line, line_text))
 		{
-			const auto& line = m_ContentLines[i];
-			int n = int(line.length());
-
-			// Get line color if it's highlighted
-			ColorPair color;
-			auto it = m_HighlightLines.find(i);
-			if (it != m_HighlightLines.end())
-			{
-				color = it->second;
-			}
-			if (i==m_HighlightLine)
-			{
-				// If this line is selected, use a special color
-				color = ColorPair(Color::White, Color::Blue);
-			}
-
-			// Draw the content line
-			for (int ix = 0; ix < m_ContentRect.width; ++ix)
-			{
-				if (ix < n)
-				{
-					// Draw character from the content line
-					console.set_character(m_ContentRect.x + ix, y, line[ix], color);
-				}
-				else
-				{
-					// Fill with spaces if line is shorter than content rect width
-					console.set_character(m_ContentRect.x + ix, y, ' ', color);
-				}
-			}
+			size_t start = std::clamp<size_t>(run.start, x, text.size());
+			size_t end = std::min<size_t>(start + run.length, text.size());
+			console.write_run(m_ContentRect.x + int(x), y, text.substr(x, start - x), color);
+			console.write_run(m_ContentRect.x + int(start), y, text.substr(start, end - start), ColorPair(run.foreground, color.background));
+			x = end;
 		}
+		console.write_run(m_ContentRect.x + int(x), y, text.substr(x), color);
 	}
+	else
+		console.write_run(m_ContentRect.x, y, text, color);
+	console.fill(Rect(m_ContentRect.x + int(text.size()), y, m_ContentRect.width - int(text.size()), 1), ' ', color);
+}
+
+void Window::draw_content(Console& console) const
+{
+	int first_line = std::max(m_StartOffset, 0);
+	int last_line = std::min(int(get_line_count()), m_StartOffset + m_ContentRect.height);
+	for (int i = first_line; i < last_line; ++i)
+		draw_content_line(console, i);
+	int y = m_ContentRect.y + std::max(last_line - m_StartOffset, 0);
 	ColorPair blank_color(Color::White, Color::Black);
-	while(++y < m_ContentRect.bottom())
+	console.fill(Rect(m_ContentRect.x, y, m_ContentRect.width, m_ContentRect.bottom() - y), ' ', blank_color);
+}
+
+void Window::invalidate()
+{
+	m_Dirty = DirtyAll;
+}
+
+void Window::invalidate_frame()
+{
+	m_Dirty |= DirtyFrame;
+}
+
+bool Window::needs_draw(bool active) const
+{
+	return m_Dirty != 0 || active != m_DrawnActive || m_StartOffset != m_DrawnStartOffset;
+}
+
+void Window::draw(Console& console, bool active)
+{
+	if (active != m_DrawnActive)
+		m_Dirty |= DirtyFrame;
+	if ((m_Dirty & DirtyColors) && m_HighlightLines == m_DrawnHighlightLines)
+		m_Dirty &= ~DirtyColors;	// Cleared and set back to the same colors
+	if (m_StartOffset != m_DrawnStartOffset)
+		m_Dirty |= DirtyContent;
+
+	if (m_Dirty & DirtyFrame)
+		draw_frame(console, active);
+	if (m_Dirty & (DirtyContent | DirtyColors))
 	{
-		for (int ix = 0; ix < m_ContentRect.width; ++ix)
-		{
-			console.set_character(m_ContentRect.x + ix, y, ' ', blank_color);
-		}
+		draw_content(console);
+	}
+	else if (m_Dirty & DirtyHighlight)
+	{
+		// Only the rows losing and gaining the highlight change
+		draw_content_line(console, m_DrawnHighlightLine);
+		draw_content_line(console, m_HighlightLine);
 	}
+
+	if (m_Dirty & DirtyColors)
+		m_DrawnHighlightLines = m_HighlightLines;
+	m_Dirty = 0;
+	m_DrawnActive = active;
+	m_DrawnHighlightLine = m_HighlightLine;
+	m_DrawnStartOffset = m_StartOffset;
 }
 
 const Pointd& Window::get_size_percent() const 
@@ -232,8 +327,12 @@ void Window::set_size_percent(const Pointd& size_percent)
 
 void Window::set_rect(const Rect& rect)
 {
-	m_BorderRect = rect;
-	m_ContentRect = Rect(rect.x + 1, rect.y + 1, rect.width - 2, rect.height - 2);
+	if (rect != m_BorderRect)
+	{
+		m_BorderRect = rect;
+		m_ContentRect = Rect(rect.x + 1, rect.y + 1, rect.width - 2, rect.height - 2);
+		m_Dirty = DirtyAll;
+	}
 }
 
 int Window::get_highlight_line() const
@@ -243,23 +342,31 @@ int Window::get_highlight_line() const
 
 void Window::set_highlight_line(int line)
 {
-	m_HighlightLine = line;
+	if (line != m_HighlightLine)
+	{
+		m_HighlightLine = line;
+		m_Dirty |= DirtyHighlight;
+	}
 	ensure_visible(m_HighlightLine);
 }
 
 void Window::change_highlight_line(int delta)
 {
-	m_HighlightLine += delta;
-	if (m_HighlightLine < 0)
-		m_HighlightLine = 0;
-	if (m_HighlightLine >= int(m_ContentLines.size()))
-		m_HighlightLine = int(m_ContentLines.size()) - 1;
-	ensure_visible(m_HighlightLine);
+	int line = m_HighlightLine + delta;
+	if (line < 0)
+		line = 0;
+	if (line >= int(get_line_count()))
+		line = int(get_line_count()) - 1;
+	set_highlight_line(line);
 }
 
 void Window::ensure_visible(int line)
 {
-	if (line < 0 || line >= int(m_ContentLines.size()))
+	if (line < 0 || line >= int(get_line_count()))
+		return;
+
+	// Leave the view alone while the line is on screen
+	if (line >= m_StartOffset && line < m_StartOffset + m_ContentRect.height)
 		return;
 	
 	// Calculate the center position that would put the line in the middle
@@ -270,7 +377,7 @@ void Window::ensure_visible(int line)
 		center_offset = 0;
 	
 	// Make sure we don't scroll past the end
-	int max_offset = int(m_ContentLines.size()) - m_ContentRect.height;
+	int max_offset = int(get_line_count()) - m_ContentRect.height;
 	if (center_offset > max_offset)
 		center_offset = max_offset > 0 ? max_offset : 0;
 	
@@ -278,8 +385,20 @@ void Window::ensure_visible(int line)
 	m_StartOffset = center_offset;
 }
 
+Desktop::Desktop(Console& console)
+	: m_Console(&console)
+{}
+
+Console& Desktop::get_console()
+{
+	if (!m_Console)
+		m_Console = &terminal_console();
+	return *m_Console;
+}
+
 void Desktop::clear()
 {
+	Console& console = get_console();
 	console.clear();
 	m_Windows.clear();
 	console.draw_frame();
@@ -287,8 +406,13 @@ void Desktop::clear()
 
 void Desktop::draw(WindowPtr active_window)
 {
-	if (console.update())
-		console.clear();
+	Console& console = get_console();
+	// Windows redraw only what changed since they were last drawn.  After a
+	// resize the frame buffer starts out blank, so they are laid out again
+	// and redrawn in full.
+	bool resized = console.update();
+	if (resized && m_ResizeListener)
+		m_ResizeListener->on_resize(console.get_rect());
 	Point p(0, 0);
 	for (auto w : m_Windows)
 	{
@@ -301,8 +425,27 @@ void Desktop::draw(WindowPtr active_window)
 			w->set_rect(rect);
 			p.y += height;
 		}
-		w->draw(w == active_window);
+		if (resized)
+			w->invalidate();
+	}
+	// The new status line may not cover the old one, so that is blanked and
+	// the borders it was drawn over are drawn again
+	if (m_StatusChanged && !resized && m_StatusRect.width > 0)
+	{
+		console.fill(m_StatusRect, ' ', ColorPair());
+		for (auto w : m_Windows)
+		{
+			const Rect& rect = w->get_border_rect();
+			if (rect.y <= m_StatusRect.y && m_StatusRect.y < rect.bottom())
+				w->invalidate_frame();
+		}
 	}
+	for (auto w : m_Windows)
+	{
+		if (w->needs_draw(w == active_window))
+			w->draw(console, w == active_window);
+	}
+	m_StatusRect = Rect();
 	if (!m_StatusLine.empty())
 	{
 		int x = (get_rect().width - m_StatusLine.size() - 4) / 2;
@@ -312,29 +455,45 @@ void Desktop::draw(WindowPtr active_window)
 			text = text.substr(0, get_rect().width - 4);
 		Border border;
 		int y = get_rect().height - 1;
+		m_StatusRect = Rect(x, y, int(text.length()) + 4, 1);
 		ColorPair color;
 		console.set_character(x++, y, border.left_limiter, color);
 		console.set_character(x++, y, ' ', color);
-		for (size_t i = 0; i < text.length(); ++i)
-			console.set_character(x++, y, text[i], color);
+		console.write_run(x, y, text, color);
+		x += int(text.length());
 		console.set_character(x++, y, ' ', color);
 		console.set_character(x++, y, border.right_limiter, color);
 	}
+	m_StatusChanged = false;
 	console.draw_frame();
 }
 
 Key Desktop::get_key(bool wait)
 {
+	Console& console = get_console();
 	return console.get_key(wait);
 }
 
+char Desktop::get_typed_character()
+{
+	return get_console().get_typed_character();
+}
+
+void Desktop::wake()
+{
+	Console& console = get_console();
+	console.wake();
+}
+
 Rect Desktop::get_rect()
 {
+	Console& console = get_console();
 	return console.get_rect();
 }
 
 void Desktop::add_window(const WindowPtr& window)
 {
+	window->invalidate();
 	m_Windows.push_back(window);
 }
 
@@ -357,5 +516,12 @@ WindowPtr Desktop::get_window(size_t index) const
 
 void Desktop::set_status_line(const xstring& status_line)
 { 
+	if (status_line != m_StatusLine)
+		m_StatusChanged = true;
 	m_StatusLine = status_line;
 }
+
+void Desktop::set_resize_listener(ResizeListener* listener)
+{
+	m_ResizeListener = listener;
+}
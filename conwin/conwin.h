@@ -1,6 +1,8 @@
 #pragma once
 
+#include <cstdint>
 #include <memory>
+#include <string_view>
 #include <unordered_map>
 #include <types.h>
 #include <xstring.h>
@@ -41,7 +43,9 @@ enum class Key
 	F9,
 	F10,
 	F11,
-	F12
+	F12,
+	Backspace,
+	Character	// A printable character, see Desktop::get_typed_character()
 };
 
 struct ColorPair
@@ -50,18 +54,96 @@ struct ColorPair
 	Color background;
 	ColorPair(Color fg = Color::White, Color bg = Color::Black)
 		: foreground(fg), background(bg) {}
+
+	bool operator==(const ColorPair& other) const
+	{
+		return foreground == other.foreground && background == other.background;
+	}
+
+	bool operator!=(const ColorPair& other) const
+	{
+		return !(*this == other);
+	}
+};
+
+// Source of lines for a window whose content is owned elsewhere.  Only the
+// lines that come on screen are requested, at draw time.
+class ContentProvider
+{
+public:
+	virtual ~ContentProvider() = default;
+	virtual size_t				get_line_count() const = 0;
+	virtual const std::string&	get_line(size_t index) const = 0;
+};
+
+using ContentProviderPtr = std::shared_ptr<ContentProvider>;
+
+// Columns [start, start + length) of a line drawn in the given foreground
+struct StyleRun
+{
+	uint16_t	start;
+	uint16_t	length;
+	Color		foreground;
+};
+
+struct StyleRunRange
+{
+	const StyleRun*	first = nullptr;
+	const StyleRun*	last = nullptr;
+
+	const StyleRun*	begin() const { return first; }
+	const StyleRun*	end() const { return last; }
 };
 
+// Colors parts of lines, e.g. for syntax highlighting.  Only asked for the
+// lines that are drawn, with the whole text as it is drawn, before it is cut
+// to the window width.  The runs are sorted, don't overlap and stay valid
+// until the next call.
+class LineStyler
+{
+public:
+	virtual ~LineStyler() = default;
+	virtual StyleRunRange		style_line(size_t index, std::string_view text) = 0;
+	// Call when lines from first_line on changed
+	virtual void				invalidate(size_t first_line) = 0;
+};
+
+using LineStylerPtr = std::shared_ptr<LineStyler>;
+
+class Console;
+
 class Window
 {
 	Rect										m_BorderRect;
 	Rect										m_ContentRect;
 	std::unordered_map<size_t, ColorPair>		m_HighlightLines;
 	std::vector<xstring>						m_ContentLines;
+	ContentProviderPtr							m_Provider;
+	LineStylerPtr								m_Styler;
 	int											m_StartOffset = 0;
 	Pointd										m_SizePercent=Pointd(0,0);
 	xstring										m_Title, m_StatusLine;
 	int											m_HighlightLine = -1;
+
+	// What changed since the window was last drawn
+	enum DirtyFlags
+	{
+		DirtyFrame = 1,		// Border, title, status line or active state
+		DirtyContent = 2,
+		DirtyHighlight = 4,
+		DirtyColors = 8,
+		DirtyAll = DirtyFrame | DirtyContent | DirtyHighlight | DirtyColors
+	};
+	unsigned									m_Dirty = DirtyAll;
+	bool										m_DrawnActive = false;
+	int											m_DrawnHighlightLine = -1;
+	int											m_DrawnStartOffset = 0;
+	std::unordered_map<size_t, ColorPair>		m_DrawnHighlightLines;
+
+	ColorPair			get_draw_color(int line) const;
+	void				draw_frame(Console& console, bool active) const;
+	void				draw_content_line(Console& console, int line) const;
+	void				draw_content(Console& console) const;
 public:
 	Window(const Rect& border_rect);
 	Window(const Pointd& size_percent);
@@ -73,6 +155,16 @@ public:
 	void				set_content(const std::vector<xstring>& content_lines);
 	const std::vector<xstring>& get_content() const;
 	void				append_content(const xstring& line);
+	// Shows the provider's lines instead of the content lines
+	void				set_content_provider(const ContentProviderPtr& provider);
+	// Call when the provider's lines changed
+	void				content_changed();
+	// Colors the text of lines that have no line color.  Setting the
+	// content drops the styler.
+	void				set_line_styler(const LineStylerPtr& styler);
+	size_t				get_line_count() const;
+	// The line from the provider or the content lines
+	std::string_view	get_line(size_t index) const;
 	void				set_rect(const Rect& rect);
 	const Rect&			get_border_rect() const;
 	const Rect&			get_content_rect() const;
@@ -84,23 +176,51 @@ public:
 	void				set_highlight_line(int line);
 	void				change_highlight_line(int delta);
 	void				ensure_visible(int line);
-	void				draw(bool active) const;
+	// Marks everything for redraw, e.g. after the screen was cleared
+	void				invalidate();
+	// Marks only the border, e.g. after something else was drawn over it
+	void				invalidate_frame();
+	bool				needs_draw(bool active) const;
+	void				draw(Console& console, bool active);
 };
 
 using WindowPtr = std::shared_ptr<Window>;
 
+// Told by the desktop when the console changed size, before the windows are
+// redrawn, so they can be given new rects
+class ResizeListener
+{
+public:
+	virtual ~ResizeListener() = default;
+	virtual void on_resize(const Rect& desktop_rect) = 0;
+};
+
 class Desktop
 {
 	std::vector<WindowPtr>		m_Windows;
 	xstring						m_StatusLine;
+	Rect						m_StatusRect;		// Where it was last drawn
+	bool						m_StatusChanged = false;
+	Console*					m_Console = nullptr;	// The terminal when not given
+	ResizeListener*				m_ResizeListener = nullptr;
+
+	Console&						get_console();
 public:
+	Desktop() = default;
+	// Draws on the given console, e.g. a memory one, instead of the terminal
+	explicit Desktop(Console& console);
+
 	void							add_window(const WindowPtr& window);
 	const std::vector<WindowPtr>&	get_windows() const;
 	size_t							size() const;
 	WindowPtr						get_window(size_t index) const;
 	Rect							get_rect();
 	Key								get_key(bool wait = true);
+	// The character of the last Key::Character
+	char							get_typed_character();
+	void							wake();
 	void							clear();
 	void							draw(WindowPtr active_window);
 	void							set_status_line(const xstring& status_line);
+	void							set_resize_listener(ResizeListener* listener);
 };
@@ -1,13 +1,15 @@
 #ifdef _WIN32
 
+#include <algorithm>
 #include <stdexcept>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 
 #include "conwin.h"
 #include "types.h"
 
-#include "console.h"
+#include "consoleimpl.h"
 #include <Windows.h>
 #include <unordered_map>
 
@@ -19,6 +21,7 @@ static const std::unordered_map<WORD, Key> virtualKeyToKeyMap = {
     {VK_RIGHT, Key::Right},
     {VK_RETURN, Key::Enter},
     {VK_ESCAPE, Key::Escape},
+    {VK_BACK, Key::Backspace},
     {VK_PRIOR, Key::PageUp},
     {VK_NEXT, Key::PageDown},
     {VK_HOME, Key::Home},
@@ -37,14 +40,16 @@ static const std::unordered_map<WORD, Key> virtualKeyToKeyMap = {
     {VK_F12, Key::F12}
 };
 
-class ConsoleImpl
+class WindowsConsole : public ConsoleImpl
 {
-	HANDLE					handle, input_handle;
+	HANDLE					handle, input_handle, wake_event;
 	Rect					console_rect;
 	std::vector<CHAR_INFO>	frame_buffer;
+	std::vector<CHAR_INFO>	presented_buffer;	// What the console currently shows
+	WORD					attribute_table[8][8];	// Indexed by foreground, background
 public:
 
-	ConsoleImpl()
+	WindowsConsole()
 	{
 		handle = GetStdHandle(STD_OUTPUT_HANDLE);
 		if (handle == INVALID_HANDLE_VALUE)
@@ -56,22 +61,31 @@ public:
 		{
 			throw std::runtime_error("Failed to get console input handle");
 		}
+		// Deliver resizes as input events so get_key() can block on the handle
+		DWORD mode;
+		if (GetConsoleMode(input_handle, &mode))
+			SetConsoleMode(input_handle, mode | ENABLE_WINDOW_INPUT);
+		wake_event = CreateEvent(nullptr, FALSE, FALSE, nullptr);
+		for (int fg = 0; fg < 8; ++fg)
+			for (int bg = 0; bg < 8; ++bg)
+				attribute_table[fg][bg] = get_attribute(ColorPair(Color(fg), Color(bg)));
 		update();
 		set_cursor(0, 0);
 		clear();
 	}
 
-	~ConsoleImpl()
+	~WindowsConsole() override
 	{
-
+		if (wake_event)
+			CloseHandle(wake_event);
 	}
 
-	const Rect& get_rect()
+	const Rect& get_rect() override
 	{
 		return console_rect;
 	}
 
-	Key get_key(bool wait)
+	Key get_key(bool wait) override
 	{
 		DWORD n;
 		INPUT_RECORD input_record;
@@ -82,6 +96,8 @@ public:
 			{
 				if (ReadConsoleInput(input_handle, &input_record, 1, &n) && n > 0)
 				{
+					if (input_record.EventType == WINDOW_BUFFER_SIZE_EVENT)
+						return Key::None;	// The next update() picks up the new size
 					if (input_record.EventType == KEY_EVENT && input_record.Event.KeyEvent.bKeyDown)
 					{
 						WORD vkCode = input_record.Event.KeyEvent.wVirtualKeyCode;
@@ -92,6 +108,12 @@ public:
 						{
 							return it->second;
 						}
+						char ch = input_record.Event.KeyEvent.uChar.AsciiChar;
+						if (ch >= ' ' && ch <= '~')
+						{
+							typed_character = ch;
+							return Key::Character;
+						}
 					}
 				}
 			}
@@ -100,14 +122,14 @@ public:
 			if (!wait)
 				return Key::None;
 
-			if (update())
-			{
-				clear();
+			if (size_changed())
 				return Key::None;
-			}
 				
-			// Otherwise, wait for input and continue the loop
-			Sleep(100);
+			// Otherwise, wait for input or wake() and continue the loop
+			HANDLE handles[2] = { input_handle, wake_event };
+			DWORD count = wake_event ? 2 : 1;
+			if (WaitForMultipleObjects(count, handles, FALSE, INFINITE) == WAIT_OBJECT_0 + 1)
+				return Key::None;
 			
 		} while (wait);
 		
@@ -116,6 +138,12 @@ public:
 		return Key::None;
 	}
 
+	void wake() override
+	{
+		if (wake_event)
+			SetEvent(wake_event);
+	}
+
 	WORD get_attribute(const ColorPair& cp)
 	{
 		WORD foreground = 0;
@@ -195,7 +223,17 @@ public:
 	}
 
 
-	bool update()
+	bool size_changed()
+	{
+		CONSOLE_SCREEN_BUFFER_INFO csbi;
+		if (!GetConsoleScreenBufferInfo(handle, &csbi))
+			return false;
+		int width = csbi.srWindow.Right - csbi.srWindow.Left + 1;
+		int height = csbi.srWindow.Bottom - csbi.srWindow.Top + 1;
+		return width != console_rect.width || height != console_rect.height;
+	}
+
+	bool update() override
 	{
 		CONSOLE_SCREEN_BUFFER_INFO csbi;
 		if (GetConsoleScreenBufferInfo(handle, &csbi))
@@ -205,7 +243,9 @@ public:
 			if (width!=console_rect.width || height!=console_rect.height)
 			{
 				console_rect = Rect(0, 0, width, height);
-				frame_buffer.resize(width * height, CHAR_INFO{ ' ', csbi.wAttributes });
+				// assign() keeps the allocation when the console shrinks
+				frame_buffer.assign(width * height, CHAR_INFO{ ' ', 0x07 });
+				presented_buffer.assign(frame_buffer.size(), CHAR_INFO{ 0, 0xFFFF });
 				return true;
 			}
 		}
@@ -216,10 +256,16 @@ public:
 		return false;
 	}
 
-	void clear()
+	void clear() override
 	{
 		update();
 		frame_buffer.assign(frame_buffer.size(), CHAR_INFO{ ' ', 0x07 });
+		presented_buffer.assign(frame_buffer.size(), CHAR_INFO{ 0, 0xFFFF });
+	}
+
+	static bool same_cell(const CHAR_INFO& a, const CHAR_INFO& b)
+	{
+		return a.Char.UnicodeChar == b.Char.UnicodeChar && a.Attributes == b.Attributes;
 	}
 
 	CHAR_INFO& operator()(const Point& p)
@@ -234,7 +280,7 @@ public:
 		return frame_buffer[y * console_rect.width + x];
 	}
 
-	void set_cursor(int x, int y)
+	void set_cursor(int x, int y) override
 	{
 		COORD coord = { static_cast<SHORT>(x), static_cast<SHORT>(y) };
 		if (!SetConsoleCursorPosition(handle, coord))
@@ -243,69 +289,85 @@ public:
 		}
 	}
 
-	void set_character(int x, int y, wchar_t ch, const ColorPair& color)
+	void set_character(int x, int y, wchar_t ch, const ColorPair& color) override
 	{
 		if (x < 0 || x >= console_rect.width || y < 0 || y >= console_rect.height)
 			throw std::runtime_error("Coordinates out of bounds");
 		auto& c = operator()(x, y);
 		c.Char.UnicodeChar = ch;
-		c.Attributes = get_attribute(color);
+		c.Attributes = attribute_table[int(color.foreground)][int(color.background)];
+	}
+
+	void write_run(int x, int y, std::string_view text, const ColorPair& color) override
+	{
+		if (y < 0 || y >= console_rect.height)
+			return;
+		if (x < 0)
+		{
+			if (size_t(-x) >= text.size()) return;
+			text.remove_prefix(size_t(-x));
+			x = 0;
+		}
+		if (x >= console_rect.width)
+			return;
+		size_t n = std::min(text.size(), size_t(console_rect.width - x));
+		const WORD attribute = attribute_table[int(color.foreground)][int(color.background)];
+		CHAR_INFO* cell = &frame_buffer[y * console_rect.width + x];
+		for (size_t i = 0; i < n; ++i)
+		{
+			cell[i].Char.UnicodeChar = WCHAR((unsigned char)text[i]);
+			cell[i].Attributes = attribute;
+		}
 	}
 
-	void draw_frame()
+	void fill(const Rect& rect, wchar_t ch, const ColorPair& color) override
 	{
+		Rect r = rect.intersection(console_rect);
+		CHAR_INFO cell;
+		cell.Char.UnicodeChar = ch;
+		cell.Attributes = attribute_table[int(color.foreground)][int(color.background)];
+		for (int y = r.y; y < r.bottom(); ++y)
+		{
+			CHAR_INFO* row = &frame_buffer[y * console_rect.width];
+			std::fill(row + r.x, row + r.right(), cell);
+		}
+	}
+
+	void draw_frame() override
+	{
+		// Only write the band of rows that changed since the last frame
+		const int width = console_rect.width;
+		int first_row = -1, last_row = -1;
+		for (int y = 0; y < console_rect.height; ++y)
+		{
+			const CHAR_INFO* row = &frame_buffer[y * width];
+			CHAR_INFO* presented = &presented_buffer[y * width];
+			for (int x = 0; x < width; ++x)
+			{
+				if (!same_cell(row[x], presented[x]))
+				{
+					std::copy(row, row + width, presented);
+					if (first_row < 0) first_row = y;
+					last_row = y;
+					break;
+				}
+			}
+		}
+		++stats.frames;
+		if (first_row < 0)
+			return;
+		++stats.runs;
+		stats.cells += size_t(last_row - first_row + 1) * width;
 		COORD buffer_size = { SHORT(console_rect.width), SHORT(console_rect.height) };
-		COORD buffer_coord = { 0, 0 };
-		SMALL_RECT write_region = { 0, 0, SHORT(console_rect.width - 1), SHORT(console_rect.height - 1) };
+		COORD buffer_coord = { 0, SHORT(first_row) };
+		SMALL_RECT write_region = { 0, SHORT(first_row), SHORT(console_rect.width - 1), SHORT(last_row) };
 		WriteConsoleOutputW(handle, frame_buffer.data(), buffer_size, buffer_coord, &write_region);
 	}
 };
 
-// Implement Console class methods
-Console::Console()
+std::unique_ptr<ConsoleImpl> create_terminal_console()
 {
-	m_Impl = std::make_unique<ConsoleImpl>();
+	return std::make_unique<WindowsConsole>();
 }
 
-Console::~Console()
-{
-// m_Impl is automatically destroyed
-}
-
-const Rect& Console::get_rect()
-{
-	return m_Impl->get_rect();
-}
-
-Key Console::get_key(bool wait)
-{
-	return m_Impl->get_key(wait);
-}
-
-bool Console::update()
-{
-	return m_Impl->update();
-}
-
-void Console::clear()
-{
-	m_Impl->clear();
-}
-
-void Console::set_cursor(int x, int y)
-{
-	m_Impl->set_cursor(x, y);
-}
-
-void Console::set_character(int x, int y, wchar_t ch, const ColorPair& color)
-{
-	m_Impl->set_character(x, y, ch, color);
-}
-
-void Console::draw_frame()
-{
-	m_Impl->draw_frame();
-}
-
-
 #endif // _WIN32
@@ -0,0 +1,172 @@
+#include <cmath>
+#include <cstring>
+#include <new>
+#include <buffer.h>
+#include "buffermodule.h"
+
+const char* buffer_module_code = R"(
+foreign class Buffer {
+	construct new(size) {}
+	foreign static fromString(text)
+	foreign size
+	foreign [index]
+	foreign [index]=(value)
+	foreign slice(offset, length)
+	foreign toString
+}
+)";
+
+void abort_fiber(WrenVM* vm, const char* message)
+{
+	wrenSetSlotString(vm, 0, message);
+	wrenAbortFiber(vm, 0);
+}
+
+Buffer get_data(WrenVM* vm, int slot)
+{
+	if (wrenGetSlotType(vm, slot) != WREN_TYPE_STRING)
+		return SlotTraits<Buffer>::get(vm, slot);
+	int length = 0;
+	const char* text = wrenGetSlotBytes(vm, slot, &length);
+	Buffer buffer{ size_t(length) };
+	std::memcpy(buffer.data(), text, size_t(length));
+	return buffer;
+}
+
+// Reads a whole number in [0, limit] from slot, or aborts the fiber
+static bool get_size(WrenVM* vm, int slot, size_t limit, size_t& value, const char* message)
+{
+	if (wrenGetSlotType(vm, slot) != WREN_TYPE_NUM)
+	{
+		abort_fiber(vm, message);
+		return false;
+	}
+	double number = wrenGetSlotDouble(vm, slot);
+	if (number < 0 || number > double(limit) || std::trunc(number) != number)
+	{
+		abort_fiber(vm, message);
+		return false;
+	}
+	value = size_t(number);
+	return true;
+}
+
+static void buffer_allocate(WrenVM* vm)
+{
+	void* memory = wrenSetSlotNewForeign(vm, 0, 0, sizeof(Buffer));
+	// Constructed first, so the finalizer always has a Buffer to destroy
+	Buffer& buffer = *new (memory) Buffer();
+	size_t size = 0;
+	if (!get_size(vm, 1, size_t(1) << 40, size, "Buffer size must be a non-negative integer."))
+		return;
+	try
+	{
+		buffer = Buffer(size);
+	}
+	catch (const std::bad_alloc&)
+	{
+		abort_fiber(vm, "Not enough memory for the Buffer.");
+	}
+}
+
+static void buffer_finalize(void* data)
+{
+	static_cast<Buffer*>(data)->~Buffer();
+}
+
+static void buffer_from_string(WrenVM* vm)
+{
+	if (wrenGetSlotType(vm, 1) != WREN_TYPE_STRING)
+	{
+		abort_fiber(vm, "Text must be a string.");
+		return;
+	}
+	SlotTraits<Buffer>::set(vm, 0, get_data(vm, 1));
+}
+
+static void buffer_size(WrenVM* vm)
+{
+	wrenSetSlotDouble(vm, 0, double(SlotTraits<Buffer>::get(vm, 0).size()));
+}
+
+// Reads an index of a byte in buffer, or aborts the fiber
+static bool get_index(WrenVM* vm, int slot, const Buffer& buffer, size_t& index)
+{
+	if (!get_size(vm, slot, buffer.size(), index, "Index out of bounds."))
+		return false;
+	if (index == buffer.size())
+	{
+		abort_fiber(vm, "Index out of bounds.");
+		return false;
+	}
+	return true;
+}
+
+static void buffer_get(WrenVM* vm)
+{
+	const Buffer& buffer = SlotTraits<Buffer>::get(vm, 0);
+	size_t index = 0;
+	if (get_index(vm, 1, buffer, index))
+		wrenSetSlotDouble(vm, 0, buffer.data()[index]);
+}
+
+static void buffer_set(WrenVM* vm)
+{
+	const Buffer& buffer = SlotTraits<Buffer>::get(vm, 0);
+	size_t index = 0;
+	size_t value = 0;
+	if (!get_index(vm, 1, buffer, index) ||
+		!get_size(vm, 2, 255, value, "Byte value must be an integer from 0 to 255."))
+		return;
+	if (buffer.read_only())
+	{
+		abort_fiber(vm, "Buffer is read-only.");
+		return;
+	}
+	buffer.data()[index] = uint8_t(value);
+	wrenSetSlotDouble(vm, 0, double(value));
+}
+
+static void buffer_slice(WrenVM* vm)
+{
+	const Buffer& buffer = SlotTraits<Buffer>::get(vm, 0);
+	size_t offset = 0;
+	size_t length = 0;
+	if (!get_size(vm, 1, buffer.size(), offset, "Slice offset out of bounds.") ||
+		!get_size(vm, 2, buffer.size() - offset, length, "Slice length out of bounds."))
+		return;
+	// Taken before slot 0, and possibly the receiver, goes away
+	Buffer view = buffer.slice(offset, length);
+	SlotTraits<Buffer>::set(vm, 0, std::move(view));
+}
+
+static void buffer_to_string(WrenVM* vm)
+{
+	const Buffer& buffer = SlotTraits<Buffer>::get(vm, 0);
+	wrenSetSlotBytes(vm, 0, reinterpret_cast<const char*>(buffer.data()), buffer.size());
+}
+
+WrenForeignMethodFn bind_buffer_method(const char* class_name, bool is_static, const char* signature)
+{
+	static const ModuleMethod methods[] =
+	{
+		{ "Buffer", true, "fromString(_)", buffer_from_string },
+		{ "Buffer", false, "size", buffer_size },
+		{ "Buffer", false, "[_]", buffer_get },
+		{ "Buffer", false, "[_]=(_)", buffer_set },
+		{ "Buffer", false, "slice(_,_)", buffer_slice },
+		{ "Buffer", false, "toString", buffer_to_string },
+	};
+	return find_module_method(methods, class_name, is_static, signature);
+}
+
+WrenForeignClassMethods bind_buffer_class(const char* class_name)
+{
+	WrenForeignClassMethods methods = { nullptr, nullptr };
+	if (std::strcmp(class_name, "Buffer") == 0)
+	{
+		methods.allocate = buffer_allocate;
+		methods.finalize = buffer_finalize;
+	}
+	return methods;
+}
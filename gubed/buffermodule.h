@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <buffer.h>
+#include <wren.hpp>
+
+// Wren code of the built-in "buffer" module, which defines Buffer
+extern const char* buffer_module_code;
+
+// nullptr for methods the Buffer class doesn't have
+WrenForeignMethodFn bind_buffer_method(const char* class_name, bool is_static, const char* signature);
+// Empty methods for classes other than Buffer
+WrenForeignClassMethods bind_buffer_class(const char* class_name);
+
+// Helpers of the built-in modules, which all take Buffers
+
+// Aborts the current fiber with message as its error
+void abort_fiber(WrenVM* vm, const char* message);
+
+// The string or Buffer in slot.  A string is copied, since it may be
+// collected while a job still uses its bytes.
+Buffer get_data(WrenVM* vm, int slot);
+
+// An entry of a module's table of foreign methods
+struct ModuleMethod
+{
+	const char*			class_name;
+	bool				is_static;
+	const char*			signature;
+	WrenForeignMethodFn	func;
+};
+
+// The method of methods matching the arguments, or nullptr
+template<size_t N>
+WrenForeignMethodFn find_module_method(const ModuleMethod (&methods)[N], const char* class_name, bool is_static, const char* signature)
+{
+	for (const auto& method : methods)
+	{
+		if (std::strcmp(method.class_name, class_name) == 0 &&
+			method.is_static == is_static && std::strcmp(method.signature, signature) == 0)
+			return method.func;
+	}
+	return nullptr;
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <algorithm>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+#include <singleton.h>
+#include "linemapper.h"
+
+// Hit counts collected by modules instrumented for profiling or coverage
+class ExecutionCounters
+{
+	std::unordered_map<LineId, size_t>	m_Counts;
+
+	ExecutionCounters() = default;
+	ExecutionCounters(const ExecutionCounters&) = delete;
+	ExecutionCounters& operator=(const ExecutionCounters&) = delete;
+	friend class Singleton<ExecutionCounters>;
+public:
+	void hit(LineId id)
+	{
+		++m_Counts[id];
+	}
+
+	bool empty() const
+	{
+		return m_Counts.empty();
+	}
+
+	// Writes "module:line count" rows, sorted by module and line
+	void write_report(std::ostream& os) const
+	{
+		struct Row
+		{
+			const LineDetails* details;
+			size_t count;
+		};
+		std::vector<LineDetails> details(m_Counts.size());
+		std::vector<Row> rows;
+		size_t i = 0;
+		for (const auto& [id, count] : m_Counts)
+		{
+			if (Singleton<LineMapper>::Instance().get_line_details(id, details[i]))
+			{
+				rows.push_back({ &details[i], count });
+				++i;
+			}
+		}
+		std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b)
+		{
+			if (a.details->module->get_name() != b.details->module->get_name())
+				return a.details->module->get_name() < b.details->module->get_name();
+			return a.details->line_index < b.details->line_index;
+		});
+		for (const auto& row : rows)
+		{
+			os << row.details->module->get_name() << ':' << (row.details->line_index + 1)
+				<< ' ' << row.count << '\n';
+		}
+	}
+};
@@ -3,6 +3,9 @@
 #include <vector>
 #include <string>
 #include <wren.hpp>
+#include <binder.h>
+#include <foreignregistry.h>
+#include <singleton.h>
 #include "foreigns.h"
 
 
@@ -45,6 +48,9 @@ public:
 			if (!Shutdown) throw std::runtime_error("No Shutdown function found in " + dll_path);
 			GetFunction = (void* (*)(const char*))GetProcAddress(hModule, "GetFunction");
 			if (!GetFunction) throw std::runtime_error("No GetFunction found in " + dll_path);
+			// Optional
+			EnumerateFunctions = (void (*)(EnumerateCallback, void*))GetProcAddress(hModule, "EnumerateFunctions");
+			EnumerateClasses = (void (*)(EnumerateClassCallback, void*))GetProcAddress(hModule, "EnumerateClasses");
 		}
 		catch (const std::exception& e)
 		{
@@ -57,6 +63,8 @@ public:
 			Initialize = nullptr;
 			Shutdown = nullptr;
 			GetFunction = nullptr;
+			EnumerateFunctions = nullptr;
+			EnumerateClasses = nullptr;
 		}
 	}
 
@@ -75,6 +83,11 @@ public:
 		return hModule != nullptr && Initialize != nullptr && Shutdown != nullptr && GetFunction != nullptr;
 	}
 
+	const std::string& get_path() const
+	{
+		return dll_path;
+	}
+
 	void* Get(const char* name) const
 	{
 		if (GetFunction)
@@ -90,12 +103,30 @@ public:
 			Initialize(vm);
 	}
 
+	// Returns false when the module doesn't export EnumerateFunctions
+	bool Enumerate(EnumerateCallback callback, void* context) const
+	{
+		if (!is_valid() || !EnumerateFunctions)
+			return false;
+		EnumerateFunctions(callback, context);
+		return true;
+	}
+
+	// Foreign classes can only be bound through EnumerateClasses
+	void EnumerateForeignClasses(EnumerateClassCallback callback, void* context) const
+	{
+		if (is_valid() && EnumerateClasses)
+			EnumerateClasses(callback, context);
+	}
+
 private:
 	std::string dll_path;
 	HMODULE hModule;
 	void (*Initialize)(WrenVM* vm);
 	void (*Shutdown)();
 	void* (*GetFunction)(const char* name);
+	void (*EnumerateFunctions)(EnumerateCallback callback, void* context) = nullptr;
+	void (*EnumerateClasses)(EnumerateClassCallback callback, void* context) = nullptr;
 };
 
 #endif
@@ -123,6 +154,9 @@ public:
 			if (!Shutdown) throw std::runtime_error("No Shutdown function found in " + lib_path);
 			GetFunction = (void* (*)(const char*))dlsym(hModule, "GetFunction");
 			if (!GetFunction) throw std::runtime_error("No GetFunction found in " + lib_path);
+			// Optional
+			EnumerateFunctions = (void (*)(EnumerateCallback, void*))dlsym(hModule, "EnumerateFunctions");
+			EnumerateClasses = (void (*)(EnumerateClassCallback, void*))dlsym(hModule, "EnumerateClasses");
 		}
 		catch (const std::exception& e)
 		{
@@ -135,6 +169,8 @@ public:
 			Initialize = nullptr;
 			Shutdown = nullptr;
 			GetFunction = nullptr;
+			EnumerateFunctions = nullptr;
+			EnumerateClasses = nullptr;
 		}
 	}
 
@@ -153,6 +189,11 @@ public:
 		return hModule != nullptr && Initialize != nullptr && Shutdown != nullptr && GetFunction != nullptr;
 	}
 
+	const std::string& get_path() const
+	{
+		return lib_path;
+	}
+
 	void* Get(const char* name) const
 	{
 		if (GetFunction)
@@ -167,12 +208,30 @@ public:
 		if (is_valid())
 			Initialize(vm);
 	}
+
+	// Returns false when the module doesn't export EnumerateFunctions
+	bool Enumerate(EnumerateCallback callback, void* context) const
+	{
+		if (!is_valid() || !EnumerateFunctions)
+			return false;
+		EnumerateFunctions(callback, context);
+		return true;
+	}
+
+	// Foreign classes can only be bound through EnumerateClasses
+	void EnumerateForeignClasses(EnumerateClassCallback callback, void* context) const
+	{
+		if (is_valid() && EnumerateClasses)
+			EnumerateClasses(callback, context);
+	}
 private:
 	std::string lib_path;
 	void* hModule;
 	void (*Initialize)(WrenVM* vm);
 	void (*Shutdown)();
 	void* (*GetFunction)(const char* name);
+	void (*EnumerateFunctions)(EnumerateCallback callback, void* context) = nullptr;
+	void (*EnumerateClasses)(EnumerateClassCallback callback, void* context) = nullptr;
 };
 
 
@@ -195,6 +254,30 @@ std::vector<std::string> find_shared_libraries(const std::string& path)
 typedef std::shared_ptr<NativeModule> NativeModulePtr;
 
 std::vector<NativeModulePtr> native_modules;
+// Modules without EnumerateFunctions, asked one by one at bind time
+std::vector<NativeModulePtr> unenumerated_modules;
+
+static void register_function(void* context, const char* name, void (*func)(WrenVM* vm))
+{
+	const NativeModule* module = static_cast<const NativeModule*>(context);
+	ForeignRegistry& registry = Singleton<ForeignRegistry>::Instance();
+	if (!registry.add(name, func, module->get_path()))
+	{
+		std::cerr << "Foreign method " << name << " is bound by both " << registry.get_owner(name)
+				  << " and " << module->get_path() << ", using the first" << std::endl;
+	}
+}
+
+static void register_class(void* context, const char* name, WrenForeignClassMethods methods)
+{
+	const NativeModule* module = static_cast<const NativeModule*>(context);
+	ForeignRegistry& registry = Singleton<ForeignRegistry>::Instance();
+	if (!registry.add_class(name, methods, module->get_path()))
+	{
+		std::cerr << "Foreign class " << name << " is bound by both " << registry.get_class_owner(name)
+				  << " and " << module->get_path() << ", using the first" << std::endl;
+	}
+}
 
 void load_shared_libraries(const std::string& path, WrenVM* vm)
 {
@@ -205,6 +288,11 @@ void load_shared_libraries(const std::string& path, WrenVM* vm)
 		if (module->is_valid())
 		{
 			native_modules.push_back(module);
+			// Wren binds foreign methods and classes while Init interprets
+			// the module code, so they must be findable before
+			if (!module->Enumerate(register_function, module.get()))
+				unenumerated_modules.push_back(module);
+			module->EnumerateForeignClasses(register_class, module.get());
 			module->Init(vm);
 		}
 		else
@@ -216,25 +304,30 @@ void load_shared_libraries(const std::string& path, WrenVM* vm)
 
 void initialize_foreign_modules(const std::string& path, WrenVM* vm)
 {
-	native_modules.clear();
+	shutdown_foreign_modules();
 	load_shared_libraries(path, vm);
 }
 
 void shutdown_foreign_modules()
 {
+	Singleton<ForeignRegistry>::Instance().clear();
+	unenumerated_modules.clear();
 	native_modules.clear();
 }
 
 void* find_foreign_method(const std::string& key)
 {
-	for (auto& module : native_modules)
+	if (WrenForeignMethodFn func = Singleton<ForeignRegistry>::Instance().find(key))
+		return (void*)func;
+	for (auto& module : unenumerated_modules)
 	{
-		if (module->is_valid())
-		{
-			void* func = module->Get(key.c_str());
-			if (func) return func;
-		}
+		void* func = module->Get(key.c_str());
+		if (func) return func;
 	}
 	return nullptr;
 }
 
+bool find_foreign_class(const std::string& key, WrenForeignClassMethods& methods)
+{
+	return Singleton<ForeignRegistry>::Instance().find_class(key, methods);
+}
@@ -1,5 +1,10 @@
 #pragma once
 
+#include <string>
+#include <wren.hpp>
+
 void initialize_foreign_modules(const std::string& path, WrenVM* vm);
 void shutdown_foreign_modules();
 void* find_foreign_method(const std::string& key);
+// Looks up "module.Class" among the plugins' foreign classes
+bool find_foreign_class(const std::string& key, WrenForeignClassMethods& methods);
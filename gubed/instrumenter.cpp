@@ -9,6 +9,7 @@
 #include <memory>
 #include "strutils.h"
 #include "linemapper.h"
+#include "policy.h"
 
 typedef std::vector<std::string> lines_vec;
 
@@ -52,10 +53,6 @@ std::string unite(const lines_vec& lines)
 	return code;
 }
 
-std::regex class_regex(R"(\s*class\s+(\w+)\s*\{)");
-std::regex method_regex(R"(\s*(?:static\s+)?(\w+)\s*\(([^)]*)\)\s*\{)");
-std::regex var_regex(R"(\s*var\s+(\w+)\s*=\s*.+)");
-
 class Module : public IModule, public std::enable_shared_from_this<Module>
 {
 	xstring		m_Name;
@@ -91,7 +88,7 @@ class Module : public IModule, public std::enable_shared_from_this<Module>
 		return res;
 	}
 
-	void add_debugger_line(const std::string& ws, const std::string& class_name, const std::string& method_name, size_t line_index, const std::vector<Block>& block_stack)
+	void add_debugger_line(InstrumentationMode mode, const std::string& ws, const std::string& class_name, const std::string& method_name, size_t line_index, const std::vector<Block>& block_stack)
 	{
 		size_t line_id;
 		std::string instrumented_line;
@@ -105,7 +102,10 @@ class Module : public IModule, public std::enable_shared_from_this<Module>
 												   instrumented_line_index, line_index);
 		{
 			std::ostringstream os;
-			os << ws << "Gubedder.callback(" << line_id << ", " << format_variables_string(block_stack) << ")";
+			if (mode == InstrumentationMode::Full)
+				os << ws << "Gubedder.callback(" << line_id << ", " << format_variables_string(block_stack) << ")";
+			else
+				os << ws << "Gubedder.hit(" << line_id << ")";
 			instrumented_line = os.str();
 		}
 		m_InstrumentedCode.push_back(instrumented_line);
@@ -153,8 +153,12 @@ public:
 		return buffer;
 	}
 
-	void instrument()
+	void instrument(InstrumentationMode mode)
 	{
+		// Compiled on first use, so runs that never instrument don't pay for them
+		static const std::regex class_regex(R"(\s*class\s+(\w+)\s*\{)");
+		static const std::regex method_regex(R"(\s*(?:static\s+)?(\w+)\s*\(([^)]*)\)\s*\{)");
+		static const std::regex var_regex(R"(\s*var\s+(\w+)\s*=\s*.+)");
 		m_InstrumentedCode.clear();
 		m_InstrumentedCode.push_back("import \"gubed\" for Gubedder");
 		std::string class_name;
@@ -199,13 +203,15 @@ public:
 					}
 					++brace_count;
 					m_InstrumentedCode.push_back(line);
+					if (mode == InstrumentationMode::Profile)
+						add_debugger_line(mode, ws + "\t", class_name, method_name, i, block_stack);
 					continue;
 				}
 			}
 			if (!method_name.empty())
 			{
-				if (brace_count>=2)
-					add_debugger_line(ws, class_name, method_name, i, block_stack);
+				if (brace_count>=2 && mode != InstrumentationMode::Profile)
+					add_debugger_line(mode, ws, class_name, method_name, i, block_stack);
 				if (std::regex_search(line, match, var_regex))
 				{
 					std::string var_name = match[1].str();
@@ -241,6 +247,14 @@ typedef std::shared_ptr<Module> ModulePtr;
 
 std::unordered_map<std::string, ModulePtr> modules;
 
+std::shared_ptr<IModule> find_module(const std::string& name)
+{
+	auto it = modules.find(name);
+	if (it != modules.end())
+		return it->second;
+	return nullptr;
+}
+
 const char* load_module_code(const char* name)
 {
 	auto it = modules.find(name);
@@ -257,7 +271,11 @@ const char* load_module_code(const char* name)
 	modules[name] = module;
 
 	if (instrumentation_enabled)
-		module->instrument();
+	{
+		InstrumentationMode mode = Singleton<InstrumentationPolicy>::Instance().get_mode(name);
+		if (mode != InstrumentationMode::None)
+			module->instrument(mode);
+	}
 
 	return module->allocate_code();
 }
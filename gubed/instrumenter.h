@@ -1,5 +1,8 @@
 #pragma once
 
+#include <memory>
+#include "linemapper.h"
+
 // Call this to run the script without debugging
 void disable_instrumentation();
 bool is_instrumentation_enabled();
@@ -7,3 +10,6 @@ bool is_instrumentation_enabled();
 // Caller owns the memory returned by this function.
 // Must call delete[]
 const char* load_module_code(const char* name);
+
+// Module already loaded by the VM, or nullptr
+std::shared_ptr<IModule> find_module(const std::string& name);
@@ -0,0 +1,177 @@
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <buffer.h>
+#include <fileio.h>
+#include "buffermodule.h"
+#include "iomodule.h"
+#include "scheduler.h"
+
+// Every operation runs as a job (see scheduler.h): the calling fiber waits,
+// and other scheduled fibers run meanwhile.
+const char* io_module_code = R"(
+import "buffer" for Buffer
+import "jobs" for Scheduler
+
+class File {
+	static read(path) {
+		checkPath_(path)
+		read_(Fiber.current, path)
+		return Scheduler.runNextScheduled_()
+	}
+
+	static write(path, data) {
+		checkPath_(path)
+		if (!(data is String) && !(data is Buffer)) Fiber.abort("Data must be a string or a Buffer.")
+		write_(Fiber.current, path, data)
+		return Scheduler.runNextScheduled_()
+	}
+
+	static size(path) {
+		checkPath_(path)
+		size_(Fiber.current, path)
+		return Scheduler.runNextScheduled_()
+	}
+
+	static stream(path, chunkSize, fn) {
+		checkPath_(path)
+		if (!(chunkSize is Num) || !chunkSize.isInteger || chunkSize < 1) Fiber.abort("chunkSize must be a positive integer.")
+		var stream = FileStream_.new(path, chunkSize)
+		var total = 0
+		while (true) {
+			stream.read_(Fiber.current)
+			var chunk = Scheduler.runNextScheduled_()
+			if (chunk.size == 0) break
+			total = total + chunk.size
+			fn.call(chunk)
+		}
+		stream.close()
+		return total
+	}
+
+	static checkPath_(path) {
+		if (!(path is String)) Fiber.abort("Path must be a string.")
+	}
+
+	foreign static read_(fiber, path)
+	foreign static write_(fiber, path, data)
+	foreign static size_(fiber, path)
+}
+
+foreign class FileStream_ {
+	construct new(path, chunkSize) {}
+	foreign read_(fiber)
+	foreign close()
+}
+
+class Directory {
+	static list(path) {
+		File.checkPath_(path)
+		list_(Fiber.current, path)
+		return Scheduler.runNextScheduled_()
+	}
+
+	foreign static list_(fiber, path)
+}
+)";
+
+static Scheduler::Deliver deliver_buffer(Buffer buffer)
+{
+	return [buffer](WrenVM* vm, int slot) { SlotTraits<Buffer>::set(vm, slot, buffer); };
+}
+
+static void file_read(WrenVM* vm)
+{
+	std::string path = wrenGetSlotString(vm, 2);
+	Singleton<Scheduler>::Instance().submit(vm, 1, [path]
+	{
+		return deliver_buffer(read_file(path));
+	});
+}
+
+static void file_write(WrenVM* vm)
+{
+	std::string path = wrenGetSlotString(vm, 2);
+	Buffer data = get_data(vm, 3);
+	Singleton<Scheduler>::Instance().submit(vm, 1, [path, data]() -> Scheduler::Deliver
+	{
+		write_file(path, data.data(), data.size());
+		double size = double(data.size());
+		return [size](WrenVM* vm, int slot) { wrenSetSlotDouble(vm, slot, size); };
+	});
+}
+
+static void file_size(WrenVM* vm)
+{
+	std::string path = wrenGetSlotString(vm, 2);
+	Singleton<Scheduler>::Instance().submit(vm, 1, [path]() -> Scheduler::Deliver
+	{
+		double size = double(get_file_size(path));
+		return [size](WrenVM* vm, int slot) { wrenSetSlotDouble(vm, slot, size); };
+	});
+}
+
+static void directory_list(WrenVM* vm)
+{
+	std::string path = wrenGetSlotString(vm, 2);
+	Singleton<Scheduler>::Instance().submit(vm, 1, [path]() -> Scheduler::Deliver
+	{
+		std::vector<std::string> names = list_directory(path);
+		return [names](WrenVM* vm, int slot) { SlotTraits<std::vector<std::string>>::set(vm, slot, names); };
+	});
+}
+
+// The reader is shared with the job reading from it, so it outlives the
+// Wren object if that is collected mid-read
+using FileStream = std::shared_ptr<FileReader>;
+
+static void stream_allocate(WrenVM* vm)
+{
+	void* memory = wrenSetSlotNewForeign(vm, 0, 0, sizeof(FileStream));
+	new (memory) FileStream(std::make_shared<FileReader>(wrenGetSlotString(vm, 1), size_t(wrenGetSlotDouble(vm, 2))));
+}
+
+static void stream_finalize(void* data)
+{
+	static_cast<FileStream*>(data)->~FileStream();
+}
+
+static void stream_read(WrenVM* vm)
+{
+	FileStream stream = *static_cast<FileStream*>(wrenGetSlotForeign(vm, 0));
+	Singleton<Scheduler>::Instance().submit(vm, 1, [stream]
+	{
+		return deliver_buffer(stream->read());
+	});
+}
+
+static void stream_close(WrenVM* vm)
+{
+	(*static_cast<FileStream*>(wrenGetSlotForeign(vm, 0)))->close();
+}
+
+WrenForeignMethodFn bind_io_method(const char* class_name, bool is_static, const char* signature)
+{
+	static const ModuleMethod methods[] =
+	{
+		{ "File", true, "read_(_,_)", file_read },
+		{ "File", true, "write_(_,_,_)", file_write },
+		{ "File", true, "size_(_,_)", file_size },
+		{ "FileStream_", false, "read_(_)", stream_read },
+		{ "FileStream_", false, "close()", stream_close },
+		{ "Directory", true, "list_(_,_)", directory_list },
+	};
+	return find_module_method(methods, class_name, is_static, signature);
+}
+
+WrenForeignClassMethods bind_io_class(const char* class_name)
+{
+	WrenForeignClassMethods methods = { nullptr, nullptr };
+	if (std::strcmp(class_name, "FileStream_") == 0)
+	{
+		methods.allocate = stream_allocate;
+		methods.finalize = stream_finalize;
+	}
+	return methods;
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <wren.hpp>
+
+// The built-in Wren module the File and Directory classes are defined in
+constexpr const char* IO_MODULE = "io";
+
+// Wren code of the "io" module
+extern const char* io_module_code;
+
+// nullptr for methods the io module doesn't have
+WrenForeignMethodFn bind_io_method(const char* class_name, bool is_static, const char* signature);
+// Empty methods for classes other than its foreign ones
+WrenForeignClassMethods bind_io_class(const char* class_name);
@@ -0,0 +1,144 @@
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <buffer.h>
+#include "buffermodule.h"
+#include "jobsmodule.h"
+#include "scheduler.h"
+
+// A fiber that waits for a job lets the next scheduled fiber run, or, when
+// there is none, suspends the VM until the host resumes it with the result.
+// Scheduled fibers only start when another fiber waits, as in wren-cli.
+const char* jobs_module_code = R"(
+import "buffer" for Buffer
+
+class Scheduler {
+	static add(callable) {
+		if (__scheduled == null) __scheduled = []
+		__scheduled.add(Fiber.new {
+			callable.call()
+			runNextScheduled_()
+		})
+	}
+
+	static runNextScheduled_() {
+		if (__scheduled == null || __scheduled.isEmpty) return Fiber.suspend()
+		return __scheduled.removeAt(0).transfer()
+	}
+}
+
+class Jobs {
+	foreign static threads
+
+	static hash(data) {
+		if (!(data is String) && !(data is Buffer)) Fiber.abort("Data must be a string or a Buffer.")
+		hash_(Fiber.current, data)
+		return Scheduler.runNextScheduled_()
+	}
+
+	static map(buffer, operation, operand) {
+		if (!(buffer is Buffer)) Fiber.abort("buffer must be a Buffer.")
+		if (!(operation is String)) Fiber.abort("operation must be a string.")
+		if (!(operand is Num)) Fiber.abort("operand must be a number.")
+		map_(Fiber.current, buffer, operation, operand)
+		return Scheduler.runNextScheduled_()
+	}
+
+	foreign static hash_(fiber, data)
+	foreign static map_(fiber, buffer, operation, operand)
+}
+)";
+
+// Elements per chunk of a parallel map
+constexpr size_t MAP_GRAIN = 64 * 1024;
+
+static void jobs_threads(WrenVM* vm)
+{
+	wrenSetSlotDouble(vm, 0, double(Singleton<Scheduler>::Instance().pool().size()));
+}
+
+// 64-bit FNV-1a, as 16 hex digits
+static std::string fnv1a(const Buffer& data)
+{
+	uint64_t hash = 14695981039346656037ull;
+	const uint8_t* bytes = data.data();
+	for (size_t i = 0; i < data.size(); ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	static const char digits[] = "0123456789abcdef";
+	std::string text(16, '0');
+	for (int i = 15; i >= 0; --i, hash >>= 4)
+		text[size_t(i)] = digits[hash & 0xf];
+	return text;
+}
+
+static void jobs_hash(WrenVM* vm)
+{
+	Buffer data = get_data(vm, 2);
+	Singleton<Scheduler>::Instance().submit(vm, 1, [data]() -> Scheduler::Deliver
+	{
+		std::string hash = fnv1a(data);
+		return [hash](WrenVM* vm, int slot) { wrenSetSlotString(vm, slot, hash.c_str()); };
+	});
+}
+
+static double (*map_operation(const std::string& name))(double, double)
+{
+	if (name == "add")  return [](double x, double operand) { return x + operand; };
+	if (name == "mul")  return [](double x, double operand) { return x * operand; };
+	if (name == "pow")  return [](double x, double operand) { return std::pow(x, operand); };
+	if (name == "sqrt") return [](double x, double) { return std::sqrt(x); };
+	return nullptr;
+}
+
+// A new Buffer of doubles with operation applied to each double of buffer,
+// in chunks spread over the pool
+static void jobs_map(WrenVM* vm)
+{
+	const Buffer& source = SlotTraits<Buffer>::get(vm, 2);
+	if (source.size() % sizeof(double) != 0)
+	{
+		abort_fiber(vm, "Buffer size must be a multiple of 8.");
+		return;
+	}
+	auto operation = map_operation(wrenGetSlotString(vm, 3));
+	if (!operation)
+	{
+		abort_fiber(vm, "Unknown operation, expected add, mul, pow or sqrt.");
+		return;
+	}
+	double operand = wrenGetSlotDouble(vm, 4);
+	Scheduler& scheduler = Singleton<Scheduler>::Instance();
+	ThreadPool* pool = &scheduler.pool();
+	scheduler.submit(vm, 1, [source, operation, operand, pool]() -> Scheduler::Deliver
+	{
+		size_t count = source.size() / sizeof(double);
+		Buffer result(source.size());
+		pool->parallel_for(count, MAP_GRAIN, [&](size_t begin, size_t end)
+		{
+			for (size_t i = begin; i < end; ++i)
+			{
+				double value;
+				std::memcpy(&value, source.data() + i * sizeof(double), sizeof(double));
+				value = operation(value, operand);
+				std::memcpy(result.data() + i * sizeof(double), &value, sizeof(double));
+			}
+		});
+		return [result](WrenVM* vm, int slot) { SlotTraits<Buffer>::set(vm, slot, result); };
+	});
+}
+
+WrenForeignMethodFn bind_jobs_method(const char* class_name, bool is_static, const char* signature)
+{
+	static const ModuleMethod methods[] =
+	{
+		{ "Jobs", true, "threads", jobs_threads },
+		{ "Jobs", true, "hash_(_,_)", jobs_hash },
+		{ "Jobs", true, "map_(_,_,_,_)", jobs_map },
+	};
+	return find_module_method(methods, class_name, is_static, signature);
+}
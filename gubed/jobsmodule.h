@@ -0,0 +1,12 @@
+#pragma once
+
+#include <wren.hpp>
+
+// The built-in Wren module the Scheduler and Jobs classes are defined in
+constexpr const char* JOBS_MODULE = "jobs";
+
+// Wren code of the "jobs" module
+extern const char* jobs_module_code;
+
+// nullptr for methods the jobs module doesn't have
+WrenForeignMethodFn bind_jobs_method(const char* class_name, bool is_static, const char* signature);
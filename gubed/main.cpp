@@ -2,6 +2,7 @@
 #include "vm.h"
 #include "instrumenter.h"
 #include "cmdline.h"
+#include "outputsink.h"
 #include "ui.h"
 
 // In order to the script without debugging, use the following:
@@ -11,6 +12,16 @@ COMMAND_LINE_OPTION(di, false, "Disable instrumentation")
 	disable_instrumentation();
 }
 
+COMMAND_LINE_OPTION(fd, true, "Write script output to a file descriptor when running without debugging")
+{
+	Singleton<OutputSink>::Instance().set_fd(param.as_int());
+}
+
+COMMAND_LINE_OPTION(output, true, "Write all script output to a file, including lines scrolled out of the Output window")
+{
+	set_output_spill_file(param);
+}
+
 int main(int argc, char* argv[])
 {
 	try
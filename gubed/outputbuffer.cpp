@@ -0,0 +1,83 @@
+#include "outputbuffer.h"
+#include <algorithm>
+#include <cstring>
+
+OutputBuffer::OutputBuffer(size_t capacity)
+	: m_Capacity(capacity > 0 ? capacity : 1)
+{}
+
+OutputBuffer::~OutputBuffer()
+{
+	if (m_Spill.is_open())
+	{
+		for (size_t i = 0; i < m_Count; ++i)
+			m_Spill << m_Lines[(m_Start + i) % m_Capacity] << '\n';
+		if (!m_Pending.empty())
+			m_Spill << m_Pending << '\n';
+	}
+}
+
+bool OutputBuffer::set_spill_file(const std::string& path)
+{
+	m_Spill.open(path, std::ios::out | std::ios::trunc);
+	return m_Spill.is_open();
+}
+
+void OutputBuffer::commit_line()
+{
+	if (m_Count < m_Capacity)
+	{
+		size_t index = (m_Start + m_Count) % m_Capacity;
+		if (index == m_Lines.size())
+			m_Lines.emplace_back();
+		m_Lines[index].swap(m_Pending);
+		++m_Count;
+	}
+	else
+	{
+		// Full: the oldest slot is reused for the new line
+		std::string& oldest = m_Lines[m_Start];
+		if (m_Spill.is_open())
+			m_Spill << oldest << '\n';
+		oldest.swap(m_Pending);
+		m_Start = (m_Start + 1) % m_Capacity;
+	}
+	m_Pending.clear();
+}
+
+void OutputBuffer::write(const char* text)
+{
+	while (*text)
+	{
+		if (m_Pending.size() == MAX_LINE_LENGTH && *text != '\n')
+			commit_line();
+		// Up to the end of the line, or as much as still fits in it
+		size_t room = MAX_LINE_LENGTH - m_Pending.size();
+		size_t length = strnlen(text, room + 1);
+		const char* eol = static_cast<const char*>(std::memchr(text, '\n', length));
+		if (eol)
+		{
+			m_Pending.append(text, eol);
+			commit_line();
+			text = eol + 1;
+		}
+		else
+		{
+			length = std::min(length, room);
+			m_Pending.append(text, length);
+			text += length;
+		}
+	}
+}
+
+size_t OutputBuffer::get_line_count() const
+{
+	return m_Count + (m_Pending.empty() ? 0 : 1);
+}
+
+const std::string& OutputBuffer::get_line(size_t index) const
+{
+	if (index < m_Count)
+		return m_Lines[(m_Start + index) % m_Capacity];
+	return m_Pending;
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <conwin.h>
+
+// Script output shown in the Output window.  Writes are assembled into
+// lines, only the last `capacity` lines are kept, and older ones go to an
+// optional spill file.  Lines longer than MAX_LINE_LENGTH are wrapped, so
+// output without newlines is bounded too.
+class OutputBuffer : public ContentProvider
+{
+public:
+	static constexpr size_t MAX_LINE_LENGTH = 4096;
+private:
+	std::vector<std::string>	m_Lines;		// Ring of complete lines
+	size_t						m_Capacity;
+	size_t						m_Start = 0;	// Index of the oldest line in the ring
+	size_t						m_Count = 0;
+	std::string					m_Pending;		// Line still being written
+	std::ofstream				m_Spill;
+
+	void commit_line();
+public:
+	explicit OutputBuffer(size_t capacity);
+	~OutputBuffer();
+
+	// Lines dropped from the buffer, and whatever is left at exit, are
+	// appended to this file
+	bool						set_spill_file(const std::string& path);
+	void						write(const char* text);
+
+	virtual size_t				get_line_count() const override;
+	virtual const std::string&	get_line(size_t index) const override;
+};
@@ -0,0 +1,67 @@
+#include "outputsink.h"
+#include <cerrno>
+#include <cstring>
+#ifdef WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+OutputSink::OutputSink()
+	: m_Buffer(BUFFER_SIZE)
+{}
+
+OutputSink::~OutputSink()
+{
+	flush();
+}
+
+void OutputSink::set_fd(int fd)
+{
+	flush();
+	m_FD = fd;
+}
+
+void OutputSink::write_fd(const char* data, size_t size)
+{
+	while (size > 0)
+	{
+#ifdef WIN32
+		int n = _write(m_FD, data, unsigned(size));
+#else
+		ssize_t n = ::write(m_FD, data, size);
+#endif
+		if (n < 0)
+		{
+			if (errno == EINTR) continue;
+			return; // Nowhere to report it, drop the output
+		}
+		data += n;
+		size -= size_t(n);
+	}
+}
+
+void OutputSink::write(const char* text)
+{
+	size_t size = std::strlen(text);
+	if (m_Used + size > m_Buffer.size())
+	{
+		flush();
+		if (size > m_Buffer.size())
+		{
+			write_fd(text, size);
+			return;
+		}
+	}
+	std::memcpy(m_Buffer.data() + m_Used, text, size);
+	m_Used += size;
+}
+
+void OutputSink::flush()
+{
+	if (m_Used > 0)
+	{
+		write_fd(m_Buffer.data(), m_Used);
+		m_Used = 0;
+	}
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+#include <singleton.h>
+
+// Buffered writer for script output when running without the debugger UI.
+// Output reaches the file descriptor when the buffer fills up, on flush(),
+// and at exit.
+class OutputSink
+{
+public:
+	static constexpr size_t BUFFER_SIZE = 64 * 1024;
+private:
+	std::vector<char>	m_Buffer;
+	size_t				m_Used = 0;
+	int					m_FD = 1;
+
+	OutputSink();
+	OutputSink(const OutputSink&) = delete;
+	OutputSink& operator=(const OutputSink&) = delete;
+	friend class Singleton<OutputSink>;
+
+	void write_fd(const char* data, size_t size);
+public:
+	~OutputSink();
+
+	void set_fd(int fd);
+	void write(const char* text);
+	void flush();
+};
@@ -0,0 +1,91 @@
+#include "policy.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <json.hpp>
+#include "strutils.h"
+
+using json = nlohmann::json;
+
+static std::string load_policy_json()
+{
+	const char* env_vars[] = { "HOME", "USERPROFILE" };
+	for (const char* env_var : env_vars)
+	{
+		const char* home = std::getenv(env_var);
+		if (home)
+		{
+			std::filesystem::path policy_file = (std::filesystem::path(home) / ".gubed") / "policy.json";
+			if (std::filesystem::is_regular_file(policy_file))
+			{
+				std::ifstream f(policy_file);
+				std::ostringstream os;
+				os << f.rdbuf();
+				return os.str();
+			}
+		}
+	}
+	return "";
+}
+
+static InstrumentationMode parse_mode(const std::string& name)
+{
+	if (name == "full")     return InstrumentationMode::Full;
+	if (name == "profile")  return InstrumentationMode::Profile;
+	if (name == "coverage") return InstrumentationMode::Coverage;
+	if (name == "none")     return InstrumentationMode::None;
+	throw std::runtime_error("Unknown instrumentation mode: " + name);
+}
+
+InstrumentationPolicy::InstrumentationPolicy()
+{
+	std::string text = load_policy_json();
+	if (text.empty()) return;
+	try
+	{
+		load_json(text);
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << "Ignoring policy.json: " << e.what() << std::endl;
+		m_Rules.clear();
+		m_DefaultMode = InstrumentationMode::Full;
+	}
+}
+
+void InstrumentationPolicy::load_json(const std::string& text)
+{
+	json root = json::parse(text);
+	if (root.contains("default"))
+		m_DefaultMode = parse_mode(root.at("default").get<std::string>());
+	if (root.contains("report"))
+		m_ReportPath = root.at("report").get<std::string>();
+	m_Rules.clear();
+	if (root.contains("modules"))
+	{
+		for (const auto& rule_json : root.at("modules"))
+		{
+			if (!rule_json.contains("pattern") || !rule_json.contains("mode"))
+				throw std::runtime_error("Module rule needs 'pattern' and 'mode'");
+			m_Rules.push_back({ rule_json.at("pattern").get<std::string>(),
+								parse_mode(rule_json.at("mode").get<std::string>()) });
+		}
+	}
+}
+
+InstrumentationMode InstrumentationPolicy::get_mode(const std::string& module_name) const
+{
+	for (const auto& rule : m_Rules)
+	{
+		if (glob_match(rule.pattern, module_name))
+			return rule.mode;
+	}
+	return m_DefaultMode;
+}
+
+const std::string& InstrumentationPolicy::get_report_path() const
+{
+	return m_ReportPath;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <singleton.h>
+
+// How a loaded module is instrumented
+enum class InstrumentationMode
+{
+	Full,		// Step, breakpoints and variables on every method line
+	Profile,	// Count method entries only
+	Coverage,	// Count executed method lines, never stop
+	None		// Run the module as is
+};
+
+// Per-module instrumentation policy, read from ~/.gubed/policy.json:
+//
+// {
+//   "default": "full",
+//   "report": "gubed_counts.txt",
+//   "modules": [
+//     { "pattern": "lib/**", "mode": "none" },
+//     { "pattern": "util_*", "mode": "coverage" }
+//   ]
+// }
+//
+// The first matching pattern decides the mode of a module.
+class InstrumentationPolicy
+{
+	struct Rule
+	{
+		std::string			pattern;
+		InstrumentationMode	mode;
+	};
+
+	std::vector<Rule>		m_Rules;
+	InstrumentationMode		m_DefaultMode = InstrumentationMode::Full;
+	std::string				m_ReportPath = "gubed_counts.txt";
+
+	InstrumentationPolicy();
+	InstrumentationPolicy(const InstrumentationPolicy&) = delete;
+	InstrumentationPolicy& operator=(const InstrumentationPolicy&) = delete;
+	friend class Singleton<InstrumentationPolicy>;
+public:
+	void					load_json(const std::string& text);
+	InstrumentationMode		get_mode(const std::string& module_name) const;
+	const std::string&		get_report_path() const;
+};
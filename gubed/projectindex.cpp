@@ -0,0 +1,345 @@
+#include "projectindex.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fstream>
+// PROJECTINDEX_NO_SSE2 builds the scalar search only, which the tests compare
+// against
+#if (defined(__SSE2__) || defined(_M_X64)) && !defined(PROJECTINDEX_NO_SSE2)
+#include <emmintrin.h>
+#define PROJECTINDEX_SSE2
+#endif
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// How often the background thread looks for changed files without inotify
+static const auto rescan_interval = std::chrono::seconds(2);
+
+// Files loaded between updates while the tree is first walked
+static const size_t publish_batch = 64;
+
+// Quiet time after a change before rescanning, so that a burst of events,
+// e.g. a checkout, is handled with one rescan
+static const int settle_ms = 50;
+
+#ifdef PROJECTINDEX_SSE2
+static int lowest_bit(unsigned mask)
+{
+#ifdef _MSC_VER
+	unsigned long index;
+	_BitScanForward(&index, mask);
+	return int(index);
+#else
+	return __builtin_ctz(mask);
+#endif
+}
+#endif
+
+// First start position in [p, last] where text occurs.  Candidates are
+// positions where the bytes at offsets a and b match, tested 16 at a time.
+static const char* find_text(const char* p, const char* last, std::string_view text, size_t a, size_t b)
+{
+#ifdef PROJECTINDEX_SSE2
+	const __m128i byte_a = _mm_set1_epi8(text[a]);
+	const __m128i byte_b = _mm_set1_epi8(text[b]);
+	for (; last - p >= 15; p += 16)
+	{
+		__m128i at_a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + a));
+		__m128i at_b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + b));
+		unsigned mask = unsigned(_mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(at_a, byte_a), _mm_cmpeq_epi8(at_b, byte_b))));
+		while (mask)
+		{
+			const char* candidate = p + lowest_bit(mask);
+			if (std::memcmp(candidate, text.data(), text.size()) == 0)
+				return candidate;
+			mask &= mask - 1;
+		}
+	}
+#endif
+	for (; p <= last; ++p)
+	{
+		if (p[a] == text[a] && p[b] == text[b] && std::memcmp(p, text.data(), text.size()) == 0)
+			return p;
+	}
+	return nullptr;
+}
+
+ProjectIndex::ProjectIndex(const fs::path& root, Listener* listener)
+	: m_Root(root)
+	, m_Listener(listener)
+{
+#ifdef __linux__
+	m_Inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_Inotify >= 0 && pipe2(m_StopPipe, O_CLOEXEC) != 0)
+	{
+		close(m_Inotify);
+		m_Inotify = -1;
+	}
+#endif
+	m_Thread = std::thread([this]() { run(); });
+}
+
+ProjectIndex::~ProjectIndex()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stop = true;
+	}
+	m_Wakeup.notify_all();
+#ifdef __linux__
+	if (m_StopPipe[1] >= 0)
+	{
+		char c = 's';
+		if (write(m_StopPipe[1], &c, 1) < 0)
+		{
+			// The thread also checks m_Stop
+		}
+	}
+#endif
+	if (m_Thread.joinable())
+		m_Thread.join();
+#ifdef __linux__
+	if (m_Inotify >= 0)
+	{
+		close(m_Inotify);
+		close(m_StopPipe[0]);
+		close(m_StopPipe[1]);
+	}
+#endif
+}
+
+void ProjectIndex::run()
+{
+	do
+	{
+		rescan();
+	} while (wait_for_changes());
+}
+
+// Returns false when the index is being destroyed
+bool ProjectIndex::wait_for_changes()
+{
+#ifdef __linux__
+	if (m_Inotify >= 0)
+	{
+		struct pollfd fds[2] = {
+			{ m_Inotify, POLLIN, 0 },
+			{ m_StopPipe[0], POLLIN, 0 }
+		};
+		int timeout = -1;
+		bool changed = false;
+		while (true)
+		{
+			int n = poll(fds, 2, timeout);
+			if (n < 0 && errno != EINTR)
+				return false;
+			if (fds[1].revents & POLLIN)
+				return false;
+			if (n == 0 && changed)
+				return true;	// Settled
+			if (fds[0].revents & POLLIN)
+			{
+				// What changed doesn't matter, the rescan compares sizes and times
+				alignas(struct inotify_event) char buffer[4096];
+				while (read(m_Inotify, buffer, sizeof(buffer)) > 0)
+				{
+				}
+				changed = true;
+				timeout = settle_ms;
+			}
+		}
+	}
+#endif
+	std::unique_lock<std::mutex> lock(m_Mutex);
+	m_Wakeup.wait_for(lock, rescan_interval, [this]() { return m_Stop; });
+	return !m_Stop;
+}
+
+void ProjectIndex::watch_directory(const fs::path& path)
+{
+#ifdef __linux__
+	// Adding a watch that exists already just returns it again
+	if (m_Inotify >= 0)
+		inotify_add_watch(m_Inotify, path.c_str(), IN_CREATE | IN_DELETE | IN_CLOSE_WRITE | IN_MODIFY
+						  | IN_MOVED_FROM | IN_MOVED_TO | IN_ONLYDIR);
+#endif
+}
+
+ProjectIndex::FilePtr ProjectIndex::load(const fs::path& path, std::string module,
+										 fs::file_time_type mtime, uintmax_t size)
+{
+	auto file = std::make_shared<File>();
+	file->module = std::move(module);
+	file->mtime = mtime;
+	file->size = size;
+	std::ifstream f(path, std::ios::binary);
+	if (!f)
+		return nullptr;
+	file->text.resize(size_t(size));
+	f.read(file->text.data(), std::streamsize(size));
+	file->text.resize(size_t(f.gcount()));
+	file->line_starts.push_back(0);
+	const char* begin = file->text.data();
+	for (size_t i = 0; i < file->text.size(); ++i)
+	{
+		unsigned char c = (unsigned char)begin[i];
+		++file->byte_counts[c];
+		if (c == '\n')
+			file->line_starts.push_back(uint32_t(i + 1));
+	}
+	return file;
+}
+
+void ProjectIndex::rescan()
+{
+	std::vector<FilePtr> previous;
+	bool ready;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		previous = m_Files;
+		ready = m_Ready;
+	}
+
+	std::vector<FilePtr> files;
+	size_t loaded = 0;
+	bool changed = false;
+	std::error_code ec;
+	watch_directory(m_Root);
+	for (fs::recursive_directory_iterator it(m_Root, fs::directory_options::skip_permission_denied, ec), end;
+		 !ec && it != end; it.increment(ec))
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			if (m_Stop)
+				return;
+		}
+		const fs::directory_entry& entry = *it;
+		if (entry.is_directory(ec))
+		{
+			watch_directory(entry.path());
+			continue;
+		}
+		if (entry.path().extension() != ".wren" || !entry.is_regular_file(ec))
+			continue;
+		std::string module = fs::relative(entry.path(), m_Root, ec).replace_extension().generic_string();
+		fs::file_time_type mtime = entry.last_write_time(ec);
+		uintmax_t size = entry.file_size(ec);
+		if (ec)
+		{
+			ec.clear();
+			continue;
+		}
+
+		// Unchanged files are shared with the previous scan
+		auto same = std::lower_bound(previous.begin(), previous.end(), module,
+									 [](const FilePtr& f, const std::string& m) { return f->module < m; });
+		if (same != previous.end() && (*same)->module == module && (*same)->mtime == mtime && (*same)->size == size)
+			files.push_back(*same);
+		else if (FilePtr file = load(entry.path(), std::move(module), mtime, size))
+		{
+			files.push_back(file);
+			changed = true;
+			// The first walk shows its progress
+			if (!ready && ++loaded % publish_batch == 0)
+				publish(files, false);
+		}
+	}
+	if (changed || files.size() != previous.size() || !ready)
+		publish(std::move(files), true);
+}
+
+void ProjectIndex::publish(std::vector<FilePtr> files, bool ready)
+{
+	std::sort(files.begin(), files.end(), [](const FilePtr& a, const FilePtr& b) { return a->module < b->module; });
+	std::array<uint64_t, 256> byte_counts{};
+	for (const FilePtr& file : files)
+	{
+		for (size_t c = 0; c < byte_counts.size(); ++c)
+			byte_counts[c] += file->byte_counts[c];
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Files.swap(files);
+		m_ByteCounts = byte_counts;
+		m_Ready = m_Ready || ready;
+	}
+	if (m_Listener)
+		m_Listener->on_project_changed();
+}
+
+bool ProjectIndex::is_ready() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	return m_Ready;
+}
+
+std::vector<ProjectIndex::ModuleInfo> ProjectIndex::get_modules() const
+{
+	std::lock_guard<std::mutex> lock(m_Mutex);
+	std::vector<ModuleInfo> modules;
+	modules.reserve(m_Files.size());
+	for (const FilePtr& file : m_Files)
+		modules.push_back({ file->module, file->size, file->mtime });
+	return modules;
+}
+
+std::vector<ProjectIndex::Hit> ProjectIndex::search(std::string_view text, size_t max_hits) const
+{
+	std::vector<Hit> hits;
+	if (text.empty())
+		return hits;
+	std::vector<FilePtr> files;
+	// Candidates are filtered on the two bytes of text that are rarest in
+	// the project
+	size_t rarest = 0, second = 0;
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		files = m_Files;
+		auto count = [&](size_t i) { return m_ByteCounts[(unsigned char)text[i]]; };
+		for (size_t i = 1; i < text.size(); ++i)
+		{
+			if (count(i) < count(rarest))
+			{
+				second = rarest;
+				rarest = i;
+			}
+			else if (second == rarest || count(i) < count(second))
+				second = i;
+		}
+	}
+
+	for (const FilePtr& file : files)
+	{
+		if (file->byte_counts[(unsigned char)text[rarest]] == 0 || file->text.size() < text.size())
+			continue;
+		const char* begin = file->text.data();
+		const char* end = begin + file->text.size();
+		const char* last = end - text.size();
+		const char* p = begin;
+		while (p <= last && (p = find_text(p, last, text, rarest, second)) != nullptr)
+		{
+			size_t offset = size_t(p - begin);
+			size_t line = size_t(std::upper_bound(file->line_starts.begin(), file->line_starts.end(), uint32_t(offset))
+								 - file->line_starts.begin()) - 1;
+			const char* line_begin = begin + file->line_starts[line];
+			const char* line_end = line + 1 < file->line_starts.size() ? begin + file->line_starts[line + 1] - 1 : end;
+			if (line_end > line_begin && line_end[-1] == '\r')
+				--line_end;
+			hits.push_back({ file->module, line, std::string(line_begin, line_end) });
+			if (hits.size() >= max_hits)
+				return hits;
+			p = std::max(p + 1, line_end);	// One hit per line
+		}
+	}
+	return hits;
+}
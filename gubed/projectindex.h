@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// All modules below a directory, with their sources kept in memory for
+// searching.  A background thread walks the tree, publishing what it found
+// every few dozen files so the first results show up quickly.  It then
+// waits for inotify to report changes (or rescans every few seconds where
+// there is no inotify) and reloads only the files that were added or
+// changed.
+class ProjectIndex
+{
+public:
+	struct Hit
+	{
+		std::string		module;
+		size_t			line_index;
+		std::string		line;
+	};
+
+	struct ModuleInfo
+	{
+		std::string						module;
+		uintmax_t						size;
+		std::filesystem::file_time_type	mtime;
+	};
+
+	// Told on the background thread whenever the module list or a source changed
+	class Listener
+	{
+	public:
+		virtual ~Listener() = default;
+		virtual void on_project_changed() = 0;
+	};
+private:
+	struct File
+	{
+		std::string						module;		// Path without .wren, '/' separated
+		std::filesystem::file_time_type	mtime;
+		uintmax_t						size = 0;
+		std::string						text;
+		std::vector<uint32_t>			line_starts;
+		std::array<uint32_t, 256>		byte_counts{};
+	};
+	using FilePtr = std::shared_ptr<const File>;
+
+	std::filesystem::path		m_Root;
+	Listener*					m_Listener;
+	int							m_Inotify = -1;
+	int							m_StopPipe[2] = { -1, -1 };
+	mutable std::mutex			m_Mutex;
+	std::vector<FilePtr>		m_Files;			// Sorted by module
+	std::array<uint64_t, 256>	m_ByteCounts{};		// How often each byte occurs in all files
+	bool						m_Ready = false;	// The first scan finished
+	bool						m_Stop = false;
+	std::condition_variable		m_Wakeup;
+	std::thread					m_Thread;
+
+	void						run();
+	bool						wait_for_changes();
+	void						rescan();
+	void						watch_directory(const std::filesystem::path& path);
+	void						publish(std::vector<FilePtr> files, bool ready);
+	static FilePtr				load(const std::filesystem::path& path, std::string module,
+									 std::filesystem::file_time_type mtime, uintmax_t size);
+public:
+	explicit ProjectIndex(const std::filesystem::path& root, Listener* listener = nullptr);
+	~ProjectIndex();
+
+	// True once the first walk of the tree finished
+	bool						is_ready() const;
+	// Sorted by module
+	std::vector<ModuleInfo>		get_modules() const;
+	// Lines that contain text, at most one hit per line, in module order
+	std::vector<Hit>			search(std::string_view text, size_t max_hits) const;
+};
@@ -0,0 +1,154 @@
+#include <cstdint>
+#include <stdexcept>
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
+#endif
+#include "scheduler.h"
+
+Scheduler::Scheduler()
+{
+#ifdef __linux__
+	m_Event = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	m_Epoll = epoll_create1(EPOLL_CLOEXEC);
+	epoll_event event = {};
+	event.events = EPOLLIN;
+	event.data.fd = m_Event;
+	if (m_Event < 0 || m_Epoll < 0 || epoll_ctl(m_Epoll, EPOLL_CTL_ADD, m_Event, &event) != 0)
+		throw std::runtime_error("Failed to create the scheduler's event loop");
+#endif
+}
+
+Scheduler::~Scheduler()
+{
+	// Workers may still signal until the pool is gone
+	m_Pool.reset();
+#ifdef __linux__
+	close(m_Epoll);
+	close(m_Event);
+#endif
+}
+
+ThreadPool& Scheduler::pool()
+{
+	if (!m_Pool)
+		m_Pool = std::make_unique<ThreadPool>();
+	return *m_Pool;
+}
+
+void Scheduler::submit(WrenVM* vm, int fiber_slot, Job job)
+{
+	WrenHandle* fiber = wrenGetSlotHandle(vm, fiber_slot);
+	++m_Pending;
+	pool().submit([this, fiber, job = std::move(job)]
+	{
+		Completion completion{ fiber, nullptr, "" };
+		try
+		{
+			completion.deliver = job();
+		}
+		catch (const std::exception& e)
+		{
+			completion.error = e.what();
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Completed.push_back(std::move(completion));
+		}
+		notify();
+	});
+}
+
+void Scheduler::notify()
+{
+#ifdef __linux__
+	uint64_t one = 1;
+	// Only fails when the counter is about to overflow, which still wakes up
+	// the VM thread
+	ssize_t written = write(m_Event, &one, sizeof(one));
+	(void)written;
+#else
+	m_Done.notify_one();
+#endif
+}
+
+Scheduler::Completion Scheduler::wait()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+#ifdef __linux__
+	while (m_Completed.empty())
+	{
+		lock.unlock();
+		epoll_event event;
+		if (epoll_wait(m_Epoll, &event, 1, -1) > 0)
+		{
+			uint64_t count;
+			ssize_t n = read(m_Event, &count, sizeof(count));
+			(void)n;
+		}
+		lock.lock();
+	}
+#else
+	m_Done.wait(lock, [this] { return !m_Completed.empty(); });
+#endif
+	Completion completion = std::move(m_Completed.front());
+	m_Completed.pop_front();
+	--m_Pending;
+	return completion;
+}
+
+void Scheduler::resume(WrenVM* vm, Completion& completion)
+{
+	wrenEnsureSlots(vm, 2);
+	wrenSetSlotHandle(vm, 0, completion.fiber);
+	// Slot 0 keeps the fiber alive from here on
+	wrenReleaseHandle(vm, completion.fiber);
+	if (completion.error.empty())
+	{
+		try
+		{
+			completion.deliver(vm, 1);
+		}
+		catch (const std::exception& e)
+		{
+			completion.error = e.what();
+		}
+	}
+	if (!completion.error.empty())
+		wrenSetSlotString(vm, 1, completion.error.c_str());
+	WrenInterpretResult result = wrenCall(vm, completion.error.empty() ? m_Transfer : m_TransferError);
+	if (result != WREN_RESULT_SUCCESS)
+		throw std::runtime_error("Runtime error in a fiber resumed by the scheduler");
+}
+
+void Scheduler::run(WrenVM* vm)
+{
+	if (m_Pending == 0)
+		return;
+	if (!m_Transfer)
+	{
+		m_Transfer = wrenMakeCallHandle(vm, "transfer(_)");
+		m_TransferError = wrenMakeCallHandle(vm, "transferError(_)");
+	}
+	while (m_Pending > 0)
+	{
+		Completion completion = wait();
+		resume(vm, completion);
+	}
+}
+
+void Scheduler::shutdown(WrenVM* vm)
+{
+	m_Pool.reset();
+	for (auto& completion : m_Completed)
+		wrenReleaseHandle(vm, completion.fiber);
+	m_Completed.clear();
+	m_Pending = 0;
+	if (m_Transfer)
+	{
+		wrenReleaseHandle(vm, m_Transfer);
+		wrenReleaseHandle(vm, m_TransferError);
+		m_Transfer = m_TransferError = nullptr;
+	}
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <singleton.h>
+#include <threadpool.h>
+#include <wren.hpp>
+
+// Runs native jobs for Wren fibers on a ThreadPool.  The fiber that submits
+// a job suspends, and run() resumes it on the VM thread with the job's
+// result once the job is done.  On Linux, workers signal completions on an
+// eventfd the VM thread waits for with epoll, so descriptors that can be
+// polled may share the same wait.
+class Scheduler
+{
+public:
+	// Puts a job's result in the given slot; called on the VM thread
+	using Deliver = std::function<void(WrenVM* vm, int slot)>;
+	// Runs on a worker thread.  A thrown exception becomes a runtime error
+	// of the waiting fiber.
+	using Job = std::function<Deliver()>;
+
+private:
+	struct Completion
+	{
+		WrenHandle*	fiber;
+		Deliver		deliver;
+		std::string	error;
+	};
+
+	std::unique_ptr<ThreadPool>	m_Pool;
+	std::mutex					m_Mutex;
+	std::condition_variable		m_Done;
+	std::deque<Completion>		m_Completed;
+	size_t						m_Pending = 0;
+	WrenHandle*					m_Transfer = nullptr;
+	WrenHandle*					m_TransferError = nullptr;
+#ifdef __linux__
+	int							m_Epoll = -1;
+	int							m_Event = -1;
+#endif
+
+	Scheduler();
+	Scheduler(const Scheduler&) = delete;
+	Scheduler& operator=(const Scheduler&) = delete;
+	friend class Singleton<Scheduler>;
+
+	void notify();
+	Completion wait();
+	void resume(WrenVM* vm, Completion& completion);
+public:
+	~Scheduler();
+
+	// Started on first use, so scripts without jobs run no extra threads
+	ThreadPool& pool();
+
+	// Runs job for the fiber in fiber_slot, which must then suspend
+	void submit(WrenVM* vm, int fiber_slot, Job job);
+	// Resumes fibers as their jobs complete, until none is waiting
+	void run(WrenVM* vm);
+	// Finishes the queued jobs and releases the fibers still waiting; called
+	// before the VM is freed
+	void shutdown(WrenVM* vm);
+};
@@ -1,19 +1,47 @@
 #include "ui.h"
+#include <cstdio>
+#include <ctime>
 #include <fstream>
 #include <filesystem>
 #include <regex>
+#include <thread>
 #include <conwin.h>
 #include <json.hpp>
+#include "instrumenter.h"
+#include "outputbuffer.h"
+#include "outputsink.h"
+#include "projectindex.h"
+#include "strutils.h"
+#include "wrenstyler.h"
 
 using json = nlohmann::json;
 using RectMap = std::map<std::string, Rect>;
 
+std::atomic<bool> g_PauseRequested{ false };
+
 static bool g_UIActive = true;
 void disable_ui()
 {
 	g_UIActive = false;
 }
 
+static std::string g_OutputSpillPath;
+void set_output_spill_file(const std::string& path)
+{
+	g_OutputSpillPath = path;
+}
+
+// Lines kept in the Output window
+const size_t output_capacity = 10000;
+
+// Project search results shown at most
+const size_t max_search_hits = 1000;
+
+// Module names are padded to this width in the Project window
+const size_t project_name_width = 24;
+
+static const char* const status_line = "F3 Find | F4 Find in Project | F5 Continue | F6 Next Pane | F8 Pause | F9 Breakpoint | F10 Step | Esc Quit";
+
 
 static std::vector<xstring> load_file(const std::string& filename)
 {
@@ -28,6 +56,30 @@ static std::vector<xstring> load_file(const std::string& filename)
 	return res;
 }
 
+static std::string format_size(uintmax_t size)
+{
+	char text[32];
+	if (size < 10 * 1024)
+		snprintf(text, sizeof(text), "%6uB", unsigned(size));
+	else if (size < 10 * 1024 * 1024)
+		snprintf(text, sizeof(text), "%6uK", unsigned(size / 1024));
+	else
+		snprintf(text, sizeof(text), "%6uM", unsigned(size / (1024 * 1024)));
+	return text;
+}
+
+static std::string format_time(std::filesystem::file_time_type mtime)
+{
+	// file_time_type has no portable conversion before C++20
+	auto system_time = std::chrono::time_point_cast<std::chrono::system_clock::duration>(
+		mtime - std::filesystem::file_time_type::clock::now() + std::chrono::system_clock::now());
+	std::time_t t = std::chrono::system_clock::to_time_t(system_time);
+	char text[32];
+	if (std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M", std::localtime(&t)) == 0)
+		return "";
+	return text;
+}
+
 static xstring unite_lines(const std::vector<xstring>& lines)
 {
 	xstring code;
@@ -174,12 +226,31 @@ static void compute_layout(const Node& n, const Rect& r,
 }
 
 
-class UserInterface : public IUserInterface
+// Shows a module's source straight from the instrumenter's store
+class ModuleContent : public ContentProvider
+{
+	std::shared_ptr<IModule>	m_Module;
+public:
+	ModuleContent(const std::shared_ptr<IModule>& module)
+		: m_Module(module)
+	{}
+
+	virtual size_t get_line_count() const override
+	{
+		return m_Module->get_line_count();
+	}
+
+	virtual const std::string& get_line(size_t index) const override
+	{
+		return m_Module->get_line(index);
+	}
+};
+
+class UserInterface : public IUserInterface, public ResizeListener, public ProjectIndex::Listener
 {
 	std::unordered_map<xstring, std::set<int>>		m_Breakpoints;
 	xstring											m_CurrentModule;
 	enum ActivePane { CODE, VARS }					m_ActivePane = CODE;
-	std::vector<xstring>							m_CurrentCode;
 	std::vector<xstring>							m_CurrentVars;
 	Desktop											m_Desktop;
 	size_t											m_ActiveWindowIndex = 0;
@@ -187,6 +258,26 @@ class UserInterface : public IUserInterface
 	WindowPtr										m_VarsWindow;
 	WindowPtr										m_OutputWindow;
 	WindowPtr										m_ProjectWindow;
+	std::shared_ptr<OutputBuffer>					m_Output;
+	bool											m_OutputChanged = false;
+	std::thread										m_InputWatcher;
+	std::atomic<bool>								m_WatchInput{ false };
+	struct ModuleView
+	{
+		ContentProviderPtr	content;
+		LineStylerPtr		styler;
+	};
+	std::unordered_map<xstring, ModuleView>			m_ModuleViews;
+	std::vector<xstring>							m_ProjectLines;		// The module tree
+	std::vector<std::string>						m_ProjectModules;	// Module on each tree line, empty for directories
+	std::atomic<bool>								m_ProjectChanged{ false };
+	std::unique_ptr<ProjectIndex>					m_Index;
+	enum class Prompt { None, FindInFile, FindInProject }	m_Prompt = Prompt::None;
+	std::string										m_Query;			// Kept for the next search
+	std::vector<ProjectIndex::Hit>					m_SearchHits;		// Listed in the Project window when not empty
+	Node											m_Layout;			// Parsed once, laid out again on resize
+	RectMap											m_LayoutRects;
+	std::map<std::string, WindowPtr>				m_LayoutWindows;
 
 	WindowPtr get_active_window()
 	{
@@ -206,24 +297,31 @@ class UserInterface : public IUserInterface
 		}
 	}
 
-	std::vector<xstring> load_module_list()
+	// While the script runs, keys are read on a background thread so that
+	// F8 can break into it.  The UI thread does not touch the console until
+	// the watcher is stopped again.
+	void start_input_watcher()
 	{
-		std::vector<xstring> modules;
-		try {
-			for (const auto& entry : std::filesystem::directory_iterator(std::filesystem::current_path())) {
-				if (entry.is_regular_file()) {
-					std::filesystem::path path = entry.path();
-					if (path.extension() == ".wren") {
-						// Convert stem to string and add to modules list
-						modules.emplace_back(path.stem().string());
-					}
-				}
+		stop_input_watcher();
+		m_WatchInput = true;
+		m_InputWatcher = std::thread([this]()
+		{
+			while (m_WatchInput)
+			{
+				if (m_Desktop.get_key() == Key::F8)
+					g_PauseRequested.store(true, std::memory_order_relaxed);
 			}
-		} catch (const std::filesystem::filesystem_error& e) {
-			// Handle potential errors silently, just return empty list
-		}
+		});
+	}
 
-		return modules;
+	void stop_input_watcher()
+	{
+		m_WatchInput = false;
+		if (m_InputWatcher.joinable())
+		{
+			m_Desktop.wake();
+			m_InputWatcher.join();
+		}
 	}
 
 	std::string load_layout_json()
@@ -267,39 +365,107 @@ class UserInterface : public IUserInterface
 		return default_layout;
 	}
 
-	void load_layout(const Rect& desktop_rect, RectMap& window_rects)
+	void load_layout()
 	{
 		std::string loaded_layout = load_layout_json();
 		json root_node_json;
 		std::istringstream is(loaded_layout);
 		is >> root_node_json;
-		Node root_node = parse_node(root_node_json);
-		resolve_percentages(root_node);
-		compute_layout(root_node, desktop_rect, window_rects);
+		m_Layout = parse_node(root_node_json);
+		resolve_percentages(m_Layout);
 	}
 public:
 	UserInterface()
 	{
-		RectMap layout_rects;
-		load_layout(m_Desktop.get_rect(), layout_rects);
-		std::map<std::string, WindowPtr> windows_map;
-		for (const auto& [name, rect] : layout_rects)
+		load_layout();
+		compute_layout(m_Layout, m_Desktop.get_rect(), m_LayoutRects);
+		for (const auto& [name, rect] : m_LayoutRects)
 		{
 			auto window = std::make_shared<Window>(rect);
 			window->set_title(name);
-			windows_map[name] = window;
+			m_LayoutWindows[name] = window;
 			m_Desktop.add_window(window);
 		}
-		m_CodeWindow = windows_map["Code"];
-		m_VarsWindow = windows_map["Vars"];
-		m_OutputWindow = windows_map["Output"];
-		m_ProjectWindow = windows_map["Project"];
-		m_ProjectWindow->set_content(load_module_list());
-		m_Desktop.set_status_line("F5 Continue | F6 Next Pane | F9 Breakpoint | F10 Step | Esc Quit");
+		m_CodeWindow = m_LayoutWindows["Code"];
+		m_VarsWindow = m_LayoutWindows["Vars"];
+		m_OutputWindow = m_LayoutWindows["Output"];
+		m_ProjectWindow = m_LayoutWindows["Project"];
+		m_Desktop.set_resize_listener(this);
+		m_Output = std::make_shared<OutputBuffer>(output_capacity);
+		if (!g_OutputSpillPath.empty() && !m_Output->set_spill_file(g_OutputSpillPath))
+			throw std::runtime_error("Failed to open output file: " + g_OutputSpillPath);
+		if (m_OutputWindow)
+			m_OutputWindow->set_content_provider(m_Output);
+		if (m_ProjectWindow)
+			m_ProjectWindow->set_title("Project (scanning)");
+		m_Index = std::make_unique<ProjectIndex>(std::filesystem::current_path(), this);
+		m_Desktop.set_status_line(status_line);
 	}
 
 	~UserInterface()
 	{
+		stop_input_watcher();
+	}
+
+	// Called on the index thread.  The tree is rebuilt on the UI thread,
+	// which get_key() returns to.
+	virtual void on_project_changed() override
+	{
+		m_ProjectChanged = true;
+		m_Desktop.wake();
+	}
+
+	void refresh_project_window()
+	{
+		if (!m_ProjectWindow)
+			return;
+		m_ProjectLines.clear();
+		m_ProjectModules.clear();
+		std::vector<std::string> open_dirs;
+		for (const auto& info : m_Index->get_modules())
+		{
+			std::vector<xstring> parts = tokenize(info.module, "/", false);
+			if (parts.empty())
+				continue;
+			// Directory lines for the part of the path not shown above
+			size_t depth = 0;
+			while (depth + 1 < parts.size() && depth < open_dirs.size() && open_dirs[depth] == parts[depth])
+				++depth;
+			open_dirs.resize(depth);
+			for (; depth + 1 < parts.size(); ++depth)
+			{
+				m_ProjectLines.push_back(std::string(depth * 2, ' ') + parts[depth] + "/");
+				m_ProjectModules.emplace_back();
+				open_dirs.push_back(parts[depth]);
+			}
+			std::string name = std::string(depth * 2, ' ') + parts.back();
+			if (name.size() < project_name_width)
+				name.resize(project_name_width, ' ');
+			m_ProjectLines.push_back(name + " " + format_size(info.size) + "  " + format_time(info.mtime));
+			m_ProjectModules.push_back(info.module);
+		}
+		if (m_SearchHits.empty())
+		{
+			m_ProjectWindow->set_content(m_ProjectLines);
+			m_ProjectWindow->set_title(m_Index->is_ready() ? "Project" : "Project (scanning)");
+		}
+	}
+
+	virtual void on_resize(const Rect& desktop_rect) override
+	{
+		// The map keeps its nodes, so laying out again doesn't allocate
+		compute_layout(m_Layout, desktop_rect, m_LayoutRects);
+		for (const auto& [name, rect] : m_LayoutRects)
+		{
+			auto it = m_LayoutWindows.find(name);
+			if (it != m_LayoutWindows.end() && it->second)
+			{
+				it->second->set_rect(rect);
+				it->second->ensure_visible(it->second->get_highlight_line());
+			}
+		}
+		if (m_OutputWindow)
+			m_OutputWindow->ensure_visible(int(m_OutputWindow->get_line_count()) - 1);
 	}
 
 	virtual void load_module(const xstring& module_name) override
@@ -307,10 +473,27 @@ public:
 		if (module_name != m_CurrentModule)
 		{
 			m_CurrentModule = module_name;
-			m_CurrentCode = load_file(module_name+".wren");
 			if (m_CodeWindow)
 			{
-				m_CodeWindow->set_content(m_CurrentCode);
+				auto module = find_module(module_name);
+				if (module)
+				{
+					// Stylers are kept per module, so coming back to one
+					// doesn't tokenize it again
+					auto& view = m_ModuleViews[module_name];
+					if (!view.content)
+					{
+						view.content = std::make_shared<ModuleContent>(module);
+						view.styler = std::make_shared<WrenStyler>(view.content);
+					}
+					m_CodeWindow->set_content_provider(view.content);
+					m_CodeWindow->set_line_styler(view.styler);
+				}
+				else
+				{
+					// Not imported yet, show it from disk
+					m_CodeWindow->set_content(load_file(module_name + ".wren"));
+				}
 				m_CodeWindow->set_title(module_name);
 			}
 		}
@@ -370,11 +553,19 @@ public:
 
 	virtual void print(const char* text) override
 	{
-		if (m_OutputWindow)
+		// The window catches up once, when the script stops
+		m_Output->write(text);
+		m_OutputChanged = true;
+	}
+
+	void update_output_window()
+	{
+		if (m_OutputChanged && m_OutputWindow)
 		{
-			m_OutputWindow->append_content(text);
-			m_OutputWindow->ensure_visible(m_OutputWindow->get_content().size() - 1);
+			m_OutputWindow->content_changed();
+			m_OutputWindow->ensure_visible(int(m_OutputWindow->get_line_count()) - 1);
 		}
+		m_OutputChanged = false;
 	}
 
 	void toggle_breakpoint()
@@ -401,14 +592,131 @@ public:
 		set_colors();
 	}
 
+	void open_prompt(Prompt prompt)
+	{
+		m_Prompt = prompt;
+		update_prompt();
+	}
+
+	void update_prompt()
+	{
+		const char* label = m_Prompt == Prompt::FindInFile ? "Find: " : "Find in project: ";
+		m_Desktop.set_status_line(label + m_Query + "_");
+	}
+
+	void close_prompt()
+	{
+		m_Prompt = Prompt::None;
+		m_Desktop.set_status_line(status_line);
+	}
+
+	void prompt_key(Key key)
+	{
+		switch (key)
+		{
+			case Key::Character: m_Query += m_Desktop.get_typed_character(); update_prompt(); break;
+			case Key::Backspace: if (!m_Query.empty()) m_Query.pop_back(); update_prompt(); break;
+			case Key::Escape: close_prompt(); break;
+			case Key::Enter:
+			{
+				Prompt prompt = m_Prompt;
+				close_prompt();
+				if (prompt == Prompt::FindInFile)
+					find_in_file();
+				else
+					find_in_project();
+			} break;
+			default: break;
+		}
+	}
+
+	// Moves the Code window to the next line containing the query, wrapping
+	// around at the end of the module
+	void find_in_file()
+	{
+		if (!m_CodeWindow || m_Query.empty())
+			return;
+		const size_t count = m_CodeWindow->get_line_count();
+		const size_t start = size_t(m_CodeWindow->get_highlight_line() + 1);
+		for (size_t i = 0; i < count; ++i)
+		{
+			size_t line = (start + i) % count;
+			if (m_CodeWindow->get_line(line).find(m_Query) != std::string_view::npos)
+			{
+				m_CodeWindow->set_status_line("");
+				m_CodeWindow->set_highlight_line(int(line));
+				set_active_window(m_CodeWindow);
+				return;
+			}
+		}
+		m_CodeWindow->set_status_line("Not found: " + m_Query);
+	}
+
+	// Lists the lines containing the query in the Project window.  An empty
+	// query brings the module list back.
+	void find_in_project()
+	{
+		if (!m_ProjectWindow)
+			return;
+		if (m_Query.empty())
+		{
+			m_SearchHits.clear();
+			refresh_project_window();
+			return;
+		}
+		m_SearchHits = m_Index->search(m_Query, max_search_hits);
+		std::vector<xstring> lines;
+		lines.reserve(m_SearchHits.size());
+		for (const auto& hit : m_SearchHits)
+			lines.push_back(hit.module + ":" + std::to_string(hit.line_index + 1) + ": " + trim(hit.line));
+		m_ProjectWindow->set_content(lines);
+		m_ProjectWindow->set_title(m_Query + " (" + std::to_string(m_SearchHits.size())
+								   + (m_Index->is_ready() ? ")" : ", indexing)"));
+		m_ProjectWindow->set_highlight_line(0);
+		set_active_window(m_ProjectWindow);
+	}
+
+	void open_project_entry()
+	{
+		int index = m_ProjectWindow->get_highlight_line();
+		if (!m_SearchHits.empty())
+		{
+			if (index < 0 || size_t(index) >= m_SearchHits.size())
+				return;
+			const auto& hit = m_SearchHits[index];
+			load_module(hit.module);
+			m_CodeWindow->set_highlight_line(int(hit.line_index));
+		}
+		else
+		{
+			std::string selected_module = size_t(index) < m_ProjectModules.size() ? m_ProjectModules[index] : "";
+			if (selected_module.empty())
+				return;		// A directory
+			load_module(selected_module);
+			m_CodeWindow->set_highlight_line(0);
+		}
+		set_colors();
+		set_active_window(m_CodeWindow);
+	}
+
 	Action ui_loop() override
 	{
+		stop_input_watcher();
+		g_PauseRequested.store(false, std::memory_order_relaxed);
+		update_output_window();
 		Action res = NONE;
 		while (res==NONE)
 		{
+			if (m_ProjectChanged.exchange(false))
+				refresh_project_window();
 			auto current_window = get_active_window();
 			m_Desktop.draw(current_window);
 			Key key = m_Desktop.get_key();
+			if (m_Prompt != Prompt::None)
+			{
+				prompt_key(key);
+				continue;
+			}
 			switch (key)
 			{
 				case Key::F10: res = STEP; break;
@@ -417,24 +725,19 @@ public:
 				case Key::Up: current_window->change_highlight_line(-1); break;
 				case Key::Down: current_window->change_highlight_line(1); break;
 				case Key::F9: toggle_breakpoint(); break;
+				case Key::F3: open_prompt(Prompt::FindInFile); break;
+				case Key::F4: open_prompt(Prompt::FindInProject); break;
 				case Key::Enter:
 				{
 					if (current_window == m_ProjectWindow)
-					{
-						xstring selected_module = current_window->get_highlight_line() < m_ProjectWindow->get_content().size()
-							? m_ProjectWindow->get_content()[current_window->get_highlight_line()] : "";
-						if (!selected_module.empty())
-						{
-							load_module(selected_module);
-							m_CodeWindow->set_highlight_line(0);
-							set_colors();
-							set_active_window(m_CodeWindow);
-						}
-					}
+						open_project_entry();
 				} break;
 				case Key::Escape: res = QUIT; m_Desktop.clear(); break;
+				default: break;
 			}
 		}
+		if (res == CONTINUE)
+			start_input_watcher();
 		return res;
 	}
 
@@ -444,4 +747,29 @@ public:
 std::shared_ptr<IUserInterface> IUserInterface::Create()
 {
 	return std::make_shared<UserInterface>();
-}
\ No newline at end of file
+}
+
+
+class HeadlessUserInterface : public IUserInterface
+{
+public:
+	void load_module(const xstring& /*module_name*/) override {}
+	void highlight_line(size_t /*line_index*/) override {}
+	void set_variables(const std::string& /*variables*/) override {}
+	bool is_breakpoint(const xstring& /*module_name*/, size_t /*line_index*/) override { return false; }
+
+	void print(const char* text) override
+	{
+		Singleton<OutputSink>::Instance().write(text);
+	}
+
+	Action ui_loop() override
+	{
+		return CONTINUE;
+	}
+};
+
+std::shared_ptr<IUserInterface> IUserInterface::CreateHeadless()
+{
+	return std::make_shared<HeadlessUserInterface>();
+}
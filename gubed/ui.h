@@ -1,10 +1,17 @@
 #pragma once
 
+#include <atomic>
 #include <unordered_map>
 #include <set>
 #include <memory>
 #include "xstring.h"
 
+// Set by the input watcher when the user asks to break into a running script
+extern std::atomic<bool> g_PauseRequested;
+
+// Output scrolled out of the Output window is written to this file
+void set_output_spill_file(const std::string& path);
+
 
 class IUserInterface
 {
@@ -28,5 +35,7 @@ public:
 	virtual Action ui_loop() = 0;
 
 	static std::shared_ptr<IUserInterface> Create();
+	// No windows and no terminal: output goes straight to the output sink
+	static std::shared_ptr<IUserInterface> CreateHeadless();
 };
 
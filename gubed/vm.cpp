@@ -1,10 +1,20 @@
 #include <iostream>
+#include <fstream>
 #include <string>
 #include <sstream>
+#include <cstring>
+#include <buffer.h>
 #include "vm.h"
+#include "buffermodule.h"
 #include "foreigns.h"
 #include "instrumenter.h"
+#include "iomodule.h"
+#include "jobsmodule.h"
 #include "linemapper.h"
+#include "counters.h"
+#include "policy.h"
+#include "scheduler.h"
+#include "outputsink.h"
 #include "ui.h"
 
 class QuitException : public std::exception {};
@@ -14,10 +24,17 @@ std::shared_ptr<IUserInterface> UI;
 const char* debugger_class_code = R"(
 class Gubedder {
 	foreign static callback(line_id, var_data)
+	foreign static hit(line_id)
+}
+
+class Stdout {
+	foreign static flush()
 }
 )";
 
 const std::string callback_key = "gubed.Gubedder.callback(_,_)";
+const std::string hit_key = "gubed.Gubedder.hit(_)";
+const std::string flush_key = "gubed.Stdout.flush()";
 
 IUserInterface::Action action = IUserInterface::STEP;
 
@@ -39,7 +56,8 @@ extern "C" {
 			size_t line_index = details.line_index;
 			if (action == IUserInterface::CONTINUE)
 			{
-				if (!UI->is_breakpoint(module->get_name(), line_index))
+				if (!g_PauseRequested.load(std::memory_order_relaxed) &&
+					!UI->is_breakpoint(module->get_name(), line_index))
 					return;
 			}
 			if (line_index < module->get_line_count())
@@ -56,6 +74,16 @@ extern "C" {
 		}
 	}
 
+	static void HitCallback(WrenVM* vm)
+	{
+		Singleton<ExecutionCounters>::Instance().hit(LineId(wrenGetSlotDouble(vm, 1)));
+	}
+
+	static void FlushOutput(WrenVM* vm)
+	{
+		Singleton<OutputSink>::Instance().flush();
+	}
+
 	static WrenForeignMethodFn bind_foreign_method(
 		WrenVM* vm,
 		const char* module_name,
@@ -63,29 +91,61 @@ extern "C" {
 		bool isStatic,
 		const char* signature)
 	{
-		if (!isStatic) return nullptr;
-		std::ostringstream os;
-		os << module_name << "." << className << "." << signature;
-		std::string key = os.str();
+		if (std::strcmp(module_name, BUFFER_MODULE) == 0)
+		{
+			return bind_buffer_method(className, isStatic, signature);
+		}
+		if (std::strcmp(module_name, JOBS_MODULE) == 0)
+		{
+			return bind_jobs_method(className, isStatic, signature);
+		}
+		if (std::strcmp(module_name, IO_MODULE) == 0)
+		{
+			return bind_io_method(className, isStatic, signature);
+		}
+		// Reused, so binding doesn't allocate once the buffer has grown.
+		// Instance methods are "module.Class#signature"
+		static std::string key;
+		key.assign(module_name).append(".").append(className).append(isStatic ? "." : "#").append(signature);
 		if (key == callback_key)
 		{
 			return DebugCallback;
 		}
+		if (key == hit_key)
+		{
+			return HitCallback;
+		}
+		if (key == flush_key)
+		{
+			return FlushOutput;
+		}
 		return (WrenForeignMethodFn)find_foreign_method(key);
 	}
 
-	static void system_print(WrenVM* vm, const char* text)
+	static WrenForeignClassMethods bind_foreign_class(
+		WrenVM* vm,
+		const char* module_name,
+		const char* className)
 	{
-		if (!is_instrumentation_enabled())
+		if (std::strcmp(module_name, BUFFER_MODULE) == 0)
 		{
-			std::cout << text << std::endl;
+			return bind_buffer_class(className);
 		}
-		else
+		if (std::strcmp(module_name, IO_MODULE) == 0)
 		{
-			if (UI)
-			{
-				UI->print(text);
-			}
+			return bind_io_class(className);
+		}
+		WrenForeignClassMethods methods = { nullptr, nullptr };
+		std::string key = std::string(module_name) + "." + className;
+		find_foreign_class(key, methods);
+		return methods;
+	}
+
+	static void system_print(WrenVM* vm, const char* text)
+	{
+		if (UI)
+		{
+			UI->print(text);
 		}
 	}
 
@@ -98,6 +158,8 @@ extern "C" {
 							 const char* message)
 	{
 		if (!module) module = "Unknown";
+		// Keep script output ahead of the error
+		Singleton<OutputSink>::Instance().flush();
 		LineDetails	details;
 		if (Singleton<LineMapper>::Instance().search_line_details(module, line, details))
 		{
@@ -174,17 +236,32 @@ VMWrapper::VMWrapper()
 {
 	if (!UI)
 	{
-		UI = IUserInterface::Create();
+		// Plain runs never touch the terminal, so they also work without a TTY
+		UI = is_instrumentation_enabled() ? IUserInterface::Create() : IUserInterface::CreateHeadless();
 	}
 	WrenConfiguration config;
 	wrenInitConfiguration(&config);
 	config.reallocateFn = malloc_wren_realloc;
 	config.loadModuleFn = load_module;
 	config.bindForeignMethodFn = bind_foreign_method;
+	config.bindForeignClassFn = bind_foreign_class;
 	config.writeFn = system_print;
 	config.errorFn = report_error;
 	{
 		vm = wrenNewVM(&config);
+		// Before the plugins, whose module code may import it
+		if (wrenInterpret(vm, BUFFER_MODULE, buffer_module_code) != WREN_RESULT_SUCCESS)
+		{
+			throw std::runtime_error("Failed to load the buffer module");
+		}
+		if (wrenInterpret(vm, JOBS_MODULE, jobs_module_code) != WREN_RESULT_SUCCESS)
+		{
+			throw std::runtime_error("Failed to load the jobs module");
+		}
+		if (wrenInterpret(vm, IO_MODULE, io_module_code) != WREN_RESULT_SUCCESS)
+		{
+			throw std::runtime_error("Failed to load the io module");
+		}
 		initialize_foreign_modules(".", vm);
 
 		WrenInterpretResult result = wrenInterpret(vm, "gubed", debugger_class_code);
@@ -198,8 +275,20 @@ VMWrapper::VMWrapper()
 VMWrapper::~VMWrapper()
 {
 	if (vm)
+	{
+		Singleton<Scheduler>::Instance().shutdown(vm);
 		wrenFreeVM(vm);
+	}
+	Singleton<OutputSink>::Instance().flush();
 	shutdown_foreign_modules();
+	// Stops the input watcher before the console is torn down
+	UI.reset();
+	const ExecutionCounters& counters = Singleton<ExecutionCounters>::Instance();
+	if (!counters.empty())
+	{
+		std::ofstream f(Singleton<InstrumentationPolicy>::Instance().get_report_path());
+		counters.write_report(f);
+	}
 }
 
 void VMWrapper::run_module(const std::string& module_name)
@@ -215,6 +304,8 @@ void VMWrapper::run_module(const std::string& module_name)
 		{
 			throw std::runtime_error("Failed to interpret module: " + module_name);
 		}
+		// Fibers waiting for jobs, the main one included, finish here
+		Singleton<Scheduler>::Instance().run(vm);
 	}
 	catch (const QuitException&)
 	{
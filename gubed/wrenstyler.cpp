@@ -0,0 +1,234 @@
+#include "wrenstyler.h"
+#include <algorithm>
+#include <cctype>
+
+static const Color keyword_color = Color::Cyan;
+static const Color string_color = Color::Yellow;
+static const Color number_color = Color::Magenta;
+static const Color comment_color = Color::Green;
+
+// Sorted for binary search
+static const std::string_view keywords[] = {
+	"as", "break", "class", "construct", "continue", "else", "false", "for",
+	"foreign", "if", "import", "in", "is", "null", "return", "static",
+	"super", "this", "true", "var", "while"
+};
+
+static bool is_identifier_char(char c)
+{
+	return std::isalnum((unsigned char)c) || c == '_';
+}
+
+WrenStyler::WrenStyler(const ContentProviderPtr& content)
+	: m_Content(content)
+{}
+
+WrenStyler::State WrenStyler::scan(std::string_view text, State state, std::vector<StyleRun>* runs)
+{
+	const size_t n = text.size();
+	size_t i = 0;
+	auto next_is = [&](char c) { return i + 1 < n && text[i + 1] == c; };
+	auto emit = [&](size_t start, size_t end, Color color)
+	{
+		if (runs && end > start && start < not_styled)
+			runs->push_back({ uint16_t(start), uint16_t(std::min<size_t>(end - start, not_styled - start)), color });
+	};
+	auto skip_comment = [&]()
+	{
+		while (i < n)
+		{
+			if (text[i] == '/' && next_is('*'))
+			{
+				++state.comment_depth;
+				i += 2;
+			}
+			else if (text[i] == '*' && next_is('/'))
+			{
+				i += 2;
+				if (--state.comment_depth == 0)
+				{
+					state.mode = Mode::Code;
+					return;
+				}
+			}
+			else
+				++i;
+		}
+	};
+	auto skip_string = [&]()
+	{
+		while (i < n)
+		{
+			char c = text[i];
+			if (c == '\\')
+				i += 2;
+			else if (c == '"')
+			{
+				++i;
+				state.mode = Mode::Code;
+				return;
+			}
+			else if (c == '%' && next_is('('))
+			{
+				// Interpolation, which may hold strings of its own
+				i += 2;
+				int parens = 1;
+				while (i < n && parens > 0)
+				{
+					if (text[i] == '"')
+					{
+						for (++i; i < n && text[i] != '"'; ++i)
+						{
+							if (text[i] == '\\') ++i;
+						}
+					}
+					else if (text[i] == '(')
+						++parens;
+					else if (text[i] == ')')
+						--parens;
+					++i;
+				}
+			}
+			else
+				++i;
+		}
+		i = std::min(i, n);
+	};
+	auto skip_raw_string = [&]()
+	{
+		size_t end = text.find("\"\"\"", i);
+		if (end == std::string_view::npos)
+			i = n;
+		else
+		{
+			i = end + 3;
+			state.mode = Mode::Code;
+		}
+	};
+
+	// Whatever the previous line left open
+	switch (state.mode)
+	{
+		case Mode::Comment:		skip_comment(); emit(0, i, comment_color); break;
+		case Mode::String:		skip_string(); emit(0, i, string_color); break;
+		case Mode::RawString:	skip_raw_string(); emit(0, i, string_color); break;
+		case Mode::Code:		break;
+	}
+
+	while (i < n)
+	{
+		if (!runs)
+		{
+			// Only after the state: just comments and strings can change it
+			i = text.find_first_of("/\"", i);
+			if (i == std::string_view::npos)
+				break;
+		}
+		const size_t start = i;
+		const char c = text[i];
+		if (c == '/' && next_is('/'))
+		{
+			emit(start, n, comment_color);
+			break;
+		}
+		if (c == '/' && next_is('*'))
+		{
+			state.mode = Mode::Comment;
+			skip_comment();
+			emit(start, i, comment_color);
+		}
+		else if (c == '"')
+		{
+			if (text.substr(i, 3) == "\"\"\"")
+			{
+				i += 3;
+				state.mode = Mode::RawString;
+				skip_raw_string();
+			}
+			else
+			{
+				++i;
+				state.mode = Mode::String;
+				skip_string();
+			}
+			emit(start, i, string_color);
+		}
+		else if (std::isdigit((unsigned char)c))
+		{
+			if (c == '0' && (next_is('x') || next_is('X')))
+			{
+				i += 2;
+				while (i < n && std::isxdigit((unsigned char)text[i])) ++i;
+			}
+			else
+			{
+				while (i < n && std::isdigit((unsigned char)text[i])) ++i;
+				if (i + 1 < n && text[i] == '.' && std::isdigit((unsigned char)text[i + 1]))
+				{
+					++i;
+					while (i < n && std::isdigit((unsigned char)text[i])) ++i;
+				}
+				if (i < n && (text[i] == 'e' || text[i] == 'E'))
+				{
+					++i;
+					if (i < n && (text[i] == '+' || text[i] == '-')) ++i;
+					while (i < n && std::isdigit((unsigned char)text[i])) ++i;
+				}
+			}
+			emit(start, i, number_color);
+		}
+		else if (is_identifier_char(c))
+		{
+			while (i < n && is_identifier_char(text[i])) ++i;
+			if (std::binary_search(std::begin(keywords), std::end(keywords), text.substr(start, i - start)))
+				emit(start, i, keyword_color);
+		}
+		else
+			++i;
+	}
+	return state;
+}
+
+const WrenStyler::State& WrenStyler::get_start_state(size_t index)
+{
+	// Each line starts in the state the line above ended in
+	for (; m_KnownStates <= index; ++m_KnownStates)
+	{
+		const LineEntry& above = m_Lines[m_KnownStates - 1];
+		m_Lines[m_KnownStates].start_state = scan(m_Content->get_line(m_KnownStates - 1), above.start_state, nullptr);
+	}
+	return m_Lines[index].start_state;
+}
+
+StyleRunRange WrenStyler::style_line(size_t index, std::string_view text)
+{
+	const size_t line_count = m_Content->get_line_count();
+	if (m_Lines.size() != line_count)
+		invalidate(std::min(m_Lines.size(), line_count));
+	if (index >= line_count)
+		return {};
+
+	LineEntry& entry = m_Lines[index];
+	if (entry.run_count == not_styled)
+	{
+		// The text is the line as drawn, with tabs expanded, which doesn't
+		// change how it lexes
+		State state = get_start_state(index);
+		size_t offset = m_Runs.size();
+		scan(text, state, &m_Runs);
+		entry.run_offset = uint32_t(offset);
+		entry.run_count = uint16_t(std::min<size_t>(m_Runs.size() - offset, not_styled - 1));
+	}
+	const StyleRun* runs = m_Runs.data() + entry.run_offset;
+	return { runs, runs + entry.run_count };
+}
+
+void WrenStyler::invalidate(size_t first_line)
+{
+	m_Lines.resize(m_Content->get_line_count());
+	m_KnownStates = std::max<size_t>(1, std::min(m_KnownStates, first_line + 1));
+	// Runs are kept in one array, so all lines are styled again
+	m_Runs.clear();
+	for (auto& entry : m_Lines)
+		entry.run_count = not_styled;
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <conwin.h>
+
+// Syntax highlighting for Wren source in the Code window.
+//
+// A line is tokenized the first time it is drawn and its style runs are
+// appended to one flat array, so a line costs a small entry rather than a
+// container of its own.  Block comments and strings may span lines, so each
+// line also records the lexer state it starts in.  Jumping far down a module
+// only scans the lines above for their state, once.
+class WrenStyler : public LineStyler
+{
+	enum class Mode : uint8_t
+	{
+		Code,
+		String,
+		RawString,		// """ ... """
+		Comment			// /* ... */, which nest in Wren
+	};
+
+	struct State
+	{
+		Mode		mode = Mode::Code;
+		uint8_t		comment_depth = 0;
+	};
+
+	static constexpr uint16_t not_styled = 0xFFFF;
+
+	struct LineEntry
+	{
+		uint32_t	run_offset = 0;
+		uint16_t	run_count = not_styled;
+		State		start_state;
+	};
+
+	ContentProviderPtr			m_Content;
+	std::vector<LineEntry>		m_Lines;
+	size_t						m_KnownStates = 1;	// Lines whose start state is known
+	std::vector<StyleRun>		m_Runs;
+
+	static State				scan(std::string_view text, State state, std::vector<StyleRun>* runs);
+	const State&				get_start_state(size_t index);
+public:
+	explicit WrenStyler(const ContentProviderPtr& content);
+
+	virtual StyleRunRange		style_line(size_t index, std::string_view text) override;
+	virtual void				invalidate(size_t first_line) override;
+};
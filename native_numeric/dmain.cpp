@@ -0,0 +1,41 @@
+#include "binder.h"
+#include <wren.hpp>
+#include "initializers.h"
+
+#ifdef WIN32
+#define EXPORT __declspec(dllexport)
+#else
+#define EXPORT
+#endif
+
+extern "C" {
+
+	EXPORT void Initialize(WrenVM* vm)
+	{
+		register_modules(vm, foreign_module_code);
+	}
+
+	EXPORT void Shutdown()
+	{
+	}
+
+	EXPORT ForeignFunctions::wrapper GetFunction(const char* name)
+	{
+		return find_binding(foreign_bindings, name);
+	}
+
+	// Optional: lets the host put all bindings in one table at load time
+	EXPORT void EnumerateFunctions(EnumerateCallback callback, void* context)
+	{
+		for (const auto& binding : foreign_bindings)
+			callback(context, binding.name.data(), binding.func);
+	}
+
+	// Optional: the foreign classes of the library
+	EXPORT void EnumerateClasses(EnumerateClassCallback callback, void* context)
+	{
+		for (const auto& binding : foreign_classes)
+			callback(context, binding.name.data(), { binding.allocate, binding.finalize });
+	}
+
+}
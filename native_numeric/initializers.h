@@ -0,0 +1,92 @@
+#pragma once
+
+#include <binder.h>
+
+void numeric_Float64Array_add_wrapper(WrenVM* vm);
+void numeric_Float64Array_count_wrapper(WrenVM* vm);
+void numeric_Float64Array_dot_wrapper(WrenVM* vm);
+void numeric_Float64Array_fill_wrapper(WrenVM* vm);
+void numeric_Float64Array_fma_wrapper(WrenVM* vm);
+void numeric_Float64Array_get_wrapper(WrenVM* vm);
+void numeric_Float64Array_load_wrapper(WrenVM* vm);
+void numeric_Float64Array_max_wrapper(WrenVM* vm);
+void numeric_Float64Array_min_wrapper(WrenVM* vm);
+void numeric_Float64Array_mul_wrapper(WrenVM* vm);
+void numeric_Float64Array_prefixSum_wrapper(WrenVM* vm);
+void numeric_Float64Array_search_wrapper(WrenVM* vm);
+void numeric_Float64Array_set_wrapper(WrenVM* vm);
+void numeric_Float64Array_sort_wrapper(WrenVM* vm);
+void numeric_Float64Array_sum_wrapper(WrenVM* vm);
+void numeric_Float64Array_toList_wrapper(WrenVM* vm);
+void numeric_Float64Array_allocate(WrenVM* vm);
+void numeric_Float64Array_finalize(void* data);
+
+// Sorted by name, searched with find_binding
+constexpr ForeignBinding foreign_bindings[] =
+{
+	{ "numeric.Float64Array#add_(_)", numeric_Float64Array_add_wrapper },
+	{ "numeric.Float64Array#count()", numeric_Float64Array_count_wrapper },
+	{ "numeric.Float64Array#dot_(_)", numeric_Float64Array_dot_wrapper },
+	{ "numeric.Float64Array#fill(_)", numeric_Float64Array_fill_wrapper },
+	{ "numeric.Float64Array#fma_(_,_)", numeric_Float64Array_fma_wrapper },
+	{ "numeric.Float64Array#get(_)", numeric_Float64Array_get_wrapper },
+	{ "numeric.Float64Array#load(_)", numeric_Float64Array_load_wrapper },
+	{ "numeric.Float64Array#max()", numeric_Float64Array_max_wrapper },
+	{ "numeric.Float64Array#min()", numeric_Float64Array_min_wrapper },
+	{ "numeric.Float64Array#mul_(_)", numeric_Float64Array_mul_wrapper },
+	{ "numeric.Float64Array#prefixSum()", numeric_Float64Array_prefixSum_wrapper },
+	{ "numeric.Float64Array#search(_)", numeric_Float64Array_search_wrapper },
+	{ "numeric.Float64Array#set(_,_)", numeric_Float64Array_set_wrapper },
+	{ "numeric.Float64Array#sort()", numeric_Float64Array_sort_wrapper },
+	{ "numeric.Float64Array#sum()", numeric_Float64Array_sum_wrapper },
+	{ "numeric.Float64Array#toList()", numeric_Float64Array_toList_wrapper },
+};
+static_assert(is_sorted_bindings(foreign_bindings), "foreign_bindings must be sorted by name, without duplicates");
+
+constexpr ForeignClassBinding foreign_classes[] =
+{
+	{ "numeric.Float64Array", numeric_Float64Array_allocate, numeric_Float64Array_finalize },
+};
+static_assert(is_sorted_bindings(foreign_classes), "foreign_classes must be sorted by name, without duplicates");
+
+constexpr ForeignModuleCode foreign_module_code[] =
+{
+	{ "numeric", R"(
+foreign class Float64Array {
+	construct new(count) {}
+	foreign count()
+	foreign load(values)
+	foreign toList()
+	foreign get(index)
+	foreign set(index, value)
+	foreign fill(value)
+	add(other) {
+		if (!(other is Float64Array)) Fiber.abort("other must be a Float64Array.")
+		return this.add_(other)
+	}
+	foreign add_(other)
+	mul(other) {
+		if (!(other is Float64Array)) Fiber.abort("other must be a Float64Array.")
+		return this.mul_(other)
+	}
+	foreign mul_(other)
+	fma(factor, addend) {
+		if (!(factor is Float64Array)) Fiber.abort("factor must be a Float64Array.")
+		if (!(addend is Float64Array)) Fiber.abort("addend must be a Float64Array.")
+		return this.fma_(factor, addend)
+	}
+	foreign fma_(factor, addend)
+	foreign sum()
+	dot(other) {
+		if (!(other is Float64Array)) Fiber.abort("other must be a Float64Array.")
+		return this.dot_(other)
+	}
+	foreign dot_(other)
+	foreign min()
+	foreign max()
+	foreign prefixSum()
+	foreign sort()
+	foreign search(value)
+}
+)" },
+};
@@ -0,0 +1,113 @@
+#include "kernels.h"
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+static void scalar_add(double* a, const double* b, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		a[i] += b[i];
+}
+
+static void scalar_mul(double* a, const double* b, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		a[i] *= b[i];
+}
+
+static void scalar_fma(double* a, const double* b, const double* c, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		a[i] = a[i] * b[i] + c[i];
+}
+
+static double scalar_sum(const double* a, size_t n)
+{
+	double sum = 0;
+	for (size_t i = 0; i < n; ++i)
+		sum += a[i];
+	return sum;
+}
+
+static double scalar_dot(const double* a, const double* b, size_t n)
+{
+	double sum = 0;
+	for (size_t i = 0; i < n; ++i)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+static double scalar_min(const double* a, size_t n)
+{
+	double result = a[0];
+	for (size_t i = 1; i < n; ++i)
+		result = a[i] < result ? a[i] : result;
+	return result;
+}
+
+static double scalar_max(const double* a, size_t n)
+{
+	double result = a[0];
+	for (size_t i = 1; i < n; ++i)
+		result = a[i] > result ? a[i] : result;
+	return result;
+}
+
+static void scalar_prefix_sum(double* a, size_t n)
+{
+	double sum = 0;
+	for (size_t i = 0; i < n; ++i)
+	{
+		sum += a[i];
+		a[i] = sum;
+	}
+}
+
+const NumericKernels& get_scalar_kernels()
+{
+	static const NumericKernels kernels =
+	{
+		"scalar",
+		scalar_add,
+		scalar_mul,
+		scalar_fma,
+		scalar_sum,
+		scalar_dot,
+		scalar_min,
+		scalar_max,
+		scalar_prefix_sum
+	};
+	return kernels;
+}
+
+// Built for any x86-64 CPU, unlike kernels_avx2.cpp
+static bool cpu_has_avx2()
+{
+#if defined(_MSC_VER) && defined(_M_X64)
+	int info[4];
+	__cpuid(info, 0);
+	if (info[0] < 7) return false;
+	__cpuid(info, 1);
+	bool fma = (info[2] & (1 << 12)) != 0;
+	bool osxsave = (info[2] & (1 << 27)) != 0;
+	if (!fma || !osxsave || (_xgetbv(0) & 0x6) != 0x6) return false;
+	__cpuidex(info, 7, 0);
+	return (info[1] & (1 << 5)) != 0;
+#elif defined(__x86_64__)
+	return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#else
+	return false;
+#endif
+}
+
+const NumericKernels* get_avx2_kernels()
+{
+	static const bool supported = avx2_kernel_table && cpu_has_avx2();
+	return supported ? avx2_kernel_table : nullptr;
+}
+
+const NumericKernels& get_kernels()
+{
+	static const NumericKernels& kernels = get_avx2_kernels() ? *get_avx2_kernels() : get_scalar_kernels();
+	return kernels;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+
+// Element-wise and reduction kernels over arrays of doubles.  Each instruction
+// set fills in the same table; get_kernels() picks the best one the CPU
+// supports, once.
+struct NumericKernels
+{
+	const char*	name;
+	void	(*add)(double* a, const double* b, size_t n);						// a += b
+	void	(*mul)(double* a, const double* b, size_t n);						// a *= b
+	void	(*fma)(double* a, const double* b, const double* c, size_t n);		// a = a * b + c
+	double	(*sum)(const double* a, size_t n);
+	double	(*dot)(const double* a, const double* b, size_t n);
+	double	(*min)(const double* a, size_t n);									// n > 0
+	double	(*max)(const double* a, size_t n);									// n > 0
+	void	(*prefix_sum)(double* a, size_t n);									// Inclusive
+};
+
+const NumericKernels& get_kernels();
+const NumericKernels& get_scalar_kernels();
+// nullptr when not built in, or the CPU lacks AVX2 and FMA
+const NumericKernels* get_avx2_kernels();
+
+// The table of kernels_avx2.cpp, nullptr where it isn't built for AVX2.  Use
+// get_avx2_kernels(), which checks the CPU first.
+extern const NumericKernels* const avx2_kernel_table;
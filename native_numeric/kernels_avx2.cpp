@@ -0,0 +1,160 @@
+#include "kernels.h"
+
+// Built with AVX2 and FMA enabled (see CMakeLists.txt), so no code of this
+// file may run before kernels.cpp has checked the CPU for them.  It only
+// exports its table, which is initialized at compile time.
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+
+static void avx2_add(double* a, const double* b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(a + i, _mm256_add_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+	for (; i < n; ++i)
+		a[i] += b[i];
+}
+
+static void avx2_mul(double* a, const double* b, size_t n)
+{
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(a + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+	for (; i < n; ++i)
+		a[i] *= b[i];
+}
+
+static void avx2_fma(double* a, const double* b, const double* c, size_t n)
+{
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+		_mm256_storeu_pd(a + i, _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _mm256_loadu_pd(c + i)));
+	for (; i < n; ++i)
+		a[i] = a[i] * b[i] + c[i];
+}
+
+static double horizontal_sum(__m256d v)
+{
+	__m128d low = _mm256_castpd256_pd128(v);
+	__m128d high = _mm256_extractf128_pd(v, 1);
+	low = _mm_add_pd(low, high);
+	return _mm_cvtsd_f64(_mm_add_sd(low, _mm_unpackhi_pd(low, low)));
+}
+
+// Two accumulators hide the latency of the additions
+static double avx2_sum(const double* a, size_t n)
+{
+	__m256d sum0 = _mm256_setzero_pd();
+	__m256d sum1 = _mm256_setzero_pd();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		sum0 = _mm256_add_pd(sum0, _mm256_loadu_pd(a + i));
+		sum1 = _mm256_add_pd(sum1, _mm256_loadu_pd(a + i + 4));
+	}
+	double sum = horizontal_sum(_mm256_add_pd(sum0, sum1));
+	for (; i < n; ++i)
+		sum += a[i];
+	return sum;
+}
+
+static double avx2_dot(const double* a, const double* b, size_t n)
+{
+	__m256d sum0 = _mm256_setzero_pd();
+	__m256d sum1 = _mm256_setzero_pd();
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+	{
+		sum0 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), sum0);
+		sum1 = _mm256_fmadd_pd(_mm256_loadu_pd(a + i + 4), _mm256_loadu_pd(b + i + 4), sum1);
+	}
+	double sum = horizontal_sum(_mm256_add_pd(sum0, sum1));
+	for (; i < n; ++i)
+		sum += a[i] * b[i];
+	return sum;
+}
+
+static double avx2_min(const double* a, size_t n)
+{
+	double result = a[0];
+	size_t i = 0;
+	if (n >= 4)
+	{
+		__m256d m = _mm256_loadu_pd(a);
+		for (i = 4; i + 4 <= n; i += 4)
+			m = _mm256_min_pd(m, _mm256_loadu_pd(a + i));
+		alignas(32) double lanes[4];
+		_mm256_store_pd(lanes, m);
+		result = lanes[0];
+		for (double lane : lanes)
+			result = lane < result ? lane : result;
+	}
+	for (; i < n; ++i)
+		result = a[i] < result ? a[i] : result;
+	return result;
+}
+
+static double avx2_max(const double* a, size_t n)
+{
+	double result = a[0];
+	size_t i = 0;
+	if (n >= 4)
+	{
+		__m256d m = _mm256_loadu_pd(a);
+		for (i = 4; i + 4 <= n; i += 4)
+			m = _mm256_max_pd(m, _mm256_loadu_pd(a + i));
+		alignas(32) double lanes[4];
+		_mm256_store_pd(lanes, m);
+		result = lanes[0];
+		for (double lane : lanes)
+			result = lane > result ? lane : result;
+	}
+	for (; i < n; ++i)
+		result = a[i] > result ? a[i] : result;
+	return result;
+}
+
+// Scans four elements in registers with two shifted adds, then adds the
+// running total carried from the previous four
+static void avx2_prefix_sum(double* a, size_t n)
+{
+	const __m256d zero = _mm256_setzero_pd();
+	__m256d carry = zero;
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256d x = _mm256_loadu_pd(a + i);
+		x = _mm256_add_pd(x, _mm256_blend_pd(_mm256_permute4x64_pd(x, _MM_SHUFFLE(2, 1, 0, 0)), zero, 0x1));
+		x = _mm256_add_pd(x, _mm256_blend_pd(_mm256_permute4x64_pd(x, _MM_SHUFFLE(1, 0, 0, 0)), zero, 0x3));
+		x = _mm256_add_pd(x, carry);
+		_mm256_storeu_pd(a + i, x);
+		carry = _mm256_permute4x64_pd(x, _MM_SHUFFLE(3, 3, 3, 3));
+	}
+	double sum = _mm256_cvtsd_f64(carry);
+	for (; i < n; ++i)
+	{
+		sum += a[i];
+		a[i] = sum;
+	}
+}
+
+static constexpr NumericKernels kernels =
+{
+	"avx2",
+	avx2_add,
+	avx2_mul,
+	avx2_fma,
+	avx2_sum,
+	avx2_dot,
+	avx2_min,
+	avx2_max,
+	avx2_prefix_sum
+};
+
+const NumericKernels* const avx2_kernel_table = &kernels;
+
+#else
+
+const NumericKernels* const avx2_kernel_table = nullptr;
+
+#endif
@@ -0,0 +1,381 @@
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <wren.hpp>
+#include <binder.h>
+#include "kernels.h"
+#include "numeric.h"
+
+static void check_same_count(const Float64Array& a, const Float64Array& b)
+{
+	if (a.count() != b.count())
+		throw std::invalid_argument("Float64Array counts differ: " + std::to_string(a.count()) + " and " + std::to_string(b.count()));
+}
+
+static void check_not_empty(const Float64Array& a)
+{
+	if (a.count() == 0)
+		throw std::out_of_range("Float64Array is empty");
+}
+
+Float64Array::Float64Array(int count)
+	: m_Values(size_t(std::max(count, 0)))
+{
+}
+
+int Float64Array::count() const
+{
+	return int(m_Values.size());
+}
+
+void Float64Array::load(const std::vector<double>& values)
+{
+	m_Values = values;
+}
+
+std::vector<double> Float64Array::toList() const
+{
+	return m_Values;
+}
+
+double Float64Array::get(int index) const
+{
+	if (index < 0 || index >= count())
+		throw std::out_of_range("Float64Array index out of bounds: " + std::to_string(index));
+	return m_Values[size_t(index)];
+}
+
+void Float64Array::set(int index, double value)
+{
+	if (index < 0 || index >= count())
+		throw std::out_of_range("Float64Array index out of bounds: " + std::to_string(index));
+	m_Values[size_t(index)] = value;
+}
+
+void Float64Array::fill(double value)
+{
+	std::fill(m_Values.begin(), m_Values.end(), value);
+}
+
+void Float64Array::add(const Float64Array& other)
+{
+	check_same_count(*this, other);
+	get_kernels().add(m_Values.data(), other.m_Values.data(), m_Values.size());
+}
+
+void Float64Array::mul(const Float64Array& other)
+{
+	check_same_count(*this, other);
+	get_kernels().mul(m_Values.data(), other.m_Values.data(), m_Values.size());
+}
+
+void Float64Array::fma(const Float64Array& factor, const Float64Array& addend)
+{
+	check_same_count(*this, factor);
+	check_same_count(*this, addend);
+	get_kernels().fma(m_Values.data(), factor.m_Values.data(), addend.m_Values.data(), m_Values.size());
+}
+
+double Float64Array::sum() const
+{
+	return get_kernels().sum(m_Values.data(), m_Values.size());
+}
+
+double Float64Array::dot(const Float64Array& other) const
+{
+	check_same_count(*this, other);
+	return get_kernels().dot(m_Values.data(), other.m_Values.data(), m_Values.size());
+}
+
+double Float64Array::min() const
+{
+	check_not_empty(*this);
+	return get_kernels().min(m_Values.data(), m_Values.size());
+}
+
+double Float64Array::max() const
+{
+	check_not_empty(*this);
+	return get_kernels().max(m_Values.data(), m_Values.size());
+}
+
+void Float64Array::prefixSum()
+{
+	get_kernels().prefix_sum(m_Values.data(), m_Values.size());
+}
+
+void Float64Array::sort()
+{
+	std::sort(m_Values.begin(), m_Values.end());
+}
+
+// Index of the first element not less than value, in a sorted array
+int Float64Array::search(double value) const
+{
+	return int(std::lower_bound(m_Values.begin(), m_Values.end(), value) - m_Values.begin());
+}
+
+//////////////////////////////////////////////////
+//AUTOGENERATED CODE - DO NOT EDIT
+
+void numeric_Float64Array_count_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		int result = self.count();
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_load_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		const std::vector<double>& values = SlotTraits<std::vector<double>>::get(vm, 1);
+		self.load(values);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_toList_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		std::vector<double> result = self.toList();
+		SlotTraits<std::vector<double>>::set(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_get_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		int index = SlotTraits<int>::get(vm, 1);
+		double result = self.get(index);
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_set_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		int index = SlotTraits<int>::get(vm, 1);
+		double value = wrenGetSlotDouble(vm, 2);
+		self.set(index,value);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_fill_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		double value = wrenGetSlotDouble(vm, 1);
+		self.fill(value);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_add_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		const Float64Array& other = get_foreign_object<Float64Array>(vm, 1);
+		self.add(other);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_mul_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		const Float64Array& other = get_foreign_object<Float64Array>(vm, 1);
+		self.mul(other);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_fma_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		const Float64Array& factor = get_foreign_object<Float64Array>(vm, 1);
+		const Float64Array& addend = get_foreign_object<Float64Array>(vm, 2);
+		self.fma(factor,addend);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_sum_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		double result = self.sum();
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_dot_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		const Float64Array& other = get_foreign_object<Float64Array>(vm, 1);
+		double result = self.dot(other);
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_min_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		double result = self.min();
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_max_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		double result = self.max();
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_prefixSum_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		self.prefixSum();
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_sort_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		self.sort();
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_search_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Float64Array& self = get_foreign_object<Float64Array>(vm, 0);
+		double value = wrenGetSlotDouble(vm, 1);
+		int result = self.search(value);
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_allocate(WrenVM* vm)
+{
+	try
+	{
+		int count = SlotTraits<int>::get(vm, 1);
+		new_foreign_object<Float64Array>(vm, count);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void numeric_Float64Array_finalize(void* data)
+{
+	delete_foreign_object<Float64Array>(data);
+}
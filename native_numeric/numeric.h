@@ -0,0 +1,30 @@
+#pragma once
+
+#include <vector>
+
+
+// An array of doubles whose element-wise operations and reductions run in
+// native kernels, vectorized when the CPU allows (see kernels.h)
+//BIND
+class Float64Array
+{
+	std::vector<double> m_Values;
+public:
+	Float64Array(int count);
+	int count() const;
+	void load(const std::vector<double>& values);
+	std::vector<double> toList() const;
+	double get(int index) const;
+	void set(int index, double value);
+	void fill(double value);
+	void add(const Float64Array& other);
+	void mul(const Float64Array& other);
+	void fma(const Float64Array& factor, const Float64Array& addend);
+	double sum() const;
+	double dot(const Float64Array& other) const;
+	double min() const;
+	double max() const;
+	void prefixSum();
+	void sort();
+	int search(double value) const;
+};
@@ -12,8 +12,7 @@ extern "C" {
 
 	EXPORT void Initialize(WrenVM* vm)
 	{
-		initialize_bindings();
-		Singleton<ForeignFunctions>::Instance().register_modules(vm);
+		register_modules(vm, foreign_module_code);
 	}
 
 	EXPORT void Shutdown()
@@ -22,7 +21,21 @@ extern "C" {
 
 	EXPORT ForeignFunctions::wrapper GetFunction(const char* name)
 	{
-		return Singleton<ForeignFunctions>::Instance().get(name);
+		return find_binding(foreign_bindings, name);
+	}
+
+	// Optional: lets the host put all bindings in one table at load time
+	EXPORT void EnumerateFunctions(EnumerateCallback callback, void* context)
+	{
+		for (const auto& binding : foreign_bindings)
+			callback(context, binding.name.data(), binding.func);
+	}
+
+	// Optional: the foreign classes of the library
+	EXPORT void EnumerateClasses(EnumerateClassCallback callback, void* context)
+	{
+		for (const auto& binding : foreign_classes)
+			callback(context, binding.name.data(), { binding.allocate, binding.finalize });
 	}
 
 }
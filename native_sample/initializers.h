@@ -1,8 +1,83 @@
 #pragma once
 
-void initialize_bindings()
+#include <binder.h>
+
+void sample_Counter_Increment_wrapper(WrenVM* vm);
+void sample_Counter_Value_wrapper(WrenVM* vm);
+void sample_Sample_Add_wrapper(WrenVM* vm);
+void sample_Sample_Add_batch_wrapper(WrenVM* vm);
+void sample_Sample_CountWords_wrapper(WrenVM* vm);
+void sample_Sample_Head_wrapper(WrenVM* vm);
+void sample_Sample_Print_wrapper(WrenVM* vm);
+void sample_Sample_Print_batch_wrapper(WrenVM* vm);
+void sample_Sample_Range_wrapper(WrenVM* vm);
+void sample_Sample_Sum_wrapper(WrenVM* vm);
+void sample_Sample_Total_wrapper(WrenVM* vm);
+void sample_Sample_d2s_wrapper(WrenVM* vm);
+void sample_Sample_d2s_batch_wrapper(WrenVM* vm);
+void sample_Counter_allocate(WrenVM* vm);
+void sample_Counter_finalize(void* data);
+
+// Sorted by name, searched with find_binding
+constexpr ForeignBinding foreign_bindings[] =
 {
-	void sample_Sample_Binder();
-	sample_Sample_Binder();
-}
+	{ "sample.Counter#Increment(_)", sample_Counter_Increment_wrapper },
+	{ "sample.Counter#Value()", sample_Counter_Value_wrapper },
+	{ "sample.Sample.Add(_,_)", sample_Sample_Add_wrapper },
+	{ "sample.Sample.Add_batch_(_,_)", sample_Sample_Add_batch_wrapper },
+	{ "sample.Sample.CountWords(_)", sample_Sample_CountWords_wrapper },
+	{ "sample.Sample.Head_(_,_)", sample_Sample_Head_wrapper },
+	{ "sample.Sample.Print(_)", sample_Sample_Print_wrapper },
+	{ "sample.Sample.Print_batch_(_)", sample_Sample_Print_batch_wrapper },
+	{ "sample.Sample.Range(_)", sample_Sample_Range_wrapper },
+	{ "sample.Sample.Sum(_)", sample_Sample_Sum_wrapper },
+	{ "sample.Sample.Total_(_,_)", sample_Sample_Total_wrapper },
+	{ "sample.Sample.d2s(_)", sample_Sample_d2s_wrapper },
+	{ "sample.Sample.d2s_batch(_)", sample_Sample_d2s_batch_wrapper },
+};
+static_assert(is_sorted_bindings(foreign_bindings), "foreign_bindings must be sorted by name, without duplicates");
+
+constexpr ForeignClassBinding foreign_classes[] =
+{
+	{ "sample.Counter", sample_Counter_allocate, sample_Counter_finalize },
+};
+static_assert(is_sorted_bindings(foreign_classes), "foreign_classes must be sorted by name, without duplicates");
 
+constexpr ForeignModuleCode foreign_module_code[] =
+{
+	{ "sample", R"(
+import "buffer" for Buffer
+class Sample {
+	foreign static Print(value)
+	static Print_batch(value) {
+		if (!(value is List) && !(value is Buffer)) Fiber.abort("value must be a List or a Buffer.")
+		return this.Print_batch_(value)
+	}
+	foreign static Print_batch_(value)
+	foreign static Add(a, b)
+	static Add_batch(a, b) {
+		if (!(a is List) && !(a is Buffer)) Fiber.abort("a must be a List or a Buffer.")
+		if (!(b is List) && !(b is Buffer)) Fiber.abort("b must be a List or a Buffer.")
+		return this.Add_batch_(a, b)
+	}
+	foreign static Add_batch_(a, b)
+	foreign static d2s(value)
+	foreign static d2s_batch(value)
+	static Head(data, length) {
+		if (!(data is Buffer)) Fiber.abort("data must be a Buffer.")
+		return this.Head_(data, length)
+	}
+	foreign static Head_(data, length)
+	foreign static Range(count)
+	foreign static Sum(values)
+	foreign static CountWords(words)
+	static Total(counts) { this.Total_(counts.keys.toList, counts.values.toList) }
+	foreign static Total_(counts_keys, counts_values)
+}
+foreign class Counter {
+	construct new(start) {}
+	foreign Increment(by)
+	foreign Value()
+}
+)" },
+};
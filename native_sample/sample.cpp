@@ -2,6 +2,7 @@
 #include <sstream>
 #include <wren.hpp>
 #include <singleton.h>
+#include <batch.h>
 #include <binder.h>
 #include "sample.h"
 
@@ -22,43 +23,242 @@ std::string Sample::d2s(double value)
 	return os.str();
 }
 
+Buffer Sample::Head(const Buffer& data, int length)
+{
+	return data.slice(0, size_t(std::max(length, 0)));
+}
+
+std::vector<double> Sample::Range(int count)
+{
+	std::vector<double> values(size_t(std::max(count, 0)));
+	for (size_t i = 0; i < values.size(); ++i)
+		values[i] = double(i);
+	return values;
+}
+
+double Sample::Sum(const std::vector<double>& values)
+{
+	double sum = 0;
+	for (double value : values)
+		sum += value;
+	return sum;
+}
+
+std::map<std::string, double> Sample::CountWords(const std::vector<std::string>& words)
+{
+	std::map<std::string, double> counts;
+	for (const auto& word : words)
+		counts[word] += 1;
+	return counts;
+}
+
+double Sample::Total(const std::map<std::string, double>& counts)
+{
+	double total = 0;
+	for (const auto& [word, count] : counts)
+		total += count;
+	return total;
+}
+
+Counter::Counter(int start)
+	: m_Value(start)
+{
+}
+
+void Counter::Increment(int by)
+{
+	m_Value += by;
+}
+
+int Counter::Value() const
+{
+	return m_Value;
+}
+
 //////////////////////////////////////////////////
 //AUTOGENERATED CODE - DO NOT EDIT
 
 void sample_Sample_Print_wrapper(WrenVM* vm)
 {
-	int value = static_cast<int>(wrenGetSlotDouble(vm, 1));
-	Sample::Print(value);
+	try
+	{
+		int value = SlotTraits<int>::get(vm, 1);
+		Sample::Print(value);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void sample_Sample_Print_batch_wrapper(WrenVM* vm)
+{
+	foreign_batch_wrapper<&Sample::Print>(vm);
 }
 
 void sample_Sample_Add_wrapper(WrenVM* vm)
 {
-	double a = wrenGetSlotDouble(vm, 1);
-	double b = wrenGetSlotDouble(vm, 2);
-	double result = Sample::Add(a,b);
-	wrenSetSlotDouble(vm, 0, result);
+	try
+	{
+		double a = wrenGetSlotDouble(vm, 1);
+		double b = wrenGetSlotDouble(vm, 2);
+		double result = Sample::Add(a,b);
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void sample_Sample_Add_batch_wrapper(WrenVM* vm)
+{
+	foreign_batch_wrapper<&Sample::Add>(vm);
 }
 
 void sample_Sample_d2s_wrapper(WrenVM* vm)
 {
-	double value = wrenGetSlotDouble(vm, 1);
-	std::string result = Sample::d2s(value);
-	wrenSetSlotString(vm, 0, result.c_str());
+	try
+	{
+		double value = wrenGetSlotDouble(vm, 1);
+		std::string result = Sample::d2s(value);
+		wrenSetSlotString(vm, 0, result.c_str());
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void sample_Sample_d2s_batch_wrapper(WrenVM* vm)
+{
+	foreign_batch_wrapper<&Sample::d2s>(vm);
+}
+
+void sample_Sample_Head_wrapper(WrenVM* vm)
+{
+	try
+	{
+		const Buffer& data = SlotTraits<Buffer>::get(vm, 1);
+		int length = SlotTraits<int>::get(vm, 2);
+		Buffer result = Sample::Head(data,length);
+		SlotTraits<Buffer>::set(vm, 0, std::move(result));
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
 }
 
+void sample_Sample_Range_wrapper(WrenVM* vm)
+{
+	try
+	{
+		int count = SlotTraits<int>::get(vm, 1);
+		std::vector<double> result = Sample::Range(count);
+		SlotTraits<std::vector<double>>::set(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
 
-void sample_Sample_Binder()
+void sample_Sample_Sum_wrapper(WrenVM* vm)
 {
-	Singleton<ForeignFunctions>::Instance().bind("sample.Sample.Print(_)", sample_Sample_Print_wrapper);
-	Singleton<ForeignFunctions>::Instance().bind("sample.Sample.Add(_,_)", sample_Sample_Add_wrapper);
-	Singleton<ForeignFunctions>::Instance().bind("sample.Sample.d2s(_)", sample_Sample_d2s_wrapper);
-	const char* module_code=R"(
-class Sample {
-	foreign static Print(value)
-	foreign static Add(a, b)
-	foreign static d2s(value)
+	try
+	{
+		const std::vector<double>& values = SlotTraits<std::vector<double>>::get(vm, 1);
+		double result = Sample::Sum(values);
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
 }
-)";
-	Singleton<ForeignFunctions>::Instance().set_module_code("sample", module_code);
+
+void sample_Sample_CountWords_wrapper(WrenVM* vm)
+{
+	try
+	{
+		const std::vector<std::string>& words = SlotTraits<std::vector<std::string>>::get(vm, 1);
+		std::map<std::string, double> result = Sample::CountWords(words);
+		SlotTraits<std::map<std::string, double>>::set(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
 }
 
+void sample_Sample_Total_wrapper(WrenVM* vm)
+{
+	try
+	{
+		const std::map<std::string, double>& counts = SlotTraits<std::map<std::string, double>>::get(vm, 1, 2);
+		double result = Sample::Total(counts);
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void sample_Counter_Increment_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Counter& self = get_foreign_object<Counter>(vm, 0);
+		int by = SlotTraits<int>::get(vm, 1);
+		self.Increment(by);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void sample_Counter_Value_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Counter& self = get_foreign_object<Counter>(vm, 0);
+		int result = self.Value();
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void sample_Counter_allocate(WrenVM* vm)
+{
+	try
+	{
+		int start = SlotTraits<int>::get(vm, 1);
+		new_foreign_object<Counter>(vm, start);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void sample_Counter_finalize(void* data)
+{
+	delete_foreign_object<Counter>(data);
+}
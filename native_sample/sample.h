@@ -1,12 +1,31 @@
 #pragma once
 
+#include <map>
+#include <string>
+#include <vector>
+#include <buffer.h>
 
-//BIND
+
+//BIND batch
 class Sample
 {
 public:
 	static void Print(int value);
 	static double Add(double a, double b);
 	static std::string d2s(double value);
+	static Buffer Head(const Buffer& data, int length);
+	static std::vector<double> Range(int count);
+	static double Sum(const std::vector<double>& values);
+	static std::map<std::string, double> CountWords(const std::vector<std::string>& words);
+	static double Total(const std::map<std::string, double>& counts);
 };
 
+//BIND
+class Counter
+{
+	int m_Value;
+public:
+	Counter(int start);
+	void Increment(int by);
+	int Value() const;
+};
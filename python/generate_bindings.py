@@ -1,14 +1,23 @@
 from typing import List
 import argh
+import io
 import os
 import re
 
-all_initializers=[]
+all_bindings={}
+all_classes={}
+foreign_class_names=set()
+all_module_code={}
+# Modules whose Wren code refers to Buffer
+buffer_modules=set()
 class_pattern = r'class (\w+)'
-argument_pattern = r'(int|const char\*|const Bytes\&) (\w+)'
-return_type_pattern = r'(void|int|double|bool|std::string)'
+container_pattern = r'std::(?:vector|map)<[\w:, <>]*>'
+argument_pattern = r'(int|const char\*|const Bytes\&|const Buffer\&|(?:const )?'+container_pattern+r'\&?) (\w+)'
+return_type_pattern = r'(void|int|double|bool|std::string|Buffer|'+container_pattern+')'
 multi_argument_pattern = argument_pattern + r'(, '+argument_pattern+')*'
 func_pattern = r'static\s+'+return_type_pattern+r'\s+(\w+)\(([^)]*)\);'
+method_pattern = return_type_pattern+r'\s+(\w+)\(([^)]*)\)\s*(const)?\s*;'
+header_comment = '//AUTOGENERATED CODE - DO NOT EDIT'
 type_slot_mapping={
     'int': 'Double',
     'double': 'Double',
@@ -17,93 +26,319 @@ type_slot_mapping={
     'bool': 'Bool',
     'const Bytes&': 'Bytes'
 }
+# Foreign objects, converted by their SlotTraits instead of a wrenGetSlot call
+traits_types={
+    'const Buffer&': 'Buffer',
+    'Buffer': 'Buffer'
+}
+
+# std::vector<T> and std::map<K, V>, by value or const reference, converted by
+# their SlotTraits; None for other types
+def container_type(name: str):
+    name = name.strip()
+    if name.startswith('const '):
+        name = name[len('const '):]
+    name = name.rstrip('&').strip()
+    if re.fullmatch(container_pattern, name):
+        return name
+    return None
+
+# The class of a bound foreign class argument, taken by const reference
+def foreign_object_type(name: str):
+    m = re.fullmatch(r'const (\w+)\s*&', name.strip())
+    if m and m.group(1) in foreign_class_names:
+        return m.group(1)
+    return None
+
+def is_map(name: str) -> bool:
+    container = container_type(name)
+    return container is not None and container.startswith('std::map<')
 
 def type_to_slot(name: str)->str:
     if name in type_slot_mapping:
         return type_slot_mapping[name]
     raise RuntimeError(f'Unknown type {name}')
 
-def process_class(header_path: str, module_name: str, class_lines: List[str]):
-    impl_path = header_path.replace('.h', '.cpp')
-    impl_lines=[]
-    header_comment = '//AUTOGENERATED CODE - DO NOT EDIT'
-    with open(impl_path) as f:
-        impl_lines = f.readlines()
-    for i in range(len(impl_lines)):
-        if impl_lines[i].startswith(header_comment):
-            impl_lines = impl_lines[0:i]
-            break
-    f = open(impl_path, 'w')
-    for line in impl_lines:
-        f.write(line)
-    f.write(f'{header_comment}\n')
+# Writes the code reading the arguments from their slots.  A map takes two
+# slots, the List of its keys and the List of its values.
+def write_arguments(f, arguments: List[str], first_slot: int) -> List[str]:
+    arg_names=[]
+    index=first_slot
+    for argument in arguments:
+        argument = argument.strip().rsplit(' ', 1)
+        arg_type = argument[0]
+        arg_name = argument[1]
+        arg_names.append(arg_name)
+        container = container_type(arg_type)
+        if is_map(arg_type):
+            f.write(f'\t{arg_type} {arg_name} = SlotTraits<{container}>::get(vm, {index}, {index + 1});\n')
+            index+=1
+        elif container:
+            f.write(f'\t{arg_type} {arg_name} = SlotTraits<{container}>::get(vm, {index});\n')
+        elif foreign_object_type(arg_type):
+            f.write(f'\t{arg_type} {arg_name} = get_foreign_object<{foreign_object_type(arg_type)}>(vm, {index});\n')
+        elif arg_type in traits_types:
+            f.write(f'\t{arg_type} {arg_name} = SlotTraits<{traits_types[arg_type]}>::get(vm, {index});\n')
+        elif arg_type=='const Bytes&':
+            f.write(f'\tBytes {arg_name};\n')
+            f.write(f'\t{arg_name}.data = wrenGetSlotBytes(vm, {index}, &{arg_name}.length);\n')
+        elif arg_type=='int':
+            # Range checked, as casting NaN or a huge Num to int is undefined
+            f.write(f'\t{arg_type} {arg_name} = SlotTraits<int>::get(vm, {index});\n')
+        else:
+            f.write(f'\t{arg_type} {arg_name} = wrenGetSlot{type_to_slot(arg_type)}(vm, {index});\n')
+        index+=1
+    return arg_names
+
+def write_call(f, return_type: str, call: str):
+    if return_type == 'void':
+        f.write(f'\t{call};\n')
+        return
+    f.write(f'\t{return_type} result = {call};\n')
+    if container_type(return_type):
+        f.write(f'\tSlotTraits<{return_type}>::set(vm, 0, result);\n')
+    elif return_type in traits_types:
+        f.write(f'\tSlotTraits<{traits_types[return_type]}>::set(vm, 0, std::move(result));\n')
+    else:
+        result = 'result.c_str()' if return_type == 'std::string' else 'result'
+        f.write(f'\twrenSetSlot{type_to_slot(return_type)}(vm, 0, {result});\n')
+
+# The same try/catch as ForeignWrapper::call in utils/binder.h
+def write_guarded(f, body: str):
+    f.write('\ttry\n\t{\n')
+    for line in body.splitlines():
+        f.write(f'\t{line}\n')
+    f.write('\t}\n')
+    f.write('\tcatch (const std::exception& e)\n\t{\n')
+    f.write('\t\twrenSetSlotString(vm, 0, e.what());\n')
+    f.write('\t\twrenAbortFiber(vm, 0);\n')
+    f.write('\t}\n')
+
+# Plain values only, read from and written to a single slot each
+def is_batchable(return_type: str, arguments: List[str]) -> bool:
+    if not arguments:
+        return False
+    if return_type != 'void' and return_type not in type_slot_mapping:
+        return False
+    return all(argument.strip().rsplit(' ', 1)[0] in type_slot_mapping for argument in arguments)
+
+# A batch of numbers may also be given Buffers of doubles
+def is_numeric_batch(return_type: str, arguments: List[str]) -> bool:
+    numbers = ['int', 'double', 'bool']
+    if return_type != 'void' and return_type not in numbers:
+        return False
+    return all(argument.strip().rsplit(' ', 1)[0] in numbers for argument in arguments)
+
+# Splits on the commas outside template arguments
+def split_arguments(text: str) -> List[str]:
+    arguments=[]
+    depth=0
+    current=''
+    for c in text:
+        if c == ',' and depth == 0:
+            arguments.append(current)
+            current=''
+            continue
+        if c == '<':
+            depth+=1
+        elif c == '>':
+            depth-=1
+        current+=c
+    arguments.append(current)
+    return [s for s in arguments if s.strip()]
+
+# The parameters of the foreign method as Wren declares it, the expressions
+# a Wren method passes for them (a map becomes two Lists), and the arguments
+# that must be checked to be objects of a foreign class before native code
+# takes them as one.  The API can't tell foreign classes apart, so a Buffer
+# argument is checked as well.
+def wren_parameters(arguments: List[str]):
+    params=[]
+    values=[]
+    checks=[]
+    for argument in arguments:
+        arg_type, arg_name = argument.strip().rsplit(' ', 1)
+        if foreign_object_type(arg_type):
+            checks.append((arg_name, foreign_object_type(arg_type)))
+        elif arg_type in traits_types:
+            checks.append((arg_name, traits_types[arg_type]))
+        if is_map(arg_type):
+            params += [f'{arg_name}_keys', f'{arg_name}_values']
+            values += [f'{arg_name}.keys.toList', f'{arg_name}.values.toList']
+        else:
+            params.append(arg_name)
+            values.append(arg_name)
+    return params, values, checks
+
+def add_binding(key: str, wrapper_name: str):
+    if key in all_bindings:
+        raise RuntimeError(f'{key} is bound twice')
+    all_bindings[key] = wrapper_name
+
+# Static functions are bound as "module.Class.signature".  A class with a
+# constructor becomes a foreign class: its objects live in the Wren object's
+# foreign storage, and its other methods are bound as "module.Class#signature".
+#
+# With "//BIND batch", each static function taking and returning plain values
+# also gets Name_batch, which takes a List per argument and returns the List
+# of results, running the whole batch in one foreign call.
+def process_class(f, module_name: str, class_lines: List[str], options: List[str]):
     m = re.match(class_pattern, class_lines[0])
     if not m:
         print("Class pattern not found.  Ignoring")
         return
     class_name = m.group(1)
     print(f"Found class {class_name}")
-    func_mapping = {}
     code = []
+    constructor = None
+    ctor_pattern = class_name + r'\(([^)]*)\);'
     for line in class_lines[1:]:
-        m = re.match(func_pattern, line)
+        m = re.match(ctor_pattern, line)
         if m:
-            g = m.groups()
-            return_type = g[0]
-            func_name = g[1]
-            arguments = [s for s in g[2].split(',') if s]
-            prototype=f'{func_name}(' + ','.join(['_']*len(arguments)) + ')'
-            key = f'{module_name}.{class_name}.{prototype}'
-            print(f"Generating wrapper for {module_name}.{class_name}.{func_name}")
-            wrapper_name = f'{module_name}_{class_name}_{func_name}_wrapper'
-            func_mapping[key] = wrapper_name
-            f.write(f'\nvoid {wrapper_name}(WrenVM* vm)\n{{\n')
-            arg_names=[]
-            if len(arguments) > 0:
-                index=1
-                for argument in arguments:
-                    argument = argument.strip().rsplit(' ', 1)
-                    arg_type = argument[0]
-                    arg_name = argument[1]
-                    arg_names.append(arg_name)
-                    if arg_type=='const Bytes&':
-                        f.write(f'\tBytes {arg_name};\n')
-                        f.write(f'\t{arg_name}.data = wrenGetSlotBytes(vm, {index}, &{arg_name}.length);\n')
-                    else:
-                        casting_prefix=''
-                        castfix_suffix=''
-                        if arg_type=='int':
-                            casting_prefix='static_cast<int>('
-                            castfix_suffix=')'
-                        f.write(f'\t{arg_type} {arg_name} = {casting_prefix}wrenGetSlot{type_to_slot(arg_type)}(vm, {index}){castfix_suffix};\n')
-                    index+=1
-            code_line=f'\tforeign static {func_name}({', '.join(arg_names)})'
-            code.append(code_line)
-            call_prefix = ''
-            assign_result = ''
-            if return_type != 'void':
-                call_prefix = f'{return_type} result = '
-                result = 'result'
-                if return_type == 'std::string':
-                    result = 'result.c_str()'
-                assign_result = f'\twrenSetSlot{type_to_slot(return_type)}(vm, 0, {result});\n'
-            f.write(f'\t{call_prefix}{class_name}::{func_name}({','.join(arg_names)});\n')
-            if assign_result:
-                f.write(assign_result)
+            constructor = split_arguments(m.group(1))
+            continue
+        m = re.match(func_pattern, line)
+        is_static = m is not None
+        if not m:
+            m = re.match(method_pattern, line)
+        if not m:
+            continue
+        g = m.groups()
+        return_type = g[0]
+        func_name = g[1]
+        arguments = split_arguments(g[2])
+        params, values, checks = wren_parameters(arguments)
+        # Map and foreign object arguments go through a Wren method that
+        # splits or checks them
+        shim = params != values or len(checks) > 0
+        foreign_name = func_name + '_' if shim else func_name
+        prototype=f'{foreign_name}(' + ','.join(['_']*len(params)) + ')'
+        separator = '.' if is_static else '#'
+        print(f"Generating wrapper for {module_name}.{class_name}.{func_name}")
+        wrapper_name = f'{module_name}_{class_name}_{func_name}_wrapper'
+        add_binding(f'{module_name}.{class_name}{separator}{prototype}', wrapper_name)
+        f.write(f'\nvoid {wrapper_name}(WrenVM* vm)\n{{\n')
+        body = io.StringIO()
+        if not is_static:
+            body.write(f'\t{class_name}& self = get_foreign_object<{class_name}>(vm, 0);\n')
+        arg_names = write_arguments(body, arguments, 1)
+        if is_static:
+            write_call(body, return_type, f'{class_name}::{func_name}(' + ','.join(arg_names) + ')')
+        else:
+            write_call(body, return_type, f'self.{func_name}(' + ','.join(arg_names) + ')')
+        write_guarded(f, body.getvalue())
+        f.write('}\n')
+        static_prefix = 'static ' if is_static else ''
+        call = f'this.{foreign_name}(' + ', '.join(values) + ')'
+        if shim and checks:
+            code.append(f'\t{static_prefix}{func_name}(' + ', '.join(arg_names) + ') {')
+            for arg_name, arg_class in checks:
+                if arg_class == 'Buffer':
+                    buffer_modules.add(module_name)
+                code.append(f'\t\tif (!({arg_name} is {arg_class})) Fiber.abort("{arg_name} must be a {arg_class}.")')
+            code.append(f'\t\treturn {call}')
+            code.append('\t}')
+        elif shim:
+            code.append(f'\t{static_prefix}{func_name}(' + ', '.join(arg_names) + f') {{ {call} }}')
+        code.append(f'\tforeign {static_prefix}{foreign_name}(' + ', '.join(params) + ')')
+        if 'batch' in options and is_static and is_batchable(return_type, arguments):
+            batch_name = f'{func_name}_batch'
+            # Any foreign object would be taken for a Buffer of numbers, so
+            # those batches go through a Wren method that checks them
+            numeric = is_numeric_batch(return_type, arguments)
+            foreign_batch_name = batch_name + '_' if numeric else batch_name
+            batch_wrapper = f'{module_name}_{class_name}_{batch_name}_wrapper'
+            add_binding(f'{module_name}.{class_name}.{foreign_batch_name}(' + ','.join(['_']*len(arguments)) + ')', batch_wrapper)
+            f.write(f'\nvoid {batch_wrapper}(WrenVM* vm)\n{{\n')
+            f.write(f'\tforeign_batch_wrapper<&{class_name}::{func_name}>(vm);\n')
             f.write('}\n')
-    binder_name =f'{module_name}_{class_name}_Binder'
-    f.write(f'\n\nvoid {binder_name}()\n{{\n')
-    for key in func_mapping:
-        f.write(f'\tSingleton<ForeignFunctions>::Instance().bind("{key}", {func_mapping[key]});\n')
-    f.write(f'\tconst char* module_code=R"(\n')
-    f.write(f'class {class_name} {{\n')
-    for code_line in code:
-        f.write(f'{code_line}\n')
-    f.write('}\n')
-    f.write(f')";\n')
-    f.write(f'\tSingleton<ForeignFunctions>::Instance().set_module_code("{module_name}", module_code);\n')
-    f.write(f'}}\n\n')
-    all_initializers.append(f'{binder_name}')
+            if numeric:
+                buffer_modules.add(module_name)
+                code.append(f'\tstatic {batch_name}(' + ', '.join(arg_names) + ') {')
+                for arg_name in arg_names:
+                    code.append(f'\t\tif (!({arg_name} is List) && !({arg_name} is Buffer)) Fiber.abort("{arg_name} must be a List or a Buffer.")')
+                code.append(f'\t\treturn this.{foreign_batch_name}(' + ', '.join(arg_names) + ')')
+                code.append('\t}')
+            code.append(f'\tforeign static {foreign_batch_name}(' + ', '.join(arg_names) + ')')
+    if constructor is None:
+        class_code = f'class {class_name} {{\n'
+    else:
+        prefix = f'{module_name}_{class_name}'
+        f.write(f'\nvoid {prefix}_allocate(WrenVM* vm)\n{{\n')
+        if any(is_map(argument.strip().rsplit(' ', 1)[0]) for argument in constructor):
+            raise RuntimeError(f'{class_name}: a constructor cannot take a map')
+        body = io.StringIO()
+        arg_names = write_arguments(body, constructor, 1)
+        body.write(f'\tnew_foreign_object<{class_name}>(vm' + ''.join(f', {name}' for name in arg_names) + ');\n')
+        write_guarded(f, body.getvalue())
+        f.write('}\n')
+        f.write(f'\nvoid {prefix}_finalize(void* data)\n{{\n')
+        f.write(f'\tdelete_foreign_object<{class_name}>(data);\n')
+        f.write('}\n')
+        key = f'{module_name}.{class_name}'
+        if key in all_classes:
+            raise RuntimeError(f'{key} is bound twice')
+        all_classes[key] = prefix
+        class_code = f'foreign class {class_name} {{\n'
+        code.insert(0, '\tconstruct new(' + ', '.join(arg_names) + ') {}')
+    class_code += ''.join(f'{code_line}\n' for code_line in code) + '}\n'
+    all_module_code.setdefault(module_name, []).append(class_code)
+
+def process_header(header_path: str, module_name: str, classes):
+    impl_path = header_path.replace('.h', '.cpp')
+    impl_lines=[]
+    with open(impl_path) as f:
+        impl_lines = f.readlines()
+    for i in range(len(impl_lines)):
+        if impl_lines[i].startswith(header_comment):
+            impl_lines = impl_lines[0:i]
+            break
+    for class_lines, options in classes:
+        m = re.match(class_pattern, class_lines[0])
+        if m and any(re.match(m.group(1) + r'\(', line) for line in class_lines[1:]):
+            foreign_class_names.add(m.group(1))
+    with open(impl_path, 'w') as f:
+        for line in impl_lines:
+            f.write(line)
+        f.write(f'{header_comment}\n')
+        for class_lines, options in classes:
+            process_class(f, module_name, class_lines, options)
+
+def write_initializers(path: str):
+    # Python orders str by code point, which matches std::string_view for
+    # the ASCII names used here, so the static_assert below holds
+    keys = sorted(all_bindings)
+    class_keys = sorted(all_classes)
+    with open(path, 'w') as f:
+        f.write('#pragma once\n\n')
+        # Only the empty table of classes is a std::array
+        if not class_keys:
+            f.write('#include <array>\n')
+        f.write('#include <binder.h>\n\n')
+        for key in keys:
+            f.write(f'void {all_bindings[key]}(WrenVM* vm);\n')
+        for key in class_keys:
+            f.write(f'void {all_classes[key]}_allocate(WrenVM* vm);\n')
+            f.write(f'void {all_classes[key]}_finalize(void* data);\n')
+        f.write('\n// Sorted by name, searched with find_binding\n')
+        f.write('constexpr ForeignBinding foreign_bindings[] =\n{\n')
+        for key in keys:
+            f.write(f'\t{{ "{key}", {all_bindings[key]} }},\n')
+        f.write('};\n')
+        f.write('static_assert(is_sorted_bindings(foreign_bindings), "foreign_bindings must be sorted by name, without duplicates");\n\n')
+        if class_keys:
+            f.write('constexpr ForeignClassBinding foreign_classes[] =\n{\n')
+            for key in class_keys:
+                f.write(f'\t{{ "{key}", {all_classes[key]}_allocate, {all_classes[key]}_finalize }},\n')
+            f.write('};\n')
+        else:
+            f.write('constexpr std::array<ForeignClassBinding, 0> foreign_classes{};\n')
+        f.write('static_assert(is_sorted_bindings(foreign_classes), "foreign_classes must be sorted by name, without duplicates");\n\n')
+        f.write('constexpr ForeignModuleCode foreign_module_code[] =\n{\n')
+        for module_name, classes in all_module_code.items():
+            imports = 'import "buffer" for Buffer\n' if module_name in buffer_modules else ''
+            f.write(f'\t{{ "{module_name}", R"(\n' + imports + ''.join(classes) + ')" },\n')
+        f.write('};\n')
 
 def main(folder: str):
     headers = [f for f in os.listdir(folder) if f.endswith('.h')]
@@ -113,22 +348,22 @@ def main(folder: str):
         module_name = file.replace('.h', '')
         active=False
         lines = open(filepath, 'r').readlines()
+        classes=[]
         class_lines=[]
+        options=[]
         for line in lines:
             if active and line.startswith('};'):
                 active=False
-                process_class(filepath, module_name, class_lines)
+                classes.append((class_lines, options))
                 class_lines=[]
             if line.startswith('//BIND'):
                 active=True
+                options=line.split()[1:]
             elif active:
                 class_lines.append(line.strip())
-    with open(os.path.join(folder,'initializers.h'),'w') as f:
-        f.write('#pragma once\n\n')
-        f.write('void initialize_bindings()\n{\n')
-        for name in all_initializers:
-            f.write(f'\tvoid {name}();\n\t{name}();\n')
-        f.write('}\n\n')
+        if classes:
+            process_header(filepath, module_name, classes)
+    write_initializers(os.path.join(folder, 'initializers.h'))
 
 if __name__ == '__main__':
     argh.dispatch_command(main)
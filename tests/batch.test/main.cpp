@@ -0,0 +1,220 @@
+#include "buffermodule.h"
+#include <batch.h>
+#include <buffer.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+static double add(double a, double b) { return a + b; }
+static std::string twice(const std::string& text) { return text + text; }
+
+static int total = 0;
+static void accumulate(int value) { total += value; }
+
+static double inverse(double value) {
+    if (value == 0)
+        throw std::domain_error("Division by zero.");
+    return 1 / value;
+}
+
+// Opaque stands for any foreign class other than Buffer.  Math is what
+// generate_bindings.py writes for a "//BIND batch" class with add().
+static const char* math_module_code = R"(
+import "buffer" for Buffer
+foreign class Opaque {
+	construct new() {}
+}
+class Math {
+	static add_batch(a, b) {
+		if (!(a is List) && !(a is Buffer)) Fiber.abort("a must be a List or a Buffer.")
+		if (!(b is List) && !(b is Buffer)) Fiber.abort("b must be a List or a Buffer.")
+		return this.add_batch_(a, b)
+	}
+	foreign static add_batch_(a, b)
+}
+)";
+
+static void opaque_allocate(WrenVM* vm) {
+    wrenSetSlotNewForeign(vm, 0, 0, 1);
+}
+
+static std::string output;
+
+static WrenForeignMethodFn bind_method(WrenVM*, const char* module, const char* class_name, bool is_static, const char* signature) {
+    if (std::strcmp(module, BUFFER_MODULE) == 0)
+        return bind_buffer_method(class_name, is_static, signature);
+    if (std::strcmp(module, "math") == 0 && is_static && std::strcmp(signature, "add_batch_(_,_)") == 0)
+        return foreign_batch_wrapper<&add>;
+    return nullptr;
+}
+
+static WrenForeignClassMethods bind_class(WrenVM*, const char* module, const char* class_name) {
+    if (std::strcmp(module, BUFFER_MODULE) == 0)
+        return bind_buffer_class(class_name);
+    if (std::strcmp(module, "math") == 0 && std::strcmp(class_name, "Opaque") == 0)
+        return WrenForeignClassMethods{ opaque_allocate, nullptr };
+    return WrenForeignClassMethods{ nullptr, nullptr };
+}
+
+static void write(WrenVM*, const char* text) {
+    output += text;
+}
+
+// A VM with the buffer module loaded.  Batches are called the way Wren calls
+// them: arguments in slots 1..n, the result, or the message of an aborted
+// fiber, in slot 0.
+class BatchTest : public ::testing::Test {
+protected:
+    WrenVM* vm = nullptr;
+
+    void SetUp() override {
+        output.clear();
+        WrenConfiguration config;
+        wrenInitConfiguration(&config);
+        config.bindForeignMethodFn = bind_method;
+        config.bindForeignClassFn = bind_class;
+        config.writeFn = write;
+        vm = wrenNewVM(&config);
+        ASSERT_EQ(wrenInterpret(vm, BUFFER_MODULE, buffer_module_code), WREN_RESULT_SUCCESS);
+        wrenEnsureSlots(vm, 3);
+    }
+
+    void TearDown() override {
+        wrenFreeVM(vm);
+    }
+
+    void set_doubles(int slot, const std::vector<double>& values) {
+        Buffer buffer(values.size() * sizeof(double));
+        std::memcpy(buffer.data(), values.data(), buffer.size());
+        SlotTraits<Buffer>::set(vm, slot, buffer);
+    }
+
+    std::vector<double> get_doubles(int slot) {
+        const Buffer& buffer = SlotTraits<Buffer>::get(vm, slot);
+        std::vector<double> values(buffer.size() / sizeof(double));
+        std::memcpy(values.data(), buffer.data(), buffer.size());
+        return values;
+    }
+
+    std::string error() {
+        if (wrenGetSlotType(vm, 0) != WREN_TYPE_STRING)
+            return "";
+        return wrenGetSlotString(vm, 0);
+    }
+};
+
+TEST_F(BatchTest, Lists) {
+    SlotTraits<std::vector<double>>::set(vm, 1, { 1, 2, 3 });
+    SlotTraits<std::vector<double>>::set(vm, 2, { 10, 20, 30 });
+    foreign_batch_wrapper<&add>(vm);
+    EXPECT_EQ(SlotTraits<std::vector<double>>::get(vm, 0), (std::vector<double>{ 11, 22, 33 }));
+
+    SlotTraits<std::vector<std::string>>::set(vm, 1, { "a", "bc" });
+    foreign_batch_wrapper<&twice>(vm);
+    EXPECT_EQ(SlotTraits<std::vector<std::string>>::get(vm, 0), (std::vector<std::string>{ "aa", "bcbc" }));
+}
+
+TEST_F(BatchTest, Buffers) {
+    set_doubles(1, { 1, 2, 3 });
+    set_doubles(2, { 0.5, 0.25, 0.125 });
+    foreign_batch_wrapper<&add>(vm);
+    ASSERT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_FOREIGN);
+    EXPECT_EQ(get_doubles(0), (std::vector<double>{ 1.5, 2.25, 3.125 }));
+}
+
+TEST_F(BatchTest, VoidLeavesNull) {
+    total = 0;
+    SlotTraits<std::vector<double>>::set(vm, 1, { 1, 2, 3 });
+    foreign_batch_wrapper<&accumulate>(vm);
+    EXPECT_EQ(total, 6);
+    EXPECT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_NULL);
+
+    set_doubles(1, { 4, 5 });
+    foreign_batch_wrapper<&accumulate>(vm);
+    EXPECT_EQ(total, 15);
+    EXPECT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_NULL);
+}
+
+TEST_F(BatchTest, ScalarsAreRejected) {
+    wrenSetSlotDouble(vm, 1, 1);
+    wrenSetSlotDouble(vm, 2, 2);
+    foreign_batch_wrapper<&add>(vm);
+    EXPECT_EQ(error(), "Batch arguments must be Lists or Buffers.");
+
+    SlotTraits<std::vector<double>>::set(vm, 1, { 1 });
+    wrenSetSlotDouble(vm, 2, 2);
+    foreign_batch_wrapper<&add>(vm);
+    EXPECT_EQ(error(), "Batch arguments must be Lists or Buffers.");
+
+    wrenSetSlotString(vm, 1, "text");
+    foreign_batch_wrapper<&twice>(vm);
+    EXPECT_EQ(error(), "Batch arguments must be Lists.");
+}
+
+TEST_F(BatchTest, MixedAndMismatchedArguments) {
+    set_doubles(1, { 1, 2 });
+    SlotTraits<std::vector<double>>::set(vm, 2, { 1, 2 });
+    foreign_batch_wrapper<&add>(vm);
+    EXPECT_EQ(error(), "Batch arguments must be Lists or Buffers.");
+
+    set_doubles(1, { 1, 2 });
+    set_doubles(2, { 1 });
+    foreign_batch_wrapper<&add>(vm);
+    EXPECT_EQ(error(), "Batch arguments must have the same length.");
+
+    SlotTraits<std::vector<double>>::set(vm, 1, { 1, 2 });
+    SlotTraits<std::vector<double>>::set(vm, 2, { 1 });
+    foreign_batch_wrapper<&add>(vm);
+    EXPECT_EQ(error(), "Batch arguments must have the same length.");
+
+    // Only numeric batches take Buffers
+    set_doubles(1, { 1 });
+    foreign_batch_wrapper<&twice>(vm);
+    EXPECT_EQ(error(), "Batch arguments must be Lists.");
+}
+
+TEST_F(BatchTest, ExceptionAbortsTheFiber) {
+    SlotTraits<std::vector<double>>::set(vm, 1, { 1, 0 });
+    foreign_batch_wrapper<&inverse>(vm);
+    EXPECT_EQ(error(), "Division by zero.");
+}
+
+TEST_F(BatchTest, IntArgumentsAreRangeChecked) {
+    total = 0;
+    set_doubles(1, { 1, 1e300 });
+    foreign_batch_wrapper<&accumulate>(vm);
+    EXPECT_EQ(error(), "Number out of range for an integer argument.");
+
+    set_doubles(1, { std::nan("") });
+    foreign_batch_wrapper<&accumulate>(vm);
+    EXPECT_EQ(error(), "Number out of range for an integer argument.");
+}
+
+// Runs Wren code, so it needs the real VM
+TEST_F(BatchTest, Script) {
+    ASSERT_EQ(wrenInterpret(vm, "math", math_module_code), WREN_RESULT_SUCCESS);
+    ASSERT_EQ(wrenInterpret(vm, "main", R"(
+import "buffer" for Buffer
+import "math" for Math, Opaque
+System.print(Math.add_batch([1, 2], [3, 4]))
+System.print(Math.add_batch(Buffer.new(16), Buffer.new(16)).size)
+System.print(Fiber.new { Math.add_batch(Opaque.new(), Opaque.new()) }.try())
+System.print(Fiber.new { Math.add_batch(Buffer.new(8), Opaque.new()) }.try())
+System.print(Fiber.new { Math.add_batch(1, 2) }.try())
+)"), WREN_RESULT_SUCCESS) << output;
+    EXPECT_EQ(output,
+        "[4, 6]\n"
+        "16\n"
+        "a must be a List or a Buffer.\n"
+        "b must be a List or a Buffer.\n"
+        "a must be a List or a Buffer.\n");
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
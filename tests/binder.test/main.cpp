@@ -0,0 +1,245 @@
+#include <binder.h>
+#include <gtest/gtest.h>
+#include <cmath>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Calls wrappers the way Wren calls a foreign method: arguments in slots
+// 1..n, the result read back from slot 0
+class SlotsTest : public ::testing::Test {
+protected:
+    WrenVM* vm = nullptr;
+
+    void SetUp() override {
+        WrenConfiguration config;
+        wrenInitConfiguration(&config);
+        vm = wrenNewVM(&config);
+        wrenEnsureSlots(vm, 4);
+    }
+
+    void TearDown() override {
+        wrenFreeVM(vm);
+    }
+
+    std::string slot_string(int slot) {
+        int length = 0;
+        const char* bytes = wrenGetSlotBytes(vm, slot, &length);
+        return std::string(bytes, size_t(length));
+    }
+
+    void set_list(int slot, const std::vector<double>& values) {
+        int element = wrenGetSlotCount(vm);
+        wrenEnsureSlots(vm, element + 1);
+        wrenSetSlotNewList(vm, slot);
+        for (double value : values) {
+            wrenSetSlotDouble(vm, element, value);
+            wrenInsertInList(vm, slot, -1, element);
+        }
+    }
+
+    void set_list(int slot, const std::vector<std::string>& values) {
+        int element = wrenGetSlotCount(vm);
+        wrenEnsureSlots(vm, element + 1);
+        wrenSetSlotNewList(vm, slot);
+        for (const auto& value : values) {
+            wrenSetSlotString(vm, element, value.c_str());
+            wrenInsertInList(vm, slot, -1, element);
+        }
+    }
+};
+
+static double add(double a, double b) { return a + b; }
+static int half(int value) { return value / 2; }
+static bool negate(bool value) { return !value; }
+static const char* pick(bool first) { return first ? "first" : "second"; }
+static std::string join(const char* a, const std::string& b) { return std::string(a) + "," + b; }
+static int length(Bytes data) { return data.length; }
+static Bytes bytes_of(bool empty) { static const char text[] = "a\0b"; return { text, empty ? 0 : 3 }; }
+static std::vector<double> scaled(const std::vector<double>& values, double factor) {
+    std::vector<double> result;
+    for (double value : values)
+        result.push_back(value * factor);
+    return result;
+}
+static std::map<std::string, double> lengths(const std::vector<std::string>& words) {
+    std::map<std::string, double> result;
+    for (const auto& word : words)
+        result[word] = double(word.size());
+    return result;
+}
+
+static int calls = 0;
+static void count(int by) { calls += by; }
+
+static double checked_sqrt(double value) {
+    if (value < 0)
+        throw std::domain_error("value must not be negative");
+    return value;
+}
+
+TEST_F(SlotsTest, Numbers) {
+    wrenSetSlotDouble(vm, 1, 1.25);
+    wrenSetSlotDouble(vm, 2, 2.5);
+    foreign_wrapper<&add>(vm);
+    EXPECT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_NUM);
+    EXPECT_DOUBLE_EQ(wrenGetSlotDouble(vm, 0), 3.75);
+
+    // Truncated toward zero, as static_cast does
+    wrenSetSlotDouble(vm, 1, -7.9);
+    foreign_wrapper<&half>(vm);
+    EXPECT_DOUBLE_EQ(wrenGetSlotDouble(vm, 0), -3);
+}
+
+TEST_F(SlotsTest, Bool) {
+    wrenSetSlotBool(vm, 1, false);
+    foreign_wrapper<&negate>(vm);
+    EXPECT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_BOOL);
+    EXPECT_TRUE(wrenGetSlotBool(vm, 0));
+}
+
+TEST_F(SlotsTest, Strings) {
+    wrenSetSlotBool(vm, 1, false);
+    foreign_wrapper<&pick>(vm);
+    EXPECT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_STRING);
+    EXPECT_EQ(slot_string(0), "second");
+
+    wrenSetSlotString(vm, 1, "left");
+    wrenSetSlotString(vm, 2, "right");
+    foreign_wrapper<&join>(vm);
+    EXPECT_EQ(slot_string(0), "left,right");
+}
+
+TEST_F(SlotsTest, BytesKeepEmbeddedZeros) {
+    wrenSetSlotBytes(vm, 1, "x\0y\0", 4);
+    foreign_wrapper<&length>(vm);
+    EXPECT_DOUBLE_EQ(wrenGetSlotDouble(vm, 0), 4);
+
+    wrenSetSlotBool(vm, 1, false);
+    foreign_wrapper<&bytes_of>(vm);
+    EXPECT_EQ(slot_string(0), std::string("a\0b", 3));
+}
+
+TEST_F(SlotsTest, Lists) {
+    set_list(1, std::vector<double>{ 1, 2.5, -4 });
+    wrenSetSlotDouble(vm, 2, 2);
+    foreign_wrapper<&scaled>(vm);
+    ASSERT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_LIST);
+    ASSERT_EQ(wrenGetListCount(vm, 0), 3);
+    int element = wrenGetSlotCount(vm);
+    wrenEnsureSlots(vm, element + 1);
+    std::vector<double> values;
+    for (int i = 0; i < 3; ++i) {
+        wrenGetListElement(vm, 0, i, element);
+        values.push_back(wrenGetSlotDouble(vm, element));
+    }
+    EXPECT_EQ(values, (std::vector<double>{ 2, 5, -8 }));
+
+    set_list(1, std::vector<double>{});
+    foreign_wrapper<&scaled>(vm);
+    EXPECT_EQ(wrenGetListCount(vm, 0), 0);
+}
+
+TEST_F(SlotsTest, MapResult) {
+    set_list(1, std::vector<std::string>{ "one", "three", "one" });
+    foreign_wrapper<&lengths>(vm);
+    ASSERT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_MAP);
+    EXPECT_EQ(wrenGetMapCount(vm, 0), 2);
+    int key = wrenGetSlotCount(vm);
+    wrenEnsureSlots(vm, key + 2);
+    wrenSetSlotString(vm, key, "three");
+    ASSERT_TRUE(wrenGetMapContainsKey(vm, 0, key));
+    wrenGetMapValue(vm, 0, key, key + 1);
+    EXPECT_DOUBLE_EQ(wrenGetSlotDouble(vm, key + 1), 5);
+    wrenSetSlotString(vm, key, "two");
+    EXPECT_FALSE(wrenGetMapContainsKey(vm, 0, key));
+}
+
+TEST_F(SlotsTest, VoidLeavesTheResultAlone) {
+    calls = 0;
+    wrenSetSlotNull(vm, 0);
+    wrenSetSlotDouble(vm, 1, 3);
+    foreign_wrapper<&count>(vm);
+    foreign_wrapper<&count>(vm);
+    EXPECT_EQ(calls, 6);
+    EXPECT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_NULL);
+}
+
+TEST_F(SlotsTest, ExceptionAbortsTheFiber) {
+    // The message is left in slot 0, which wrenAbortFiber makes the
+    // fiber's error
+    wrenSetSlotDouble(vm, 1, -1);
+    foreign_wrapper<&checked_sqrt>(vm);
+    ASSERT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_STRING);
+    EXPECT_EQ(slot_string(0), "value must not be negative");
+
+    wrenSetSlotDouble(vm, 1, 9);
+    foreign_wrapper<&checked_sqrt>(vm);
+    EXPECT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_NUM);
+}
+
+TEST_F(SlotsTest, IntsAreRangeChecked) {
+    for (double value : { 3e9, -3e9, std::nan(""), HUGE_VAL }) {
+        wrenSetSlotDouble(vm, 1, value);
+        foreign_wrapper<&half>(vm);
+        ASSERT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_STRING);
+        EXPECT_EQ(slot_string(0), "Number out of range for an integer argument.");
+    }
+
+    wrenSetSlotDouble(vm, 1, 2147483647.5);
+    foreign_wrapper<&half>(vm);
+    EXPECT_DOUBLE_EQ(wrenGetSlotDouble(vm, 0), 1073741823);
+}
+
+TEST_F(SlotsTest, VectorRoundTrip) {
+    std::vector<std::string> words = { "a", "", std::string("b\0c", 3) };
+    SlotTraits<std::vector<std::string>>::set(vm, 1, words);
+    EXPECT_EQ(SlotTraits<std::vector<std::string>>::get(vm, 1), words);
+
+    std::vector<std::vector<double>> rows = { { 1, 2 }, {}, { 3 } };
+    SlotTraits<std::vector<std::vector<double>>>::set(vm, 1, rows);
+    EXPECT_EQ(wrenGetListCount(vm, 1), 3);
+    EXPECT_EQ(SlotTraits<std::vector<std::vector<double>>>::get(vm, 1), rows);
+}
+
+TEST_F(SlotsTest, MapRoundTrip) {
+    std::map<std::string, std::vector<double>> series = { { "x", { 1, 2 } }, { "y", {} } };
+    SlotTraits<std::map<std::string, std::vector<double>>>::set(vm, 1, series);
+    ASSERT_EQ(wrenGetSlotType(vm, 1), WREN_TYPE_MAP);
+    EXPECT_EQ(wrenGetMapCount(vm, 1), 2);
+    int key = wrenGetSlotCount(vm);
+    wrenEnsureSlots(vm, key + 2);
+    wrenSetSlotString(vm, key, "x");
+    wrenGetMapValue(vm, 1, key, key + 1);
+    EXPECT_EQ(SlotTraits<std::vector<double>>::get(vm, key + 1), (std::vector<double>{ 1, 2 }));
+
+    // As the generated Wren code passes a map: a List of keys and a List of values
+    SlotTraits<std::vector<std::string>>::set(vm, 1, { "x", "y" });
+    SlotTraits<std::vector<std::vector<double>>>::set(vm, 2, { { 1, 2 }, {} });
+    auto map = SlotTraits<std::map<std::string, std::vector<double>>>::get(vm, 1, 2);
+    EXPECT_EQ(map, series);
+}
+
+TEST_F(SlotsTest, NestingTakesOneScratchSlotPerLevel) {
+    std::vector<std::vector<std::vector<double>>> cube(50, std::vector<std::vector<double>>(20, { 1, 2, 3 }));
+    int before = wrenGetSlotCount(vm);
+    SlotTraits<decltype(cube)>::set(vm, 1, cube);
+    EXPECT_EQ(wrenGetSlotCount(vm), before + 3);
+    before = wrenGetSlotCount(vm);
+    EXPECT_EQ(SlotTraits<decltype(cube)>::get(vm, 1), cube);
+    EXPECT_EQ(wrenGetSlotCount(vm), before + 3);
+
+    std::map<std::string, std::vector<double>> series;
+    for (int i = 0; i < 50; ++i)
+        series[std::to_string(i)] = { double(i) };
+    before = wrenGetSlotCount(vm);
+    SlotTraits<decltype(series)>::set(vm, 1, series);
+    EXPECT_EQ(wrenGetSlotCount(vm), before + 3);
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
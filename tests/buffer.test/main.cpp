@@ -0,0 +1,55 @@
+#include "buffer.h"
+#include <gtest/gtest.h>
+
+TEST(BufferTest, ZeroFilled) {
+    Buffer buffer(16);
+    EXPECT_EQ(buffer.size(), 16);
+    for (size_t i = 0; i < buffer.size(); ++i)
+        EXPECT_EQ(buffer.data()[i], 0);
+}
+
+TEST(BufferTest, EmptyByDefault) {
+    Buffer buffer;
+    EXPECT_TRUE(buffer.empty());
+    EXPECT_EQ(buffer.data(), nullptr);
+}
+
+TEST(BufferTest, SliceSharesStorage) {
+    Buffer buffer(10);
+    Buffer view = buffer.slice(2, 4);
+    EXPECT_EQ(view.size(), 4);
+    EXPECT_EQ(view.data(), buffer.data() + 2);
+
+    view.data()[0] = 42;
+    EXPECT_EQ(buffer.data()[2], 42);
+}
+
+TEST(BufferTest, SliceIsClamped) {
+    Buffer buffer(10);
+    EXPECT_EQ(buffer.slice(8, 100).size(), 2);
+    EXPECT_EQ(buffer.slice(20, 5).size(), 0);
+    EXPECT_EQ(buffer.slice(3, 2).slice(1, 10).size(), 1);
+}
+
+TEST(BufferTest, StorageOutlivesOriginal) {
+    bool released = false;
+    Buffer view;
+    {
+        uint8_t* memory = new uint8_t[8]();
+        Buffer buffer(memory, 8, [&released](uint8_t* data) {
+            released = true;
+            delete[] data;
+        });
+        view = buffer.slice(4, 4);
+    }
+    EXPECT_FALSE(released);
+    view.data()[3] = 1;
+    view = Buffer();
+    EXPECT_TRUE(released);
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,228 @@
+#include "buffermodule.h"
+#include <buffer.h>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+
+static std::string output;
+
+static WrenForeignMethodFn bind_method(WrenVM*, const char* module, const char* class_name, bool is_static, const char* signature) {
+    return std::strcmp(module, BUFFER_MODULE) == 0 ? bind_buffer_method(class_name, is_static, signature) : nullptr;
+}
+
+static WrenForeignClassMethods bind_class(WrenVM*, const char* module, const char* class_name) {
+    if (std::strcmp(module, BUFFER_MODULE) == 0)
+        return bind_buffer_class(class_name);
+    return WrenForeignClassMethods{ nullptr, nullptr };
+}
+
+static void write(WrenVM*, const char* text) {
+    output += text;
+}
+
+static void report_error(WrenVM*, WrenErrorType, const char*, int, const char* message) {
+    if (message)
+        output += std::string("error: ") + message + "\n";
+}
+
+// A VM with the buffer module loaded.  The methods are called the way Wren
+// calls them: receiver or class in slot 0, arguments after it, and the
+// result, or the message of an aborted fiber, left in slot 0.
+class BufferModuleTest : public ::testing::Test {
+protected:
+    WrenVM* vm = nullptr;
+
+    void SetUp() override {
+        output.clear();
+        WrenConfiguration config;
+        wrenInitConfiguration(&config);
+        config.bindForeignMethodFn = bind_method;
+        config.bindForeignClassFn = bind_class;
+        config.writeFn = write;
+        config.errorFn = report_error;
+        vm = wrenNewVM(&config);
+        ASSERT_EQ(wrenInterpret(vm, BUFFER_MODULE, buffer_module_code), WREN_RESULT_SUCCESS);
+        wrenEnsureSlots(vm, 3);
+    }
+
+    void TearDown() override {
+        wrenFreeVM(vm);
+    }
+
+    void call(const char* signature, bool is_static = false) {
+        WrenForeignMethodFn method = bind_buffer_method("Buffer", is_static, signature);
+        ASSERT_NE(method, nullptr) << signature;
+        method(vm);
+    }
+
+    // Buffer.new(size), as the constructor's allocate sees it
+    void allocate() {
+        wrenGetVariable(vm, BUFFER_MODULE, "Buffer", 0);
+        bind_buffer_class("Buffer").allocate(vm);
+    }
+
+    void set_receiver(const Buffer& buffer) {
+        SlotTraits<Buffer>::set(vm, 0, buffer);
+    }
+
+    std::string error() {
+        if (wrenGetSlotType(vm, 0) != WREN_TYPE_STRING)
+            return "";
+        return wrenGetSlotString(vm, 0);
+    }
+
+    Buffer make(size_t size) {
+        wrenSetSlotDouble(vm, 1, double(size));
+        allocate();
+        return SlotTraits<Buffer>::get(vm, 0);
+    }
+};
+
+TEST_F(BufferModuleTest, AllocateChecksTheSize) {
+    const std::string message = "Buffer size must be a non-negative integer.";
+    wrenSetSlotDouble(vm, 1, -1);
+    allocate();
+    EXPECT_EQ(error(), message);
+    wrenSetSlotDouble(vm, 1, 1.5);
+    allocate();
+    EXPECT_EQ(error(), message);
+    wrenSetSlotDouble(vm, 1, double(size_t(1) << 41));
+    allocate();
+    EXPECT_EQ(error(), message);
+    wrenSetSlotString(vm, 1, "4");
+    allocate();
+    EXPECT_EQ(error(), message);
+
+    wrenSetSlotDouble(vm, 1, 4);
+    allocate();
+    ASSERT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_FOREIGN);
+    const Buffer& buffer = SlotTraits<Buffer>::get(vm, 0);
+    ASSERT_EQ(buffer.size(), 4u);
+    for (size_t i = 0; i < 4; ++i)
+        EXPECT_EQ(buffer.data()[i], 0);
+}
+
+TEST_F(BufferModuleTest, IndexingIsBoundsChecked) {
+    Buffer buffer = make(4);
+    set_receiver(buffer);
+    wrenSetSlotDouble(vm, 1, 3);
+    wrenSetSlotDouble(vm, 2, 200);
+    call("[_]=(_)");
+    EXPECT_DOUBLE_EQ(wrenGetSlotDouble(vm, 0), 200);
+    EXPECT_EQ(buffer.data()[3], 200);
+
+    set_receiver(buffer);
+    call("[_]");
+    EXPECT_DOUBLE_EQ(wrenGetSlotDouble(vm, 0), 200);
+
+    for (double index : { 4.0, -1.0, 0.5 }) {
+        set_receiver(buffer);
+        wrenSetSlotDouble(vm, 1, index);
+        call("[_]");
+        EXPECT_EQ(error(), "Index out of bounds.") << index;
+    }
+
+    set_receiver(buffer);
+    wrenSetSlotDouble(vm, 1, 0);
+    wrenSetSlotDouble(vm, 2, 256);
+    call("[_]=(_)");
+    EXPECT_EQ(error(), "Byte value must be an integer from 0 to 255.");
+    EXPECT_EQ(buffer.data()[0], 0);
+}
+
+TEST_F(BufferModuleTest, ReadOnlyBuffersRefuseWrites) {
+    static uint8_t bytes[] = { 1, 2, 3 };
+    Buffer buffer(bytes, sizeof(bytes), [](uint8_t*) {}, true);
+    set_receiver(buffer);
+    wrenSetSlotDouble(vm, 1, 0);
+    wrenSetSlotDouble(vm, 2, 9);
+    call("[_]=(_)");
+    EXPECT_EQ(error(), "Buffer is read-only.");
+    EXPECT_EQ(bytes[0], 1);
+
+    set_receiver(buffer);
+    wrenSetSlotDouble(vm, 1, 2);
+    call("[_]");
+    EXPECT_DOUBLE_EQ(wrenGetSlotDouble(vm, 0), 3);
+}
+
+TEST_F(BufferModuleTest, SlicesShareStorage) {
+    Buffer buffer = make(8);
+    set_receiver(buffer);
+    wrenSetSlotDouble(vm, 1, 2);
+    wrenSetSlotDouble(vm, 2, 4);
+    call("slice(_,_)");
+    ASSERT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_FOREIGN);
+    Buffer slice = SlotTraits<Buffer>::get(vm, 0);
+    EXPECT_EQ(slice.size(), 4u);
+    slice.data()[0] = 7;
+    EXPECT_EQ(buffer.data()[2], 7);
+
+    // Empty at the end is fine, past it is not
+    set_receiver(buffer);
+    wrenSetSlotDouble(vm, 1, 8);
+    wrenSetSlotDouble(vm, 2, 0);
+    call("slice(_,_)");
+    EXPECT_EQ(SlotTraits<Buffer>::get(vm, 0).size(), 0u);
+
+    set_receiver(buffer);
+    wrenSetSlotDouble(vm, 1, 9);
+    wrenSetSlotDouble(vm, 2, 0);
+    call("slice(_,_)");
+    EXPECT_EQ(error(), "Slice offset out of bounds.");
+
+    set_receiver(buffer);
+    wrenSetSlotDouble(vm, 1, 6);
+    wrenSetSlotDouble(vm, 2, 3);
+    call("slice(_,_)");
+    EXPECT_EQ(error(), "Slice length out of bounds.");
+}
+
+TEST_F(BufferModuleTest, StringRoundTrip) {
+    wrenGetVariable(vm, BUFFER_MODULE, "Buffer", 0);
+    wrenSetSlotBytes(vm, 1, "a\0b", 3);
+    call("fromString(_)", true);
+    ASSERT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_FOREIGN);
+    EXPECT_EQ(SlotTraits<Buffer>::get(vm, 0).size(), 3u);
+    call("toString");
+    int length = 0;
+    const char* bytes = wrenGetSlotBytes(vm, 0, &length);
+    EXPECT_EQ(std::string(bytes, size_t(length)), std::string("a\0b", 3));
+
+    wrenGetVariable(vm, BUFFER_MODULE, "Buffer", 0);
+    wrenSetSlotDouble(vm, 1, 3);
+    call("fromString(_)", true);
+    EXPECT_EQ(error(), "Text must be a string.");
+}
+
+// Runs Wren code, so it needs the real VM
+TEST_F(BufferModuleTest, Script) {
+    ASSERT_EQ(wrenInterpret(vm, "main", R"(
+import "buffer" for Buffer
+var b = Buffer.new(4)
+b[0] = 65
+System.print(b[0])
+System.print(Fiber.new { b[4] }.try())
+System.print(Fiber.new { b[0] = -1 }.try())
+System.print(Fiber.new { Buffer.new(-1) }.try())
+var s = b.slice(1, 2)
+s[0] = 66
+System.print(b[1])
+System.print(Fiber.new { b.slice(3, 2) }.try())
+System.print(Buffer.fromString("abc").slice(1, 2).toString)
+)"), WREN_RESULT_SUCCESS) << output;
+    EXPECT_EQ(output,
+        "65\n"
+        "Index out of bounds.\n"
+        "Byte value must be an integer from 0 to 255.\n"
+        "Buffer size must be a non-negative integer.\n"
+        "66\n"
+        "Slice length out of bounds.\n"
+        "bc\n");
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
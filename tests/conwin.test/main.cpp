@@ -0,0 +1,283 @@
+#include "conwin.h"
+#include "console.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+// Text presented on row y from column x, one byte per cell
+static std::string presented_text(const Console& console, int x, int y, int length)
+{
+    std::string text;
+    for (int i = 0; i < length; ++i) {
+        wchar_t ch;
+        ColorPair color;
+        if (!console.get_cell(x + i, y, ch, color))
+            break;
+        text += char(ch);
+    }
+    return text;
+}
+
+static ColorPair presented_color(const Console& console, int x, int y)
+{
+    wchar_t ch;
+    ColorPair color;
+    console.get_cell(x, y, ch, color);
+    return color;
+}
+
+static std::vector<xstring> numbered_lines(int count)
+{
+    std::vector<xstring> lines;
+    for (int i = 0; i < count; ++i)
+        lines.push_back("line " + std::to_string(i));
+    return lines;
+}
+
+// MemoryConsole Tests
+TEST(MemoryConsoleTest, Size) {
+    Console console(ConsoleBackend::Memory, 40, 10);
+    EXPECT_EQ(console.get_rect(), Rect(0, 0, 40, 10));
+    EXPECT_FALSE(console.update());
+    EXPECT_EQ(console.get_key(true), Key::None);
+}
+
+TEST(MemoryConsoleTest, PresentsOnlyChanges) {
+    Console console(ConsoleBackend::Memory, 20, 5);
+    console.draw_frame();
+    EXPECT_EQ(console.get_stats().cells, 100);
+
+    console.write_run(2, 1, "hello", ColorPair(Color::Yellow, Color::Black));
+    console.draw_frame();
+    EXPECT_EQ(console.get_stats().frames, 2);
+    EXPECT_EQ(console.get_stats().runs, 5 + 1);
+    EXPECT_EQ(console.get_stats().cells, 100 + 5);
+    EXPECT_EQ(presented_text(console, 2, 1, 5), "hello");
+    EXPECT_EQ(presented_color(console, 2, 1), ColorPair(Color::Yellow, Color::Black));
+
+    // Writing the same cells again presents nothing
+    console.write_run(2, 1, "hello", ColorPair(Color::Yellow, Color::Black));
+    console.draw_frame();
+    EXPECT_EQ(console.get_stats().cells, 100 + 5);
+}
+
+TEST(MemoryConsoleTest, Clipping) {
+    Console console(ConsoleBackend::Memory, 10, 2);
+    console.write_run(-2, 0, "abcdef", ColorPair());
+    console.write_run(7, 1, "xyz12", ColorPair());
+    console.fill(Rect(-5, -5, 100, 1), '#', ColorPair());
+    console.set_character(10, 0, '!', ColorPair());
+    console.draw_frame();
+    EXPECT_EQ(presented_text(console, 0, 0, 10), "cdef      ");
+    EXPECT_EQ(presented_text(console, 0, 1, 10), "       xyz");
+}
+
+// Window and Desktop Tests
+TEST(DesktopDrawTest, FrameTitleAndContent) {
+    Console console(ConsoleBackend::Memory, 30, 10);
+    Desktop desktop(console);
+    auto window = std::make_shared<Window>(Rect(0, 0, 30, 10));
+    window->set_title("Code");
+    window->set_content({ "first", "\tsecond" });
+    desktop.add_window(window);
+    desktop.draw(window);
+
+    wchar_t ch;
+    ColorPair color;
+    ASSERT_TRUE(console.get_cell(0, 0, ch, color));
+    EXPECT_EQ(ch, wchar_t(0x250F));
+    EXPECT_EQ(color, ColorPair(Color::White, Color::Cyan));
+    ASSERT_TRUE(console.get_cell(29, 9, ch, color));
+    EXPECT_EQ(ch, wchar_t(0x251B));
+    EXPECT_NE(presented_text(console, 0, 0, 30).find("Code"), std::string::npos);
+    EXPECT_EQ(presented_text(console, 1, 1, 7), "first  ");
+    EXPECT_EQ(presented_text(console, 1, 2, 10), "    second");
+}
+
+TEST(DesktopDrawTest, IdleRedrawPresentsNothing) {
+    Console console(ConsoleBackend::Memory, 40, 12);
+    Desktop desktop(console);
+    auto window = std::make_shared<Window>(Rect(0, 0, 40, 12));
+    window->set_content(numbered_lines(100));
+    desktop.add_window(window);
+    desktop.draw(window);
+
+    ConsoleStats before = console.get_stats();
+    desktop.draw(window);
+    EXPECT_EQ(console.get_stats().cells, before.cells);
+}
+
+TEST(DesktopDrawTest, HighlightStepRedrawsTwoRows) {
+    Console console(ConsoleBackend::Memory, 40, 12);
+    Desktop desktop(console);
+    auto window = std::make_shared<Window>(Rect(0, 0, 40, 12));
+    window->set_content(numbered_lines(100));
+    window->set_highlight_line(0);
+    desktop.add_window(window);
+    desktop.draw(window);
+
+    ConsoleStats before = console.get_stats();
+    window->change_highlight_line(1);
+    desktop.draw(window);
+    EXPECT_EQ(console.get_stats().runs - before.runs, 2);
+    EXPECT_EQ(console.get_stats().cells - before.cells, 2 * 38);
+    EXPECT_EQ(presented_color(console, 1, 2), ColorPair(Color::White, Color::Blue));
+    EXPECT_EQ(presented_color(console, 1, 1), ColorPair(Color::White, Color::Black));
+}
+
+TEST(DesktopDrawTest, HighlightScrollsIntoView) {
+    Console console(ConsoleBackend::Memory, 40, 12);
+    Desktop desktop(console);
+    auto window = std::make_shared<Window>(Rect(0, 0, 40, 12));
+    window->set_content(numbered_lines(100));
+    desktop.add_window(window);
+    desktop.draw(window);
+
+    // Centered in the 10 content rows
+    window->set_highlight_line(50);
+    desktop.draw(window);
+    EXPECT_EQ(presented_text(console, 1, 1, 7), "line 45");
+    EXPECT_EQ(presented_text(console, 1, 6, 7), "line 50");
+    EXPECT_EQ(presented_color(console, 1, 6), ColorPair(Color::White, Color::Blue));
+}
+
+TEST(DesktopDrawTest, StatusLine) {
+    Console console(ConsoleBackend::Memory, 40, 5);
+    Desktop desktop(console);
+    desktop.set_status_line("F5 Go");
+    desktop.draw(nullptr);
+    EXPECT_NE(presented_text(console, 0, 4, 40).find(" F5 Go "), std::string::npos);
+}
+
+TEST(DesktopDrawTest, ShorterStatusLineLeavesNothingBehind) {
+    Console console(ConsoleBackend::Memory, 40, 5);
+    Desktop desktop(console);
+    auto window = std::make_shared<Window>(Rect(0, 0, 40, 5));
+    desktop.add_window(window);
+    desktop.set_status_line("F3 Find | F4 Find in files | F5 Go");
+    desktop.draw(window);
+
+    desktop.set_status_line("Find: _");
+    desktop.draw(window);
+    std::string row = presented_text(console, 0, 4, 40);
+    EXPECT_NE(row.find(" Find: _ "), std::string::npos) << row;
+    EXPECT_EQ(row.find("F3"), std::string::npos) << row;
+    EXPECT_EQ(row.find("F5"), std::string::npos) << row;
+    // The border under the old status line is drawn again
+    EXPECT_EQ(presented_text(console, 2, 4, 1), presented_text(console, 38, 4, 1));
+
+    desktop.set_status_line("");
+    desktop.draw(window);
+    EXPECT_EQ(presented_text(console, 0, 4, 40).find("Find"), std::string::npos);
+}
+
+TEST(DesktopDrawTest, StatusLineWithoutWindowsIsBlanked) {
+    Console console(ConsoleBackend::Memory, 40, 5);
+    Desktop desktop(console);
+    desktop.set_status_line("a long status line");
+    desktop.draw(nullptr);
+    desktop.set_status_line("short");
+    desktop.draw(nullptr);
+    std::string row = presented_text(console, 0, 4, 40);
+    EXPECT_NE(row.find(" short "), std::string::npos) << row;
+    EXPECT_EQ(row.find("long"), std::string::npos) << row;
+    EXPECT_EQ(row.find("line"), std::string::npos) << row;
+}
+
+// Colors every digit red
+class DigitStyler : public LineStyler
+{
+    std::vector<StyleRun> m_Runs;
+public:
+    std::vector<size_t> styled_lines;
+
+    StyleRunRange style_line(size_t index, std::string_view text) override {
+        styled_lines.push_back(index);
+        m_Runs.clear();
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] >= '0' && text[i] <= '9')
+                m_Runs.push_back({ uint16_t(i), 1, Color::Red });
+        }
+        return { m_Runs.data(), m_Runs.data() + m_Runs.size() };
+    }
+
+    void invalidate(size_t /*first_line*/) override {}
+};
+
+TEST(DesktopDrawTest, LineStyler) {
+    Console console(ConsoleBackend::Memory, 20, 6);
+    Desktop desktop(console);
+    auto window = std::make_shared<Window>(Rect(0, 0, 20, 6));
+    auto styler = std::make_shared<DigitStyler>();
+    window->set_content(numbered_lines(100));
+    window->set_line_styler(styler);
+    window->set_highlight_line(0);
+    desktop.add_window(window);
+    desktop.draw(window);
+
+    // Only the visible rows are styled, and the highlighted one keeps its color
+    EXPECT_EQ(styler->styled_lines, std::vector<size_t>({ 1, 2, 3 }));
+    EXPECT_EQ(presented_text(console, 1, 2, 6), "line 1");
+    EXPECT_EQ(presented_color(console, 4, 2), ColorPair(Color::White, Color::Black));
+    EXPECT_EQ(presented_color(console, 6, 2), ColorPair(Color::Red, Color::Black));
+    EXPECT_EQ(presented_color(console, 6, 1), ColorPair(Color::White, Color::Blue));
+
+    // A step restyles just the two rows that changed
+    styler->styled_lines.clear();
+    window->change_highlight_line(1);
+    desktop.draw(window);
+    EXPECT_EQ(styler->styled_lines, std::vector<size_t>({ 0 }));
+    EXPECT_EQ(presented_color(console, 6, 1), ColorPair(Color::Red, Color::Black));
+
+    // Setting new content drops the styler
+    window->set_content(numbered_lines(3));
+    desktop.draw(window);
+    EXPECT_EQ(presented_color(console, 6, 3), ColorPair(Color::White, Color::Black));
+}
+
+// Gives its one window the left half of the desktop
+class HalfLayout : public ResizeListener
+{
+public:
+    WindowPtr window;
+    int calls = 0;
+
+    void on_resize(const Rect& desktop_rect) override {
+        ++calls;
+        window->set_rect(Rect(0, 0, desktop_rect.width / 2, desktop_rect.height));
+    }
+};
+
+TEST(DesktopDrawTest, ResizeLaysOutAgain) {
+    Console console(ConsoleBackend::Memory, 40, 10);
+    Desktop desktop(console);
+    HalfLayout layout;
+    layout.window = std::make_shared<Window>(Rect(0, 0, 20, 10));
+    layout.window->set_content(numbered_lines(5));
+    desktop.add_window(layout.window);
+    desktop.set_resize_listener(&layout);
+    desktop.draw(layout.window);
+    EXPECT_EQ(layout.calls, 0);
+
+    console.resize(60, 8);
+    desktop.draw(layout.window);
+    EXPECT_EQ(layout.calls, 1);
+    EXPECT_EQ(layout.window->get_border_rect(), Rect(0, 0, 30, 8));
+    wchar_t ch;
+    ColorPair color;
+    ASSERT_TRUE(console.get_cell(29, 7, ch, color));
+    EXPECT_EQ(ch, wchar_t(0x251B));
+    EXPECT_EQ(presented_text(console, 1, 1, 6), "line 0");
+    EXPECT_EQ(presented_text(console, 30, 3, 30), std::string(30, ' '));
+
+    // Same size again is not a resize
+    console.resize(60, 8);
+    desktop.draw(layout.window);
+    EXPECT_EQ(layout.calls, 1);
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,137 @@
+#include "fileio.h"
+#include <gtest/gtest.h>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace fs = std::filesystem;
+
+class FileIoTest : public ::testing::Test {
+protected:
+    fs::path dir;
+
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("fileio_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    std::string make_file(const std::string& name, const std::string& content) {
+        std::string path = (dir / name).string();
+        std::ofstream(path, std::ios::binary) << content;
+        return path;
+    }
+
+    static std::string text(const Buffer& buffer) {
+        return std::string(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    }
+};
+
+TEST_F(FileIoTest, ReadSmallFile) {
+    std::string path = make_file("small.txt", "hello\nworld");
+    EXPECT_EQ(text(read_file(path)), "hello\nworld");
+}
+
+TEST_F(FileIoTest, ReadEmptyFile) {
+    std::string path = make_file("empty.txt", "");
+    EXPECT_TRUE(read_file(path).empty());
+}
+
+TEST_F(FileIoTest, ReadLargeFile) {
+    std::string content(MAP_THRESHOLD * 3 + 17, 'x');
+    for (size_t i = 0; i < content.size(); i += 1000)
+        content[i] = char('a' + i % 26);
+    std::string path = make_file("large.bin", content);
+    Buffer buffer = read_file(path);
+    EXPECT_EQ(text(buffer), content);
+}
+
+TEST_F(FileIoTest, LargeFilesAreReadOnly) {
+    std::string path = make_file("large.bin", std::string(MAP_THRESHOLD * 2, 'x'));
+    EXPECT_TRUE(read_file(path).read_only());
+    EXPECT_TRUE(read_file(path).slice(10, 10).read_only());
+    path = make_file("small.bin", "x");
+    EXPECT_FALSE(read_file(path).read_only());
+}
+
+TEST_F(FileIoTest, ReadMissingFileThrows) {
+    try {
+        read_file((dir / "missing.txt").string());
+        FAIL() << "expected an exception";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find("missing.txt"), std::string::npos);
+    }
+    // Streams don't set errno, so the reason is looked up from the path
+    std::string reason = std::make_error_code(std::errc::no_such_file_or_directory).message();
+    try {
+        FileReader((dir / "missing.txt").string(), 8).read();
+        FAIL() << "expected an exception";
+    } catch (const std::runtime_error& e) {
+        EXPECT_NE(std::string(e.what()).find(reason), std::string::npos) << e.what();
+    }
+}
+
+TEST_F(FileIoTest, WriteThenRead) {
+    std::string path = (dir / "out.bin").string();
+    std::string content("a\0b", 3);
+    write_file(path, reinterpret_cast<const uint8_t*>(content.data()), content.size());
+    EXPECT_EQ(text(read_file(path)), content);
+    EXPECT_EQ(get_file_size(path), 3);
+
+    write_file(path, reinterpret_cast<const uint8_t*>("z"), 1);
+    EXPECT_EQ(text(read_file(path)), "z");
+}
+
+TEST_F(FileIoTest, WriteToMissingDirectoryThrows) {
+    std::string path = (dir / "no" / "such" / "file").string();
+    EXPECT_THROW(write_file(path, nullptr, 0), std::runtime_error);
+}
+
+TEST_F(FileIoTest, SizeOfMissingFileThrows) {
+    EXPECT_THROW(get_file_size((dir / "missing").string()), std::runtime_error);
+}
+
+TEST_F(FileIoTest, ListDirectoryIsSorted) {
+    make_file("b.txt", "");
+    make_file("a.txt", "");
+    fs::create_directory(dir / "c");
+    std::vector<std::string> names = list_directory(dir.string());
+    EXPECT_EQ(names, (std::vector<std::string>{ "a.txt", "b.txt", "c" }));
+    EXPECT_THROW(list_directory((dir / "missing").string()), std::runtime_error);
+}
+
+TEST_F(FileIoTest, ReaderReturnsChunks) {
+    std::string path = make_file("chunks.txt", "abcdefghij");
+    FileReader reader(path, 4);
+    EXPECT_EQ(text(reader.read()), "abcd");
+    EXPECT_EQ(text(reader.read()), "efgh");
+    EXPECT_EQ(text(reader.read()), "ij");
+    EXPECT_TRUE(reader.read().empty());
+    EXPECT_TRUE(reader.read().empty());
+}
+
+TEST_F(FileIoTest, ReaderOpensOnFirstRead) {
+    FileReader reader((dir / "later.txt").string(), 8);
+    make_file("later.txt", "made after the reader");
+    EXPECT_EQ(text(reader.read()), "made aft");
+    reader.close();
+    EXPECT_TRUE(reader.read().empty());
+}
+
+TEST_F(FileIoTest, ReaderOfMissingFileThrows) {
+    FileReader reader((dir / "missing.txt").string(), 8);
+    EXPECT_THROW(reader.read(), std::runtime_error);
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
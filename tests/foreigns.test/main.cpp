@@ -0,0 +1,109 @@
+#include "buffermodule.h"
+#include "foreigns.h"
+#include <buffer.h>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static std::string output;
+// Bindings Wren asked for and didn't get
+static std::vector<std::string> unbound;
+
+// Binds the way VMWrapper does, from the plugins' registry
+static WrenForeignMethodFn bind_method(WrenVM*, const char* module, const char* class_name, bool is_static, const char* signature) {
+    if (std::strcmp(module, BUFFER_MODULE) == 0)
+        return bind_buffer_method(class_name, is_static, signature);
+    std::string key = std::string(module) + "." + class_name + (is_static ? "." : "#") + signature;
+    WrenForeignMethodFn func = (WrenForeignMethodFn)find_foreign_method(key);
+    if (!func)
+        unbound.push_back(key);
+    return func;
+}
+
+static WrenForeignClassMethods bind_class(WrenVM*, const char* module, const char* class_name) {
+    if (std::strcmp(module, BUFFER_MODULE) == 0)
+        return bind_buffer_class(class_name);
+    WrenForeignClassMethods methods = { nullptr, nullptr };
+    std::string key = std::string(module) + "." + class_name;
+    if (!find_foreign_class(key, methods))
+        unbound.push_back(key);
+    return methods;
+}
+
+static void write(WrenVM*, const char* text) {
+    output += text;
+}
+
+static void report_error(WrenVM*, WrenErrorType, const char*, int, const char* message) {
+    if (message)
+        output += std::string("error: ") + message + "\n";
+}
+
+// A VM with the shapes plugin loaded by initialize_foreign_modules, whose
+// Initialize interprets the plugin's module code
+class ForeignsTest : public ::testing::Test {
+protected:
+    WrenVM* vm = nullptr;
+
+    void SetUp() override {
+        output.clear();
+        unbound.clear();
+        WrenConfiguration config;
+        wrenInitConfiguration(&config);
+        config.bindForeignMethodFn = bind_method;
+        config.bindForeignClassFn = bind_class;
+        config.writeFn = write;
+        config.errorFn = report_error;
+        vm = wrenNewVM(&config);
+        ASSERT_EQ(wrenInterpret(vm, BUFFER_MODULE, buffer_module_code), WREN_RESULT_SUCCESS);
+        initialize_foreign_modules(PLUGIN_DIR, vm);
+    }
+
+    void TearDown() override {
+        wrenFreeVM(vm);
+        shutdown_foreign_modules();
+    }
+};
+
+TEST_F(ForeignsTest, PluginBindingsAreFoundWhileItLoads) {
+    // Wren binds the foreign methods and classes of the module code as
+    // Initialize runs it, so none may be missing by then
+    EXPECT_TRUE(unbound.empty()) << unbound.front();
+    EXPECT_EQ(output, "");
+
+    WrenForeignClassMethods methods = { nullptr, nullptr };
+    ASSERT_TRUE(find_foreign_class("shapes.Shape", methods));
+    EXPECT_NE(methods.allocate, nullptr);
+    EXPECT_NE(methods.finalize, nullptr);
+    EXPECT_NE(find_foreign_method("shapes.Shape#Area()"), nullptr);
+    EXPECT_EQ(find_foreign_method("shapes.Shape.Area()"), nullptr);
+}
+
+TEST_F(ForeignsTest, CallsAPluginMethod) {
+    auto hypot = (WrenForeignMethodFn)find_foreign_method("shapes.Geometry.Hypot(_,_)");
+    ASSERT_NE(hypot, nullptr);
+    wrenEnsureSlots(vm, 3);
+    wrenSetSlotDouble(vm, 1, 3);
+    wrenSetSlotDouble(vm, 2, 4);
+    hypot(vm);
+    EXPECT_DOUBLE_EQ(wrenGetSlotDouble(vm, 0), 5);
+}
+
+// Runs Wren code, so it needs the real VM
+TEST_F(ForeignsTest, Script) {
+    ASSERT_EQ(wrenInterpret(vm, "main", R"(
+import "shapes" for Shape, Geometry
+var shape = Shape.new(2, 3)
+shape.Scale(2)
+System.print(shape.Area())
+System.print(Geometry.Hypot(3, 4))
+)"), WREN_RESULT_SUCCESS) << output;
+    EXPECT_EQ(output, "24\n5\n");
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
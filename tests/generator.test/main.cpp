@@ -0,0 +1,178 @@
+#include "shapes/initializers.h"
+#include "shapes/shapes.h"
+#include "plain_tables.h"
+#include "buffermodule.h"
+#include <buffer.h>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// shapes/ and plain/ are checked in as generate_bindings.py writes them, so
+// regenerating them after changing the generator shows what it now emits:
+//   python python/generate_bindings.py tests/generator.test/shapes
+//   python python/generate_bindings.py tests/generator.test/plain
+
+extern "C" void EnumerateClasses(EnumerateClassCallback callback, void* context);
+
+static WrenForeignMethodFn bind_method(WrenVM*, const char* module, const char* class_name, bool is_static, const char* signature) {
+    if (std::strcmp(module, BUFFER_MODULE) == 0)
+        return bind_buffer_method(class_name, is_static, signature);
+    std::string key = std::string(module) + "." + class_name + (is_static ? "." : "#") + signature;
+    return find_binding(foreign_bindings, key);
+}
+
+static WrenForeignClassMethods bind_class(WrenVM*, const char* module, const char* class_name) {
+    if (std::strcmp(module, BUFFER_MODULE) == 0)
+        return bind_buffer_class(class_name);
+    std::string key = std::string(module) + "." + class_name;
+    const ForeignClassBinding* binding = find_entry(std::begin(foreign_classes), std::end(foreign_classes), key);
+    if (!binding)
+        return WrenForeignClassMethods{ nullptr, nullptr };
+    return WrenForeignClassMethods{ binding->allocate, binding->finalize };
+}
+
+// A VM with the buffer and shapes modules loaded, whose wrappers are called the way Wren
+// calls them: receiver or class in slot 0, arguments after it
+class GeneratedTest : public ::testing::Test {
+protected:
+    WrenVM* vm = nullptr;
+
+    void SetUp() override {
+        WrenConfiguration config;
+        wrenInitConfiguration(&config);
+        config.bindForeignMethodFn = bind_method;
+        config.bindForeignClassFn = bind_class;
+        vm = wrenNewVM(&config);
+        ASSERT_EQ(wrenInterpret(vm, BUFFER_MODULE, buffer_module_code), WREN_RESULT_SUCCESS);
+        ASSERT_EQ(wrenInterpret(vm, foreign_module_code[0].module_name, foreign_module_code[0].code), WREN_RESULT_SUCCESS);
+        wrenEnsureSlots(vm, 4);
+    }
+
+    void TearDown() override {
+        wrenFreeVM(vm);
+    }
+
+    void call(const char* name) {
+        ForeignFunctions::wrapper wrapper = find_binding(foreign_bindings, name);
+        ASSERT_NE(wrapper, nullptr) << name;
+        wrapper(vm);
+    }
+};
+
+TEST_F(GeneratedTest, InstanceMethodsAreBoundWithHash) {
+    EXPECT_EQ(find_binding(foreign_bindings, "shapes.Shape#Area()"), &shapes_Shape_Area_wrapper);
+    EXPECT_EQ(find_binding(foreign_bindings, "shapes.Shape#Scale(_)"), &shapes_Shape_Scale_wrapper);
+    EXPECT_EQ(find_binding(foreign_bindings, "shapes.Shape.Count()"), &shapes_Shape_Count_wrapper);
+    EXPECT_EQ(find_binding(foreign_bindings, "shapes.Geometry.Hypot(_,_)"), &shapes_Geometry_Hypot_wrapper);
+    EXPECT_EQ(find_binding(foreign_bindings, "shapes.Geometry.Hypot_batch_(_,_)"), &shapes_Geometry_Hypot_batch_wrapper);
+    EXPECT_EQ(find_binding(foreign_bindings, "shapes.Shape.Area()"), nullptr);
+    EXPECT_EQ(find_binding(foreign_bindings, "shapes.Geometry#Hypot(_,_)"), nullptr);
+}
+
+TEST_F(GeneratedTest, ModuleCode) {
+    ASSERT_EQ(std::size(foreign_module_code), 1u);
+    EXPECT_STREQ(foreign_module_code[0].module_name, "shapes");
+    std::string code = foreign_module_code[0].code;
+    EXPECT_NE(code.find("foreign class Shape {\n\tconstruct new(width, height) {}\n\tforeign Area()\n"), std::string::npos) << code;
+    EXPECT_NE(code.find("\tforeign static Count()\n"), std::string::npos) << code;
+    EXPECT_NE(code.find("\nclass Geometry {\n\tforeign static Hypot(a, b)\n"), std::string::npos) << code;
+    // A batch of numbers checks its arguments, as any foreign object would
+    // pass for a Buffer
+    EXPECT_EQ(code.find("import \"buffer\" for Buffer\n"), 1u) << code;
+    EXPECT_NE(code.find("\tstatic Hypot_batch(a, b) {\n"
+                        "\t\tif (!(a is List) && !(a is Buffer)) Fiber.abort(\"a must be a List or a Buffer.\")\n"
+                        "\t\tif (!(b is List) && !(b is Buffer)) Fiber.abort(\"b must be a List or a Buffer.\")\n"
+                        "\t\treturn this.Hypot_batch_(a, b)\n"
+                        "\t}\n"
+                        "\tforeign static Hypot_batch_(a, b)\n"), std::string::npos) << code;
+}
+
+TEST_F(GeneratedTest, EnumerateClasses) {
+    struct Class {
+        std::string name;
+        WrenForeignClassMethods methods;
+    };
+    std::vector<Class> classes;
+    EnumerateClasses([](void* context, const char* name, WrenForeignClassMethods methods) {
+        static_cast<std::vector<Class>*>(context)->push_back({ name, methods });
+    }, &classes);
+    ASSERT_EQ(classes.size(), 1u);
+    EXPECT_EQ(classes[0].name, "shapes.Shape");
+    EXPECT_EQ(classes[0].methods.allocate, &shapes_Shape_allocate);
+    EXPECT_EQ(classes[0].methods.finalize, &shapes_Shape_finalize);
+}
+
+TEST_F(GeneratedTest, AllocateAndCallMethods) {
+    call("shapes.Shape.Count()");
+    double before = wrenGetSlotDouble(vm, 0);
+
+    wrenGetVariable(vm, "shapes", "Shape", 0);
+    wrenSetSlotDouble(vm, 1, 3);
+    wrenSetSlotDouble(vm, 2, 4);
+    shapes_Shape_allocate(vm);
+    ASSERT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_FOREIGN);
+    // Kept in a list, as slot 0 takes each method's result
+    wrenSetSlotNewList(vm, 3);
+    wrenInsertInList(vm, 3, -1, 0);
+
+    call("shapes.Shape.Count()");
+    EXPECT_DOUBLE_EQ(wrenGetSlotDouble(vm, 0), before + 1);
+
+    wrenGetListElement(vm, 3, 0, 0);
+    wrenSetSlotDouble(vm, 1, 2);
+    call("shapes.Shape#Scale(_)");
+    wrenGetListElement(vm, 3, 0, 0);
+    call("shapes.Shape#Area()");
+    EXPECT_DOUBLE_EQ(wrenGetSlotDouble(vm, 0), 48);
+}
+
+TEST_F(GeneratedTest, ConstructorErrorAbortsTheFiber) {
+    wrenGetVariable(vm, "shapes", "Shape", 0);
+    wrenSetSlotDouble(vm, 1, -1);
+    wrenSetSlotDouble(vm, 2, 4);
+    shapes_Shape_allocate(vm);
+    ASSERT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_STRING);
+    EXPECT_STREQ(wrenGetSlotString(vm, 0), "Sizes must not be negative.");
+}
+
+TEST_F(GeneratedTest, ObjectsLiveInTheForeignStorage) {
+    int before = Shape::Count();
+    wrenGetVariable(vm, "shapes", "Shape", 0);
+    wrenSetSlotDouble(vm, 1, 2);
+    wrenSetSlotDouble(vm, 2, 3);
+    shapes_Shape_allocate(vm);
+    ASSERT_EQ(wrenGetSlotType(vm, 0), WREN_TYPE_FOREIGN);
+    void* data = wrenGetSlotForeign(vm, 0);
+    EXPECT_EQ(static_cast<Shape*>(data)->Area(), 6);
+    EXPECT_EQ(Shape::Count(), before + 1);
+    shapes_Shape_finalize(data);
+    EXPECT_EQ(Shape::Count(), before);
+}
+
+TEST_F(GeneratedTest, FailedConstructionIsNotDestroyed) {
+    int before = Shape::Count();
+    wrenGetVariable(vm, "shapes", "Shape", 0);
+    EXPECT_THROW(new_foreign_object<Shape>(vm, -1.0, 4.0), std::invalid_argument);
+    // Wren still finalizes the object it made for the Shape
+    shapes_Shape_finalize(wrenGetSlotForeign(vm, 0));
+    EXPECT_EQ(Shape::Count(), before);
+}
+
+TEST_F(GeneratedTest, ModuleWithoutClasses) {
+    EXPECT_EQ(plain_class_count(), 0u);
+    ForeignFunctions::wrapper repeat = plain_binding("plain.Text.Repeat(_,_)");
+    ASSERT_NE(repeat, nullptr);
+    wrenSetSlotString(vm, 1, "ab");
+    wrenSetSlotDouble(vm, 2, 3);
+    repeat(vm);
+    EXPECT_STREQ(wrenGetSlotString(vm, 0), "ababab");
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <array>
+#include <binder.h>
+
+void plain_Text_Repeat_wrapper(WrenVM* vm);
+
+// Sorted by name, searched with find_binding
+constexpr ForeignBinding foreign_bindings[] =
+{
+	{ "plain.Text.Repeat(_,_)", plain_Text_Repeat_wrapper },
+};
+static_assert(is_sorted_bindings(foreign_bindings), "foreign_bindings must be sorted by name, without duplicates");
+
+constexpr std::array<ForeignClassBinding, 0> foreign_classes{};
+static_assert(is_sorted_bindings(foreign_classes), "foreign_classes must be sorted by name, without duplicates");
+
+constexpr ForeignModuleCode foreign_module_code[] =
+{
+	{ "plain", R"(
+class Text {
+	foreign static Repeat(text, count)
+}
+)" },
+};
@@ -0,0 +1,30 @@
+#include <wren.hpp>
+#include <binder.h>
+#include "plain.h"
+
+std::string Text::Repeat(const char* text, int count)
+{
+	std::string result;
+	for (int i = 0; i < count; ++i)
+		result += text;
+	return result;
+}
+
+//////////////////////////////////////////////////
+//AUTOGENERATED CODE - DO NOT EDIT
+
+void plain_Text_Repeat_wrapper(WrenVM* vm)
+{
+	try
+	{
+		const char* text = wrenGetSlotString(vm, 1);
+		int count = SlotTraits<int>::get(vm, 2);
+		std::string result = Text::Repeat(text,count);
+		wrenSetSlotString(vm, 0, result.c_str());
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
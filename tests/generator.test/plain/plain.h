@@ -0,0 +1,11 @@
+#pragma once
+
+#include <string>
+#include <binder.h>
+
+//BIND
+class Text
+{
+public:
+	static std::string Repeat(const char* text, int count);
+};
@@ -0,0 +1,12 @@
+#include "plain/initializers.h"
+#include "plain_tables.h"
+
+size_t plain_class_count()
+{
+	return foreign_classes.size();
+}
+
+ForeignFunctions::wrapper plain_binding(std::string_view name)
+{
+	return find_binding(foreign_bindings, name);
+}
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <binder.h>
+
+// The tables of plain/initializers.h, which can't share a translation unit
+// with those of shapes/
+size_t plain_class_count();
+ForeignFunctions::wrapper plain_binding(std::string_view name);
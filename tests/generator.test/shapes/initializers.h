@@ -0,0 +1,50 @@
+#pragma once
+
+#include <binder.h>
+
+void shapes_Geometry_Hypot_wrapper(WrenVM* vm);
+void shapes_Geometry_Hypot_batch_wrapper(WrenVM* vm);
+void shapes_Shape_Area_wrapper(WrenVM* vm);
+void shapes_Shape_Scale_wrapper(WrenVM* vm);
+void shapes_Shape_Count_wrapper(WrenVM* vm);
+void shapes_Shape_allocate(WrenVM* vm);
+void shapes_Shape_finalize(void* data);
+
+// Sorted by name, searched with find_binding
+constexpr ForeignBinding foreign_bindings[] =
+{
+	{ "shapes.Geometry.Hypot(_,_)", shapes_Geometry_Hypot_wrapper },
+	{ "shapes.Geometry.Hypot_batch_(_,_)", shapes_Geometry_Hypot_batch_wrapper },
+	{ "shapes.Shape#Area()", shapes_Shape_Area_wrapper },
+	{ "shapes.Shape#Scale(_)", shapes_Shape_Scale_wrapper },
+	{ "shapes.Shape.Count()", shapes_Shape_Count_wrapper },
+};
+static_assert(is_sorted_bindings(foreign_bindings), "foreign_bindings must be sorted by name, without duplicates");
+
+constexpr ForeignClassBinding foreign_classes[] =
+{
+	{ "shapes.Shape", shapes_Shape_allocate, shapes_Shape_finalize },
+};
+static_assert(is_sorted_bindings(foreign_classes), "foreign_classes must be sorted by name, without duplicates");
+
+constexpr ForeignModuleCode foreign_module_code[] =
+{
+	{ "shapes", R"(
+import "buffer" for Buffer
+foreign class Shape {
+	construct new(width, height) {}
+	foreign Area()
+	foreign Scale(factor)
+	foreign static Count()
+}
+class Geometry {
+	foreign static Hypot(a, b)
+	static Hypot_batch(a, b) {
+		if (!(a is List) && !(a is Buffer)) Fiber.abort("a must be a List or a Buffer.")
+		if (!(b is List) && !(b is Buffer)) Fiber.abort("b must be a List or a Buffer.")
+		return this.Hypot_batch_(a, b)
+	}
+	foreign static Hypot_batch_(a, b)
+}
+)" },
+};
@@ -0,0 +1,126 @@
+#include <cmath>
+#include <stdexcept>
+#include <wren.hpp>
+#include <singleton.h>
+#include <batch.h>
+#include <binder.h>
+#include "shapes.h"
+
+Shape::Shape(double width, double height)
+	: m_Width(width)
+	, m_Height(height)
+{
+	if (width < 0 || height < 0)
+		throw std::invalid_argument("Sizes must not be negative.");
+}
+
+double Shape::Area() const
+{
+	return m_Width * m_Height;
+}
+
+void Shape::Scale(double factor)
+{
+	m_Width *= factor;
+	m_Height *= factor;
+}
+
+int LiveShapes::count = 0;
+
+int Shape::Count()
+{
+	return LiveShapes::count;
+}
+
+double Geometry::Hypot(double a, double b)
+{
+	return std::hypot(a, b);
+}
+
+//////////////////////////////////////////////////
+//AUTOGENERATED CODE - DO NOT EDIT
+
+void shapes_Shape_Area_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Shape& self = get_foreign_object<Shape>(vm, 0);
+		double result = self.Area();
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void shapes_Shape_Scale_wrapper(WrenVM* vm)
+{
+	try
+	{
+		Shape& self = get_foreign_object<Shape>(vm, 0);
+		double factor = wrenGetSlotDouble(vm, 1);
+		self.Scale(factor);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void shapes_Shape_Count_wrapper(WrenVM* vm)
+{
+	try
+	{
+		int result = Shape::Count();
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void shapes_Shape_allocate(WrenVM* vm)
+{
+	try
+	{
+		double width = wrenGetSlotDouble(vm, 1);
+		double height = wrenGetSlotDouble(vm, 2);
+		new_foreign_object<Shape>(vm, width, height);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void shapes_Shape_finalize(void* data)
+{
+	delete_foreign_object<Shape>(data);
+}
+
+void shapes_Geometry_Hypot_wrapper(WrenVM* vm)
+{
+	try
+	{
+		double a = wrenGetSlotDouble(vm, 1);
+		double b = wrenGetSlotDouble(vm, 2);
+		double result = Geometry::Hypot(a,b);
+		wrenSetSlotDouble(vm, 0, result);
+	}
+	catch (const std::exception& e)
+	{
+		wrenSetSlotString(vm, 0, e.what());
+		wrenAbortFiber(vm, 0);
+	}
+}
+
+void shapes_Geometry_Hypot_batch_wrapper(WrenVM* vm)
+{
+	foreign_batch_wrapper<&Geometry::Hypot>(vm);
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include <binder.h>
+
+// Counts the live Shapes, so tests can see objects being finalized
+struct LiveShapes
+{
+	static int count;
+	LiveShapes() { ++count; }
+	LiveShapes(const LiveShapes&) { ++count; }
+	~LiveShapes() { --count; }
+};
+
+//BIND
+class Shape
+{
+	LiveShapes m_Live;
+	double m_Width;
+	double m_Height;
+public:
+	Shape(double width, double height);
+	double Area() const;
+	void Scale(double factor);
+	static int Count();
+};
+
+//BIND batch
+class Geometry
+{
+public:
+	static double Hypot(double a, double b);
+};
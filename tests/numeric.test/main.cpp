@@ -0,0 +1,92 @@
+#include "kernels.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Every kernel table must agree with the scalar one, on lengths that leave
+// tails after the vector loops
+static std::vector<const NumericKernels*> all_kernels() {
+    std::vector<const NumericKernels*> kernels = { &get_scalar_kernels() };
+    if (get_avx2_kernels())
+        kernels.push_back(get_avx2_kernels());
+    return kernels;
+}
+
+static std::vector<double> values(size_t n, double seed) {
+    std::vector<double> v(n);
+    for (size_t i = 0; i < n; ++i)
+        v[i] = std::sin(seed + double(i)) * 100.0;
+    return v;
+}
+
+static const size_t lengths[] = { 0, 1, 3, 4, 7, 8, 9, 31, 1000 };
+
+TEST(NumericKernelsTest, DispatchPicksAvailableKernels) {
+    const NumericKernels& kernels = get_kernels();
+    if (get_avx2_kernels())
+        EXPECT_EQ(&kernels, get_avx2_kernels());
+    else
+        EXPECT_EQ(&kernels, &get_scalar_kernels());
+}
+
+TEST(NumericKernelsTest, ElementWise) {
+    for (const NumericKernels* k : all_kernels()) {
+        for (size_t n : lengths) {
+            std::vector<double> a = values(n, 1), b = values(n, 2), c = values(n, 3);
+            std::vector<double> sum = a, product = a, fused = a;
+            k->add(sum.data(), b.data(), n);
+            k->mul(product.data(), b.data(), n);
+            k->fma(fused.data(), b.data(), c.data(), n);
+            for (size_t i = 0; i < n; ++i) {
+                EXPECT_DOUBLE_EQ(sum[i], a[i] + b[i]) << k->name << " n=" << n;
+                EXPECT_DOUBLE_EQ(product[i], a[i] * b[i]) << k->name << " n=" << n;
+                EXPECT_NEAR(fused[i], a[i] * b[i] + c[i], 1e-9) << k->name << " n=" << n;
+            }
+        }
+    }
+}
+
+TEST(NumericKernelsTest, Reductions) {
+    const NumericKernels& scalar = get_scalar_kernels();
+    for (const NumericKernels* k : all_kernels()) {
+        for (size_t n : lengths) {
+            std::vector<double> a = values(n, 4), b = values(n, 5);
+            EXPECT_NEAR(k->sum(a.data(), n), scalar.sum(a.data(), n), 1e-9) << k->name << " n=" << n;
+            EXPECT_NEAR(k->dot(a.data(), b.data(), n), scalar.dot(a.data(), b.data(), n), 1e-6) << k->name << " n=" << n;
+            if (n == 0)
+                continue;
+            EXPECT_EQ(k->min(a.data(), n), *std::min_element(a.begin(), a.end())) << k->name << " n=" << n;
+            EXPECT_EQ(k->max(a.data(), n), *std::max_element(a.begin(), a.end())) << k->name << " n=" << n;
+        }
+    }
+}
+
+TEST(NumericKernelsTest, PrefixSum) {
+    for (const NumericKernels* k : all_kernels()) {
+        for (size_t n : lengths) {
+            std::vector<double> a = values(n, 6);
+            std::vector<double> expected = a;
+            for (size_t i = 1; i < n; ++i)
+                expected[i] += expected[i - 1];
+            k->prefix_sum(a.data(), n);
+            for (size_t i = 0; i < n; ++i)
+                EXPECT_NEAR(a[i], expected[i], 1e-9) << k->name << " n=" << n << " i=" << i;
+        }
+    }
+}
+
+TEST(NumericKernelsTest, PrefixSumOfOnes) {
+    for (const NumericKernels* k : all_kernels()) {
+        std::vector<double> a(13, 1.0);
+        k->prefix_sum(a.data(), a.size());
+        for (size_t i = 0; i < a.size(); ++i)
+            EXPECT_EQ(a[i], double(i + 1)) << k->name;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
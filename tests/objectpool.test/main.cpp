@@ -0,0 +1,82 @@
+#include "objectpool.h"
+#include <gtest/gtest.h>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+struct Tracked {
+    static int alive;
+    std::string name;
+    explicit Tracked(std::string n) : name(std::move(n)) { ++alive; }
+    ~Tracked() { --alive; }
+};
+int Tracked::alive = 0;
+
+struct Throwing {
+    explicit Throwing(bool fail) {
+        if (fail) throw std::runtime_error("constructor failed");
+    }
+};
+
+TEST(ObjectPoolTest, CreateAndDestroy) {
+    ObjectPool<Tracked, 4> pool;
+    Tracked* a = pool.create("a");
+    Tracked* b = pool.create("b");
+    EXPECT_EQ(a->name, "a");
+    EXPECT_EQ(b->name, "b");
+    EXPECT_EQ(pool.size(), 2);
+    EXPECT_EQ(Tracked::alive, 2);
+
+    pool.destroy(a);
+    EXPECT_EQ(pool.size(), 1);
+    EXPECT_EQ(Tracked::alive, 1);
+    pool.destroy(b);
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(ObjectPoolTest, ReusesFreedSlots) {
+    ObjectPool<Tracked, 4> pool;
+    Tracked* a = pool.create("a");
+    pool.destroy(a);
+    Tracked* b = pool.create("b");
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(pool.capacity(), 4);
+    pool.destroy(b);
+}
+
+TEST(ObjectPoolTest, GrowsBySlabs) {
+    ObjectPool<Tracked, 4> pool;
+    std::vector<Tracked*> objects;
+    std::set<Tracked*> distinct;
+    for (int i = 0; i < 10; ++i) {
+        objects.push_back(pool.create(std::to_string(i)));
+        distinct.insert(objects.back());
+    }
+    EXPECT_EQ(distinct.size(), 10);
+    EXPECT_EQ(pool.capacity(), 12);
+    for (int i = 0; i < 10; ++i)
+        EXPECT_EQ(objects[i]->name, std::to_string(i));
+    for (auto* object : objects)
+        pool.destroy(object);
+    EXPECT_EQ(pool.size(), 0);
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+TEST(ObjectPoolTest, ThrowingConstructorKeepsSlotFree) {
+    ObjectPool<Throwing, 2> pool;
+    EXPECT_THROW(pool.create(true), std::runtime_error);
+    EXPECT_EQ(pool.size(), 0);
+    Throwing* a = pool.create(false);
+    Throwing* b = pool.create(false);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(pool.capacity(), 2);
+    pool.destroy(a);
+    pool.destroy(b);
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,113 @@
+#include "outputbuffer.h"
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+static std::vector<std::string> lines_of(const OutputBuffer& buffer)
+{
+    std::vector<std::string> lines;
+    for (size_t i = 0; i < buffer.get_line_count(); ++i)
+        lines.push_back(buffer.get_line(i));
+    return lines;
+}
+
+class OutputBufferTest : public ::testing::Test {
+protected:
+    fs::path spill;
+
+    void SetUp() override {
+        spill = fs::temp_directory_path() / ("outputbuffer_test_" + std::to_string(::testing::UnitTest::GetInstance()->random_seed()) + ".txt");
+        fs::remove(spill);
+    }
+
+    void TearDown() override {
+        fs::remove(spill);
+    }
+
+    std::string spilled() const {
+        std::ifstream f(spill);
+        std::ostringstream os;
+        os << f.rdbuf();
+        return os.str();
+    }
+};
+
+TEST_F(OutputBufferTest, AssemblesLines) {
+    OutputBuffer buffer(10);
+    buffer.write("a");
+    buffer.write("b\nc\n");
+    buffer.write("\n");
+    EXPECT_EQ(lines_of(buffer), (std::vector<std::string>{ "ab", "c", "" }));
+}
+
+TEST_F(OutputBufferTest, KeepsTheLastLinesPastCapacity) {
+    OutputBuffer buffer(3);
+    for (int i = 0; i < 8; ++i)
+        buffer.write(("line " + std::to_string(i) + "\n").c_str());
+    EXPECT_EQ(lines_of(buffer), (std::vector<std::string>{ "line 5", "line 6", "line 7" }));
+}
+
+TEST_F(OutputBufferTest, EvictedLinesSpillInOrder) {
+    {
+        OutputBuffer buffer(2);
+        ASSERT_TRUE(buffer.set_spill_file(spill.string()));
+        buffer.write("1\n2\n3\n4\n");
+        EXPECT_EQ(lines_of(buffer), (std::vector<std::string>{ "3", "4" }));
+        buffer.write("5\n");
+        EXPECT_EQ(lines_of(buffer), (std::vector<std::string>{ "4", "5" }));
+    }
+    // The kept lines follow at exit
+    EXPECT_EQ(spilled(), "1\n2\n3\n4\n5\n");
+}
+
+TEST_F(OutputBufferTest, PendingLineIsTheLastLine) {
+    OutputBuffer buffer(2);
+    buffer.write("a\nb\npartial");
+    EXPECT_EQ(buffer.get_line_count(), 3);
+    EXPECT_EQ(lines_of(buffer), (std::vector<std::string>{ "a", "b", "partial" }));
+    buffer.write(" line\n");
+    EXPECT_EQ(lines_of(buffer), (std::vector<std::string>{ "b", "partial line" }));
+}
+
+TEST_F(OutputBufferTest, PendingLineIsFlushedOnExit) {
+    {
+        OutputBuffer buffer(4);
+        ASSERT_TRUE(buffer.set_spill_file(spill.string()));
+        buffer.write("kept\nno newline");
+    }
+    EXPECT_EQ(spilled(), "kept\nno newline\n");
+}
+
+TEST_F(OutputBufferTest, LongLinesAreWrapped) {
+    const size_t max = OutputBuffer::MAX_LINE_LENGTH;
+    OutputBuffer buffer(10);
+    std::string text(max * 2 + 5, 'x');
+    // In pieces, as a script printing without newlines writes it
+    for (size_t i = 0; i < text.size(); i += 1000)
+        buffer.write(text.substr(i, 1000).c_str());
+    std::vector<std::string> lines = lines_of(buffer);
+    ASSERT_EQ(lines.size(), 3);
+    EXPECT_EQ(lines[0].size(), max);
+    EXPECT_EQ(lines[1].size(), max);
+    EXPECT_EQ(lines[2], "xxxxx");
+
+    // A newline right at the limit doesn't add an empty line
+    OutputBuffer exact(10);
+    exact.write(std::string(max, 'y').c_str());
+    exact.write("\nz\n");
+    lines = lines_of(exact);
+    ASSERT_EQ(lines.size(), 2);
+    EXPECT_EQ(lines[0].size(), max);
+    EXPECT_EQ(lines[1], "z");
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,114 @@
+#include "outputsink.h"
+#include <gtest/gtest.h>
+#include <cerrno>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+
+// A pipe whose read end never blocks, big enough for everything a test
+// writes, so what reached it can be read at any point
+struct Pipe {
+    int read_fd = -1;
+    int write_fd = -1;
+
+    Pipe() {
+        int fds[2];
+        if (pipe(fds) != 0)
+            return;
+        read_fd = fds[0];
+        write_fd = fds[1];
+        fcntl(read_fd, F_SETFL, fcntl(read_fd, F_GETFL) | O_NONBLOCK);
+#ifdef F_SETPIPE_SZ
+        fcntl(write_fd, F_SETPIPE_SZ, int(OutputSink::BUFFER_SIZE * 4));
+#endif
+    }
+
+    ~Pipe() {
+        close(read_fd);
+        close(write_fd);
+    }
+
+    // Everything written since the last call
+    std::string read_all() {
+        std::string text;
+        char chunk[4096];
+        for (;;) {
+            ssize_t n = read(read_fd, chunk, sizeof(chunk));
+            if (n > 0)
+                text.append(chunk, size_t(n));
+            else if (n < 0 && errno == EINTR)
+                continue;
+            else
+                return text;
+        }
+    }
+};
+
+// The sink is a singleton, pointed at a fresh pipe for each test and back
+// at stdout afterwards
+class OutputSinkTest : public ::testing::Test {
+protected:
+    OutputSink& sink = Singleton<OutputSink>::Instance();
+    Pipe pipe;
+
+    void SetUp() override {
+        ASSERT_GE(pipe.write_fd, 0);
+        sink.set_fd(pipe.write_fd);
+    }
+
+    void TearDown() override {
+        sink.set_fd(1);
+    }
+};
+
+TEST_F(OutputSinkTest, FlushesWhenTheBufferFills) {
+    std::string fill(OutputSink::BUFFER_SIZE - 1, 'a');
+    sink.write(fill.c_str());
+    sink.write("b");
+    // Exactly full is still buffered
+    EXPECT_EQ(pipe.read_all(), "");
+
+    sink.write("c");
+    EXPECT_EQ(pipe.read_all(), fill + "b");
+    sink.flush();
+    EXPECT_EQ(pipe.read_all(), "c");
+}
+
+TEST_F(OutputSinkTest, BigWritesGoStraightToTheFd) {
+    std::string big(OutputSink::BUFFER_SIZE + 1, 'x');
+    sink.write("before ");
+    sink.write(big.c_str());
+    // What was buffered goes first, and nothing is left
+    EXPECT_EQ(pipe.read_all(), "before " + big);
+    sink.flush();
+    EXPECT_EQ(pipe.read_all(), "");
+}
+
+TEST_F(OutputSinkTest, SetFdFlushesToTheOldFd) {
+    Pipe other;
+    ASSERT_GE(other.write_fd, 0);
+    sink.write("first");
+    sink.set_fd(other.write_fd);
+    EXPECT_EQ(pipe.read_all(), "first");
+
+    sink.write("second");
+    sink.flush();
+    EXPECT_EQ(other.read_all(), "second");
+    EXPECT_EQ(pipe.read_all(), "");
+    sink.set_fd(pipe.write_fd);
+}
+
+TEST_F(OutputSinkTest, FlushIsIdempotent) {
+    sink.write("once");
+    sink.flush();
+    sink.flush();
+    EXPECT_EQ(pipe.read_all(), "once");
+    sink.flush();
+    EXPECT_EQ(pipe.read_all(), "");
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -0,0 +1,139 @@
+#include "instrumenter.h"
+#include "policy.h"
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+
+namespace fs = std::filesystem;
+
+static InstrumentationPolicy& policy() {
+    return Singleton<InstrumentationPolicy>::Instance();
+}
+
+TEST(PolicyTest, DefaultIsFull) {
+    policy().load_json("{}");
+    EXPECT_EQ(policy().get_mode("main"), InstrumentationMode::Full);
+    EXPECT_EQ(policy().get_mode("lib/util"), InstrumentationMode::Full);
+}
+
+TEST(PolicyTest, FirstMatchingRuleWins) {
+    policy().load_json(R"({
+        "default": "coverage",
+        "modules": [
+            { "pattern": "lib/**", "mode": "none" },
+            { "pattern": "lib/special", "mode": "full" },
+            { "pattern": "util_*", "mode": "profile" }
+        ]
+    })");
+    EXPECT_EQ(policy().get_mode("lib/special"), InstrumentationMode::None);
+    EXPECT_EQ(policy().get_mode("lib/deep/module"), InstrumentationMode::None);
+    EXPECT_EQ(policy().get_mode("util_math"), InstrumentationMode::Profile);
+    EXPECT_EQ(policy().get_mode("sub/util_math"), InstrumentationMode::Coverage);
+    EXPECT_EQ(policy().get_mode("main"), InstrumentationMode::Coverage);
+}
+
+TEST(PolicyTest, ReportPath) {
+    policy().load_json(R"({ "report": "counts.txt" })");
+    EXPECT_EQ(policy().get_report_path(), "counts.txt");
+}
+
+TEST(PolicyTest, BadPolicyThrows) {
+    EXPECT_THROW(policy().load_json(R"({ "default": "sometimes" })"), std::runtime_error);
+    EXPECT_THROW(policy().load_json(R"({ "modules": [ { "pattern": "x" } ] })"), std::runtime_error);
+}
+
+// Modules are read from the working directory, so each test writes its
+// scripts to a directory of its own
+class InstrumenterTest : public ::testing::Test {
+protected:
+    fs::path previous;
+    fs::path dir;
+
+    void SetUp() override {
+        previous = fs::current_path();
+        dir = fs::temp_directory_path() / ("policy_test_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        fs::remove_all(dir);
+        fs::create_directories(dir / "lib");
+        fs::current_path(dir);
+        policy().load_json(R"({
+            "default": "full",
+            "modules": [
+                { "pattern": "lib/**", "mode": "none" },
+                { "pattern": "counted", "mode": "coverage" },
+                { "pattern": "entered", "mode": "profile" }
+            ]
+        })");
+    }
+
+    void TearDown() override {
+        fs::current_path(previous);
+        fs::remove_all(dir);
+    }
+
+    static std::string load(const std::string& name, const std::string& source) {
+        std::ofstream(name + ".wren") << source;
+        std::unique_ptr<const char[]> code(load_module_code(name.c_str()));
+        return code ? std::string(code.get()) : std::string();
+    }
+
+    static size_t count(const std::string& text, const std::string& part) {
+        size_t n = 0;
+        for (size_t at = text.find(part); at != std::string::npos; at = text.find(part, at + 1))
+            ++n;
+        return n;
+    }
+};
+
+static const char* script =
+    "class Shape {\n"
+    "\tarea(scale) {\n"
+    "\t\tvar width = 2\n"
+    "\t\treturn width * scale\n"
+    "\t}\n"
+    "\tstatic name() {\n"
+    "\t\treturn \"shape\"\n"
+    "\t}\n"
+    "}\n";
+
+TEST_F(InstrumenterTest, FullStepsEveryMethodLine) {
+    std::string code = load("full", script);
+    EXPECT_EQ(code.find("import \"gubed\" for Gubedder"), 0);
+    // Every line inside a method body, closing braces included: three in
+    // area, two in name
+    EXPECT_EQ(count(code, "Gubedder.callback("), 5);
+    EXPECT_EQ(count(code, "Gubedder.hit("), 0);
+    // Variables in scope are passed to the debugger
+    EXPECT_NE(code.find("\"width=\"+width.toString"), std::string::npos);
+}
+
+TEST_F(InstrumenterTest, CoverageCountsEveryMethodLine) {
+    std::string code = load("counted", script);
+    EXPECT_EQ(count(code, "Gubedder.hit("), 5);
+    EXPECT_EQ(count(code, "Gubedder.callback("), 0);
+}
+
+TEST_F(InstrumenterTest, ProfileCountsMethodEntries) {
+    std::string code = load("entered", script);
+    EXPECT_EQ(count(code, "Gubedder.hit("), 2);
+    EXPECT_EQ(count(code, "Gubedder.callback("), 0);
+}
+
+TEST_F(InstrumenterTest, ExcludedModuleIsUnchanged) {
+    std::string code = load("lib/vendor", script);
+    EXPECT_EQ(code, script);
+}
+
+TEST_F(InstrumenterTest, MissingModule) {
+    std::unique_ptr<const char[]> code(load_module_code("missing"));
+    EXPECT_EQ(code, nullptr);
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
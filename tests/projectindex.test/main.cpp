@@ -0,0 +1,168 @@
+#include "projectindex.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace fs = std::filesystem;
+
+// Polls until done returns true, for at most a few seconds
+static bool wait_until(const std::function<bool()>& done) {
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+    while (!done()) {
+        if (std::chrono::steady_clock::now() > deadline)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+// The lines of each module that contain text, found the slow way
+static std::vector<ProjectIndex::Hit> reference_search(const std::map<std::string, std::string>& modules,
+                                                       const std::string& text) {
+    std::vector<ProjectIndex::Hit> hits;
+    for (const auto& [module, source] : modules) {
+        size_t start = 0;
+        for (size_t index = 0; start <= source.size(); ++index) {
+            size_t end = source.find('\n', start);
+            if (end == std::string::npos)
+                end = source.size();
+            std::string line = source.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r')
+                line.pop_back();
+            if (line.find(text) != std::string::npos)
+                hits.push_back({ module, index, line });
+            start = end + 1;
+        }
+    }
+    return hits;
+}
+
+static void expect_hits(const std::vector<ProjectIndex::Hit>& actual, const std::vector<ProjectIndex::Hit>& expected) {
+    ASSERT_EQ(actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i) {
+        EXPECT_EQ(actual[i].module, expected[i].module) << i;
+        EXPECT_EQ(actual[i].line_index, expected[i].line_index) << i;
+        EXPECT_EQ(actual[i].line, expected[i].line) << i;
+    }
+}
+
+class ProjectIndexTest : public ::testing::Test {
+protected:
+    fs::path dir;
+    std::map<std::string, std::string> modules;
+
+    void SetUp() override {
+        dir = fs::temp_directory_path() / ("projectindex_test_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        fs::remove_all(dir);
+        fs::create_directories(dir);
+    }
+
+    void TearDown() override {
+        fs::remove_all(dir);
+    }
+
+    void write(const std::string& module, const std::string& source) {
+        fs::path path = dir / (module + ".wren");
+        fs::create_directories(path.parent_path());
+        std::ofstream(path, std::ios::binary) << source;
+        modules[module] = source;
+    }
+
+    static void wait_ready(const ProjectIndex& index) {
+        ASSERT_TRUE(wait_until([&] { return index.is_ready(); }));
+    }
+};
+
+TEST_F(ProjectIndexTest, FindsModulesBelowTheRoot) {
+    write("main", "import \"lib/util\"\n");
+    write("lib/util", "class Util {}\n");
+    std::ofstream(dir / "notes.txt") << "class Util {}\n";
+    ProjectIndex index(dir);
+    wait_ready(index);
+    auto found = index.get_modules();
+    ASSERT_EQ(found.size(), 2u);
+    EXPECT_EQ(found[0].module, "lib/util");
+    EXPECT_EQ(found[1].module, "main");
+    expect_hits(index.search("class", 100), { { "lib/util", 0, "class Util {}" } });
+}
+
+TEST_F(ProjectIndexTest, OffsetsMapToLines) {
+    // Matches at the very start and end, on a CRLF line, and several on one line
+    write("a", "start\nfoo bar foo\r\n\nlast foo");
+    ProjectIndex index(dir);
+    wait_ready(index);
+    expect_hits(index.search("start", 100), { { "a", 0, "start" } });
+    expect_hits(index.search("foo", 100), { { "a", 1, "foo bar foo" }, { "a", 3, "last foo" } });
+    expect_hits(index.search("last foo", 100), { { "a", 3, "last foo" } });
+    expect_hits(index.search("foo\r", 100), { { "a", 1, "foo bar foo" } });
+    EXPECT_TRUE(index.search("missing", 100).empty());
+    EXPECT_TRUE(index.search("", 100).empty());
+    EXPECT_EQ(index.search("foo", 1).size(), 1u);
+}
+
+TEST_F(ProjectIndexTest, MatchesTheReferenceSearch) {
+    // Few distinct bytes, so the SIMD filter sees many candidates, and files
+    // of every length around the 16 byte blocks
+    std::mt19937 random(42);
+    const char alphabet[] = "abcab ba\n";
+    for (int n = 0; n < 64; ++n) {
+        std::string source;
+        size_t length = n < 48 ? size_t(n) : random() % 4096;
+        for (size_t i = 0; i < length; ++i)
+            source += alphabet[random() % (sizeof(alphabet) - 1)];
+        write("m" + std::to_string(100 + n), source);
+    }
+    ProjectIndex index(dir);
+    wait_ready(index);
+    for (const char* text : { "a", "ab", "ba", "cab", "abcab", "b a", "aaaa", "cc", "abcabcabcabcabcabc" })
+        expect_hits(index.search(text, size_t(-1)), reference_search(modules, text));
+}
+
+// Counts the change notifications from the background thread
+class CountingListener : public ProjectIndex::Listener {
+public:
+    std::atomic<int> changes{ 0 };
+    void on_project_changed() override { ++changes; }
+};
+
+TEST_F(ProjectIndexTest, ChangesAreRescanned) {
+    write("main", "var a = 1\n");
+    CountingListener listener;
+    ProjectIndex index(dir, &listener);
+    wait_ready(index);
+    auto lines_with = [&](const char* text) { return index.search(text, 100).size(); };
+
+    // Created, also in a new directory
+    int changes = listener.changes;
+    write("added", "var needle = 1\n");
+    write("sub/deeper", "// needle\n");
+    EXPECT_TRUE(wait_until([&] { return lines_with("needle") == 2; }));
+    EXPECT_GT(listener.changes, changes);
+
+    // Modified
+    write("added", "var other = 1\nvar needle = 2\nneedle\n");
+    EXPECT_TRUE(wait_until([&] { return lines_with("needle") == 3; }));
+    expect_hits(index.search("other", 100), { { "added", 0, "var other = 1" } });
+
+    // Deleted
+    fs::remove(dir / "added.wren");
+    EXPECT_TRUE(wait_until([&] { return lines_with("needle") == 1; }));
+    EXPECT_EQ(index.get_modules().size(), 2u);
+    fs::remove_all(dir / "sub");
+    EXPECT_TRUE(wait_until([&] { return lines_with("needle") == 0; }));
+    EXPECT_EQ(index.get_modules().size(), 1u);
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
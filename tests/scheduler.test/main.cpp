@@ -0,0 +1,122 @@
+#include "buffermodule.h"
+#include "jobsmodule.h"
+#include "scheduler.h"
+#include <buffer.h>
+#include <gtest/gtest.h>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+static std::string output;
+
+// A job that fails for negative numbers, waited for like Jobs.hash
+static const char* work_module_code = R"(
+import "jobs" for Scheduler
+
+class Work {
+	static square(x) {
+		square_(Fiber.current, x)
+		return Scheduler.runNextScheduled_()
+	}
+
+	foreign static square_(fiber, x)
+}
+)";
+
+static void work_square(WrenVM* vm) {
+    double x = wrenGetSlotDouble(vm, 2);
+    Singleton<Scheduler>::Instance().submit(vm, 1, [x]() -> Scheduler::Deliver {
+        if (x < 0)
+            throw std::runtime_error("x must not be negative");
+        return [x](WrenVM* vm, int slot) { wrenSetSlotDouble(vm, slot, x * x); };
+    });
+}
+
+static WrenForeignMethodFn bind_method(WrenVM*, const char* module, const char* class_name, bool is_static, const char* signature) {
+    if (std::strcmp(module, BUFFER_MODULE) == 0)
+        return bind_buffer_method(class_name, is_static, signature);
+    if (std::strcmp(module, JOBS_MODULE) == 0)
+        return bind_jobs_method(class_name, is_static, signature);
+    if (std::strcmp(module, "work") == 0 && is_static && std::strcmp(signature, "square_(_,_)") == 0)
+        return work_square;
+    return nullptr;
+}
+
+static WrenForeignClassMethods bind_class(WrenVM*, const char* module, const char* class_name) {
+    if (std::strcmp(module, BUFFER_MODULE) == 0)
+        return bind_buffer_class(class_name);
+    return WrenForeignClassMethods{ nullptr, nullptr };
+}
+
+static void write(WrenVM*, const char* text) {
+    output += text;
+}
+
+static void report_error(WrenVM*, WrenErrorType type, const char*, int, const char* message) {
+    if (type == WREN_ERROR_RUNTIME)
+        output += std::string("error: ") + message + "\n";
+}
+
+// A VM with the modules gubed loads, run the way VMWrapper runs a script:
+// interpret until the fibers wait, then let the scheduler resume them.
+// Runs Wren code, so it needs the real VM.
+class SchedulerTest : public ::testing::Test {
+protected:
+    WrenVM* vm = nullptr;
+
+    void SetUp() override {
+        output.clear();
+        WrenConfiguration config;
+        wrenInitConfiguration(&config);
+        config.bindForeignMethodFn = bind_method;
+        config.bindForeignClassFn = bind_class;
+        config.writeFn = write;
+        config.errorFn = report_error;
+        vm = wrenNewVM(&config);
+        ASSERT_EQ(wrenInterpret(vm, BUFFER_MODULE, buffer_module_code), WREN_RESULT_SUCCESS);
+        ASSERT_EQ(wrenInterpret(vm, JOBS_MODULE, jobs_module_code), WREN_RESULT_SUCCESS);
+        ASSERT_EQ(wrenInterpret(vm, "work", work_module_code), WREN_RESULT_SUCCESS);
+    }
+
+    void TearDown() override {
+        Singleton<Scheduler>::Instance().shutdown(vm);
+        wrenFreeVM(vm);
+    }
+};
+
+TEST_F(SchedulerTest, JobFiberRunsToCompletion) {
+    ASSERT_EQ(wrenInterpret(vm, "main", R"wren(
+import "jobs" for Scheduler
+import "work" for Work
+Scheduler.add {
+	System.print("scheduled %(Work.square(4))")
+}
+System.print("main %(Work.square(3))")
+System.print("main done")
+)wren"), WREN_RESULT_SUCCESS) << output;
+    // Both fibers wait for their jobs
+    EXPECT_EQ(output, "");
+
+    Singleton<Scheduler>::Instance().run(vm);
+    EXPECT_NE(output.find("scheduled 16\n"), std::string::npos) << output;
+    EXPECT_NE(output.find("main 9\nmain done\n"), std::string::npos) << output;
+}
+
+TEST_F(SchedulerTest, FailedJobIsAnErrorOfTheFiber) {
+    ASSERT_EQ(wrenInterpret(vm, "main", R"(
+import "work" for Work
+System.print("before")
+Work.square(-1)
+System.print("not reached")
+)"), WREN_RESULT_SUCCESS) << output;
+
+    // Resumed with transferError, so the fiber fails with the job's message
+    EXPECT_THROW(Singleton<Scheduler>::Instance().run(vm), std::runtime_error);
+    EXPECT_EQ(output, "before\nerror: x must not be negative\n");
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
@@ -151,6 +151,34 @@ TEST(TrimTest, MixedWhitespace) {
     EXPECT_EQ(trim(" \t\n\r\f\vtext \t\n\r\f\v"), "text");
 }
 
+// GlobMatch Tests
+TEST(GlobMatchTest, Literal) {
+    EXPECT_TRUE(glob_match("main", "main"));
+    EXPECT_FALSE(glob_match("main", "mainx"));
+    EXPECT_FALSE(glob_match("main", "mai"));
+}
+
+TEST(GlobMatchTest, Star) {
+    EXPECT_TRUE(glob_match("util_*", "util_math"));
+    EXPECT_TRUE(glob_match("*", ""));
+    EXPECT_TRUE(glob_match("*_test", "parser_test"));
+    EXPECT_FALSE(glob_match("util_*", "lib/util_math"));
+    EXPECT_FALSE(glob_match("lib/*", "lib/core/list"));
+}
+
+TEST(GlobMatchTest, DoubleStar) {
+    EXPECT_TRUE(glob_match("lib/**", "lib/core/list"));
+    EXPECT_TRUE(glob_match("**/util_*", "lib/core/util_math"));
+    EXPECT_TRUE(glob_match("**/util_*", "util_math"));
+    EXPECT_FALSE(glob_match("lib/**", "app/main"));
+}
+
+TEST(GlobMatchTest, QuestionMark) {
+    EXPECT_TRUE(glob_match("mod?", "mod1"));
+    EXPECT_FALSE(glob_match("mod?", "mod"));
+    EXPECT_FALSE(glob_match("a?b", "a/b"));
+}
+
 int main(int argc, char* argv[])
 {
 	::testing::InitGoogleTest(&argc, argv);
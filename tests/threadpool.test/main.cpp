@@ -0,0 +1,137 @@
+#include "threadpool.h"
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <numeric>
+#include <set>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#ifdef __linux__
+#include <time.h>
+#endif
+
+TEST(ThreadPoolTest, RunsEverySubmittedJob) {
+    std::atomic<int> count{0};
+    {
+        ThreadPool pool(4);
+        EXPECT_EQ(pool.size(), 4);
+        for (int i = 0; i < 1000; ++i)
+            pool.submit([&count] { ++count; });
+    }
+    // The destructor runs what is still queued
+    EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(ThreadPoolTest, AtLeastOneThread) {
+    ThreadPool pool(0);
+    EXPECT_EQ(pool.size(), 1);
+    std::atomic<bool> ran{false};
+    pool.parallel_for(10, 1, [&](size_t, size_t) { ran = true; });
+    EXPECT_TRUE(ran.load());
+}
+
+TEST(ThreadPoolTest, JobsRunOffTheCallingThread) {
+    ThreadPool pool(2);
+    std::mutex mutex;
+    std::condition_variable done;
+    std::thread::id worker;
+    bool finished = false;
+    pool.submit([&] {
+        std::lock_guard<std::mutex> lock(mutex);
+        worker = std::this_thread::get_id();
+        finished = true;
+        done.notify_one();
+    });
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [&] { return finished; });
+    EXPECT_NE(worker, std::this_thread::get_id());
+}
+
+TEST(ThreadPoolTest, ParallelForCoversTheRangeOnce) {
+    ThreadPool pool(4);
+    for (size_t count : { size_t(0), size_t(1), size_t(7), size_t(1000), size_t(100003) }) {
+        std::vector<std::atomic<int>> hits(count);
+        pool.parallel_for(count, 64, [&](size_t begin, size_t end) {
+            EXPECT_LE(begin, end);
+            EXPECT_LE(end, count);
+            for (size_t i = begin; i < end; ++i)
+                ++hits[i];
+        });
+        for (size_t i = 0; i < count; ++i)
+            ASSERT_EQ(hits[i].load(), 1) << "count=" << count << " i=" << i;
+    }
+}
+
+TEST(ThreadPoolTest, ParallelForSpreadsOverWorkers) {
+    ThreadPool pool(4);
+    std::mutex mutex;
+    std::set<std::thread::id> threads;
+    pool.parallel_for(64, 1, [&](size_t, size_t) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        std::lock_guard<std::mutex> lock(mutex);
+        threads.insert(std::this_thread::get_id());
+    });
+    EXPECT_GT(threads.size(), 1);
+}
+
+TEST(ThreadPoolTest, NestedParallelForFromAJob) {
+    ThreadPool pool(3);
+    std::vector<long> sums(8);
+    pool.parallel_for(sums.size(), 1, [&](size_t begin, size_t end) {
+        for (size_t job = begin; job < end; ++job) {
+            std::vector<long> values(10000);
+            std::iota(values.begin(), values.end(), 0);
+            std::atomic<long> sum{0};
+            pool.parallel_for(values.size(), 100, [&](size_t b, size_t e) {
+                long partial = 0;
+                for (size_t i = b; i < e; ++i)
+                    partial += values[i];
+                sum += partial;
+            });
+            sums[job] = sum.load();
+        }
+    });
+    for (long sum : sums)
+        EXPECT_EQ(sum, 10000L * 9999 / 2);
+}
+
+TEST(ThreadPoolTest, ParallelForRethrows) {
+    ThreadPool pool(2);
+    std::atomic<int> chunks{0};
+    EXPECT_THROW(pool.parallel_for(100, 10, [&](size_t begin, size_t) {
+        ++chunks;
+        if (begin == 50)
+            throw std::runtime_error("chunk failed");
+    }), std::runtime_error);
+    // The other chunks still ran
+    EXPECT_EQ(chunks.load(), 10);
+}
+
+#ifdef __linux__
+static double thread_cpu_seconds() {
+    timespec time;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return double(time.tv_sec) + double(time.tv_nsec) * 1e-9;
+}
+
+TEST(ThreadPoolTest, ParallelForSleepsWhileOthersFinish) {
+    ThreadPool pool(1);
+    std::thread::id caller = std::this_thread::get_id();
+    double start = thread_cpu_seconds();
+    pool.parallel_for(2, 1, [&](size_t, size_t) {
+        if (std::this_thread::get_id() != caller)
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    });
+    // Spinning while the worker sleeps would take about as long in CPU time
+    EXPECT_LT(thread_cpu_seconds() - start, 0.1);
+}
+#endif
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
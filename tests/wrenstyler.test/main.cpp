@@ -0,0 +1,154 @@
+#include "wrenstyler.h"
+#include <gtest/gtest.h>
+#include "console.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+// Lines a test can edit, as the Code window's module source
+class Lines : public ContentProvider {
+public:
+    std::vector<std::string> lines;
+
+    explicit Lines(std::vector<std::string> text) : lines(std::move(text)) {}
+    size_t get_line_count() const override { return lines.size(); }
+    const std::string& get_line(size_t index) const override { return lines[index]; }
+};
+
+struct Styled {
+    int start;
+    int length;
+    Color color;
+    bool operator==(const Styled& other) const {
+        return start == other.start && length == other.length && color == other.color;
+    }
+};
+
+static std::ostream& operator<<(std::ostream& os, const Styled& run) {
+    return os << "{" << run.start << "," << run.length << "," << int(run.color) << "}";
+}
+
+static std::vector<Styled> style(WrenStyler& styler, const Lines& content, size_t index) {
+    std::vector<Styled> runs;
+    for (const StyleRun& run : styler.style_line(index, content.lines[index]))
+        runs.push_back({ run.start, run.length, run.foreground });
+    return runs;
+}
+
+static const Color keyword = Color::Cyan;
+static const Color text = Color::Yellow;
+static const Color number = Color::Magenta;
+static const Color comment = Color::Green;
+
+TEST(WrenStylerTest, Tokens) {
+    auto content = std::make_shared<Lines>(std::vector<std::string>{
+        "var x = 0x1F + 2.5e3 // done",
+        "if (name) return \"a\\\"b\"",
+    });
+    WrenStyler styler(content);
+    EXPECT_EQ(style(styler, *content, 0), (std::vector<Styled>{
+        { 0, 3, keyword }, { 8, 4, number }, { 15, 5, number }, { 21, 7, comment } }));
+    EXPECT_EQ(style(styler, *content, 1), (std::vector<Styled>{
+        { 0, 2, keyword }, { 10, 6, keyword }, { 17, 6, text } }));
+}
+
+TEST(WrenStylerTest, BlockCommentAcrossLines) {
+    auto content = std::make_shared<Lines>(std::vector<std::string>{
+        "var a /* opens",
+        "still /* nested */ inside",
+        "closes */ var b",
+        "var c",
+    });
+    WrenStyler styler(content);
+    EXPECT_EQ(style(styler, *content, 0), (std::vector<Styled>{ { 0, 3, keyword }, { 6, 8, comment } }));
+    EXPECT_EQ(style(styler, *content, 1), (std::vector<Styled>{ { 0, 25, comment } }));
+    EXPECT_EQ(style(styler, *content, 2), (std::vector<Styled>{ { 0, 9, comment }, { 10, 3, keyword } }));
+    EXPECT_EQ(style(styler, *content, 3), (std::vector<Styled>{ { 0, 3, keyword } }));
+}
+
+TEST(WrenStylerTest, RawStringAcrossLines) {
+    auto content = std::make_shared<Lines>(std::vector<std::string>{
+        "var s = \"\"\"first",
+        "var is text here",
+        "last\"\"\" + 1",
+    });
+    WrenStyler styler(content);
+    EXPECT_EQ(style(styler, *content, 1), (std::vector<Styled>{ { 0, 16, text } }));
+    EXPECT_EQ(style(styler, *content, 2), (std::vector<Styled>{ { 0, 7, text }, { 10, 1, number } }));
+}
+
+TEST(WrenStylerTest, InterpolationHoldsStrings) {
+    auto content = std::make_shared<Lines>(std::vector<std::string>{
+        "\"a %(f(\")\")) b\" + 1",
+    });
+    WrenStyler styler(content);
+    // The quotes inside %(...) don't end the outer string
+    EXPECT_EQ(style(styler, *content, 0), (std::vector<Styled>{ { 0, 15, text }, { 18, 1, number } }));
+}
+
+TEST(WrenStylerTest, JumpingDownScansTheLinesAbove) {
+    std::vector<std::string> lines = { "/*" };
+    for (int i = 0; i < 500; ++i)
+        lines.push_back("var x");
+    lines.push_back("*/ var y");
+    auto content = std::make_shared<Lines>(lines);
+    WrenStyler styler(content);
+    EXPECT_EQ(style(styler, *content, 501), (std::vector<Styled>{ { 0, 2, comment }, { 3, 3, keyword } }));
+    EXPECT_EQ(style(styler, *content, 250), (std::vector<Styled>{ { 0, 5, comment } }));
+}
+
+TEST(WrenStylerTest, RestyledAfterAnEdit) {
+    auto content = std::make_shared<Lines>(std::vector<std::string>{
+        "var a",
+        "var b",
+        "var c",
+    });
+    WrenStyler styler(content);
+    for (size_t i = 0; i < 3; ++i)
+        EXPECT_EQ(style(styler, *content, i), (std::vector<Styled>{ { 0, 3, keyword } }));
+
+    // Opening a comment on line 1 changes how the lines below lex
+    content->lines[1] = "var b /*";
+    styler.invalidate(1);
+    EXPECT_EQ(style(styler, *content, 0), (std::vector<Styled>{ { 0, 3, keyword } }));
+    EXPECT_EQ(style(styler, *content, 1), (std::vector<Styled>{ { 0, 3, keyword }, { 6, 2, comment } }));
+    EXPECT_EQ(style(styler, *content, 2), (std::vector<Styled>{ { 0, 5, comment } }));
+
+    // And closing it again restores them
+    content->lines[1] = "var b";
+    styler.invalidate(1);
+    EXPECT_EQ(style(styler, *content, 2), (std::vector<Styled>{ { 0, 3, keyword } }));
+
+    // Added lines are picked up without an explicit invalidate
+    content->lines.push_back("42");
+    EXPECT_EQ(style(styler, *content, 3), (std::vector<Styled>{ { 0, 2, number } }));
+}
+
+TEST(WrenStylerTest, WideningTheWindowShowsTheRestOfTheStyling) {
+    Console console(ConsoleBackend::Memory, 40, 5);
+    Desktop desktop(console);
+    auto content = std::make_shared<Lines>(std::vector<std::string>{ "var value = 12345" });
+    auto window = std::make_shared<Window>(Rect(0, 0, 10, 5));
+    window->set_content_provider(content);
+    window->set_line_styler(std::make_shared<WrenStyler>(content));
+    desktop.add_window(window);
+    desktop.draw(window);
+
+    // The number was cut off at first; once shown, it is styled
+    window->set_rect(Rect(0, 0, 40, 5));
+    desktop.draw(window);
+    wchar_t ch;
+    ColorPair color;
+    ASSERT_TRUE(console.get_cell(1 + 12, 1, ch, color));
+    EXPECT_EQ(ch, L'1');
+    EXPECT_EQ(color.foreground, number);
+    ASSERT_TRUE(console.get_cell(1 + 16, 1, ch, color));
+    EXPECT_EQ(ch, L'5');
+    EXPECT_EQ(color.foreground, number);
+}
+
+int main(int argc, char* argv[])
+{
+	::testing::InitGoogleTest(&argc, argv);
+	return RUN_ALL_TESTS();
+}
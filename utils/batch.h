@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstring>
+#include <exception>
+#include <type_traits>
+#include <utility>
+#include <wren.hpp>
+#include "binder.h"
+#include "buffer.h"
+
+// Runs F over whole arrays of arguments in one foreign call, for the
+// Name_batch methods generate_bindings.py writes with "//BIND batch".
+//
+// Slots 1..n hold either Lists of the same length, and slot 0 gets the List
+// of results, or, when F only takes and returns numbers, Buffers of doubles
+// with the same count, and slot 0 gets a new Buffer of doubles.  A void F
+// leaves null in slot 0.  List elements pass through scratch slots, and
+// Buffers are read in place, so nothing is built on the way.  The API can't
+// tell a Buffer from other foreign objects, so the Wren method calling a
+// numeric batch must check its arguments are Lists or Buffers.
+template<auto F>
+struct ForeignBatchWrapper;
+
+template<typename R, typename... Args, R (*F)(Args...)>
+struct ForeignBatchWrapper<F>
+{
+	static_assert(sizeof...(Args) > 0, "A batch needs at least one argument");
+
+	static void call(WrenVM* vm)
+	{
+		try
+		{
+			if constexpr (is_numeric)
+			{
+				if (wrenGetSlotType(vm, 1) == WREN_TYPE_FOREIGN)
+				{
+					call_buffers(vm, std::index_sequence_for<Args...>{});
+					return;
+				}
+			}
+			call_lists(vm, std::index_sequence_for<Args...>{});
+		}
+		catch (const std::exception& e)
+		{
+			abort(vm, e.what());
+		}
+	}
+
+private:
+	static constexpr int arity = int(sizeof...(Args));
+	static constexpr bool is_numeric = (std::is_void_v<R> || std::is_arithmetic_v<R>) &&
+		(std::is_arithmetic_v<std::decay_t<Args>> && ...);
+
+	static void abort(WrenVM* vm, const char* message)
+	{
+		wrenSetSlotString(vm, 0, message);
+		wrenAbortFiber(vm, 0);
+	}
+
+	template<size_t... I>
+	static void call_lists(WrenVM* vm, std::index_sequence<I...>)
+	{
+		if (((wrenGetSlotType(vm, int(I) + 1) != WREN_TYPE_LIST) || ...))
+		{
+			abort(vm, is_numeric ? "Batch arguments must be Lists or Buffers." : "Batch arguments must be Lists.");
+			return;
+		}
+		int count = wrenGetListCount(vm, 1);
+		if (((wrenGetListCount(vm, int(I) + 1) != count) || ...))
+		{
+			abort(vm, "Batch arguments must have the same length.");
+			return;
+		}
+		int scratch = reserve_scratch_slots(vm, arity + 1);
+		if constexpr (!std::is_void_v<R>)
+			wrenSetSlotNewList(vm, 0);
+		for (int i = 0; i < count; ++i)
+		{
+			(wrenGetListElement(vm, int(I) + 1, i, scratch + int(I)), ...);
+			if constexpr (std::is_void_v<R>)
+				F(SlotTraits<std::decay_t<Args>>::get(vm, scratch + int(I))...);
+			else
+			{
+				SlotTraits<std::decay_t<R>>::set(vm, scratch + arity, F(SlotTraits<std::decay_t<Args>>::get(vm, scratch + int(I))...));
+				wrenInsertInList(vm, 0, -1, scratch + arity);
+			}
+		}
+		if constexpr (std::is_void_v<R>)
+			wrenSetSlotNull(vm, 0);
+	}
+
+	// Slices may start anywhere, so elements are copied out, not cast
+	static double element(const Buffer& buffer, size_t index)
+	{
+		double value;
+		std::memcpy(&value, buffer.data() + index * sizeof(double), sizeof(double));
+		return value;
+	}
+
+	template<size_t... I>
+	static void call_buffers(WrenVM* vm, std::index_sequence<I...>)
+	{
+		if (((wrenGetSlotType(vm, int(I) + 1) != WREN_TYPE_FOREIGN) || ...))
+		{
+			abort(vm, "Batch arguments must be Lists or Buffers.");
+			return;
+		}
+		const Buffer* buffers[] = { &SlotTraits<Buffer>::get(vm, int(I) + 1)... };
+		size_t count = buffers[0]->size() / sizeof(double);
+		for (const Buffer* buffer : buffers)
+		{
+			if (buffer->size() != count * sizeof(double))
+			{
+				abort(vm, "Batch arguments must have the same length.");
+				return;
+			}
+		}
+		if constexpr (std::is_void_v<R>)
+		{
+			for (size_t i = 0; i < count; ++i)
+				F(number_to<std::decay_t<Args>>(element(*buffers[I], i))...);
+			wrenSetSlotNull(vm, 0);
+		}
+		else
+		{
+			Buffer results(count * sizeof(double));
+			for (size_t i = 0; i < count; ++i)
+			{
+				double result = double(F(number_to<std::decay_t<Args>>(element(*buffers[I], i))...));
+				std::memcpy(results.data() + i * sizeof(double), &result, sizeof(double));
+			}
+			SlotTraits<Buffer>::set(vm, 0, std::move(results));
+		}
+	}
+};
+
+template<auto F>
+constexpr void (*foreign_batch_wrapper)(WrenVM* vm) = &ForeignBatchWrapper<F>::call;
@@ -1,12 +1,277 @@
 #pragma once
 
+#include <algorithm>
+#include <exception>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <new>
 #include <ostream>
+#include <stdexcept>
 #include <unordered_map>
 #include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
 #include <wren.hpp>
 #include "singleton.h"
 
+// Passed to a plugin's optional EnumerateFunctions export, once per binding
+using EnumerateCallback = void(*)(void* context, const char* name, void(*func)(WrenVM* vm));
+// Passed to the optional EnumerateClasses export, once per foreign class
+using EnumerateClassCallback = void(*)(void* context, const char* name, WrenForeignClassMethods methods);
+
+// Raw bytes of a Wren string, valid while the string is in its slot
+struct Bytes
+{
+	const char*		data = nullptr;
+	int				length = 0;
+};
+
+// How a C++ type is read from and written to a Wren slot.  Specialize it to
+// let bind<> marshal a new type; get is needed for arguments, set for results.
+template<typename T>
+struct SlotTraits;
+
+template<>
+struct SlotTraits<double>
+{
+	static double get(WrenVM* vm, int slot) { return wrenGetSlotDouble(vm, slot); }
+	static void set(WrenVM* vm, int slot, double value) { wrenSetSlotDouble(vm, slot, value); }
+};
+
+// A Num as an arithmetic type, truncated toward zero for integers.  Casting
+// NaN or a value out of the integer's range is undefined, so those throw.
+template<typename T>
+T number_to(double value)
+{
+	if constexpr (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+	{
+		if (!(value > double(std::numeric_limits<T>::min()) - 1 && value < double(std::numeric_limits<T>::max()) + 1))
+			throw std::out_of_range("Number out of range for an integer argument.");
+	}
+	return static_cast<T>(value);
+}
+
+template<>
+struct SlotTraits<int>
+{
+	static int get(WrenVM* vm, int slot) { return number_to<int>(wrenGetSlotDouble(vm, slot)); }
+	static void set(WrenVM* vm, int slot, int value) { wrenSetSlotDouble(vm, slot, value); }
+};
+
+template<>
+struct SlotTraits<bool>
+{
+	static bool get(WrenVM* vm, int slot) { return wrenGetSlotBool(vm, slot); }
+	static void set(WrenVM* vm, int slot, bool value) { wrenSetSlotBool(vm, slot, value); }
+};
+
+template<>
+struct SlotTraits<const char*>
+{
+	static const char* get(WrenVM* vm, int slot) { return wrenGetSlotString(vm, slot); }
+	static void set(WrenVM* vm, int slot, const char* value) { wrenSetSlotString(vm, slot, value); }
+};
+
+template<>
+struct SlotTraits<std::string>
+{
+	static std::string get(WrenVM* vm, int slot)
+	{
+		int length = 0;
+		const char* bytes = wrenGetSlotBytes(vm, slot, &length);
+		return std::string(bytes, size_t(length));
+	}
+	static void set(WrenVM* vm, int slot, const std::string& value) { wrenSetSlotBytes(vm, slot, value.data(), value.size()); }
+};
+
+template<>
+struct SlotTraits<Bytes>
+{
+	static Bytes get(WrenVM* vm, int slot)
+	{
+		Bytes bytes;
+		bytes.data = wrenGetSlotBytes(vm, slot, &bytes.length);
+		return bytes;
+	}
+	static void set(WrenVM* vm, int slot, const Bytes& value) { wrenSetSlotBytes(vm, slot, value.data, size_t(value.length)); }
+};
+
+// A slot above the ones in use, for list elements and map entries on their
+// way in or out.  Reserved once per container, not per element.
+inline int reserve_scratch_slots(WrenVM* vm, int count)
+{
+	int first = wrenGetSlotCount(vm);
+	wrenEnsureSlots(vm, first + count);
+	return first;
+}
+
+// The first scratch slot a nested conversion may use.  The outermost value
+// reserves the slots for all levels once and passes them down, so a list
+// of lists takes one slot per level rather than one per element.
+struct ScratchSlots
+{
+	int		first;
+};
+
+// Scratch slots converting a T takes, nested ones included; SlotTraits that
+// need any declare scratch_slots and take ScratchSlots in get and set
+template<typename T, typename = void>
+struct ScratchSlotCount : std::integral_constant<int, 0> {};
+
+template<typename T>
+struct ScratchSlotCount<T, std::void_t<decltype(SlotTraits<T>::scratch_slots)>>
+	: std::integral_constant<int, SlotTraits<T>::scratch_slots> {};
+
+template<typename T>
+decltype(auto) get_slot(WrenVM* vm, int slot, ScratchSlots scratch)
+{
+	if constexpr (ScratchSlotCount<T>::value > 0)
+		return SlotTraits<T>::get(vm, slot, scratch);
+	else
+		return SlotTraits<T>::get(vm, slot);
+}
+
+template<typename T>
+void set_slot(WrenVM* vm, int slot, const T& value, ScratchSlots scratch)
+{
+	if constexpr (ScratchSlotCount<T>::value > 0)
+		SlotTraits<T>::set(vm, slot, value, scratch);
+	else
+		SlotTraits<T>::set(vm, slot, value);
+}
+
+// A Wren List, converted element by element in one pass
+template<typename T>
+struct SlotTraits<std::vector<T>>
+{
+	static constexpr int scratch_slots = 1 + ScratchSlotCount<T>::value;
+
+	static std::vector<T> get(WrenVM* vm, int slot)
+	{
+		return get(vm, slot, ScratchSlots{ reserve_scratch_slots(vm, scratch_slots) });
+	}
+
+	static std::vector<T> get(WrenVM* vm, int slot, ScratchSlots scratch)
+	{
+		int element_slot = scratch.first;
+		int count = wrenGetListCount(vm, slot);
+		std::vector<T> values;
+		values.reserve(size_t(count));
+		for (int i = 0; i < count; ++i)
+		{
+			wrenGetListElement(vm, slot, i, element_slot);
+			values.push_back(get_slot<T>(vm, element_slot, ScratchSlots{ element_slot + 1 }));
+		}
+		return values;
+	}
+
+	static void set(WrenVM* vm, int slot, const std::vector<T>& values)
+	{
+		set(vm, slot, values, ScratchSlots{ reserve_scratch_slots(vm, scratch_slots) });
+	}
+
+	static void set(WrenVM* vm, int slot, const std::vector<T>& values, ScratchSlots scratch)
+	{
+		int element_slot = scratch.first;
+		wrenSetSlotNewList(vm, slot);
+		for (const auto& value : values)
+		{
+			set_slot<T>(vm, element_slot, value, ScratchSlots{ element_slot + 1 });
+			wrenInsertInList(vm, slot, -1, element_slot);
+		}
+	}
+};
+
+// A Wren Map.  The API can't walk a map, so a map argument arrives as a List
+// of its keys and a List of its values, in the same order: the Wren code
+// generate_bindings.py writes passes map.keys.toList and map.values.toList.
+template<typename K, typename V>
+struct SlotTraits<std::map<K, V>>
+{
+	static constexpr int scratch_slots = 2 + std::max(ScratchSlotCount<K>::value, ScratchSlotCount<V>::value);
+
+	static std::map<K, V> get(WrenVM* vm, int keys_slot, int values_slot)
+	{
+		return get(vm, keys_slot, values_slot, ScratchSlots{ reserve_scratch_slots(vm, scratch_slots) });
+	}
+
+	static std::map<K, V> get(WrenVM* vm, int keys_slot, int values_slot, ScratchSlots scratch)
+	{
+		int element_slot = scratch.first;
+		ScratchSlots nested{ scratch.first + 2 };
+		int count = wrenGetListCount(vm, keys_slot);
+		std::map<K, V> map;
+		for (int i = 0; i < count; ++i)
+		{
+			wrenGetListElement(vm, keys_slot, i, element_slot);
+			K key = get_slot<K>(vm, element_slot, nested);
+			wrenGetListElement(vm, values_slot, i, element_slot);
+			map.emplace_hint(map.end(), std::move(key), get_slot<V>(vm, element_slot, nested));
+		}
+		return map;
+	}
+
+	static void set(WrenVM* vm, int slot, const std::map<K, V>& map)
+	{
+		set(vm, slot, map, ScratchSlots{ reserve_scratch_slots(vm, scratch_slots) });
+	}
+
+	static void set(WrenVM* vm, int slot, const std::map<K, V>& map, ScratchSlots scratch)
+	{
+		int key_slot = scratch.first;
+		ScratchSlots nested{ scratch.first + 2 };
+		wrenSetSlotNewMap(vm, slot);
+		for (const auto& [key, value] : map)
+		{
+			set_slot<K>(vm, key_slot, key, nested);
+			set_slot<V>(vm, key_slot + 1, value, nested);
+			wrenSetMapValue(vm, slot, key_slot, key_slot + 1);
+		}
+	}
+};
+
+// Arguments are taken from slots 1..n and the result goes to slot 0, like the
+// wrappers generate_bindings.py writes, but deduced from the signature of F.
+template<auto F>
+struct ForeignWrapper;
+
+template<typename R, typename... Args, R (*F)(Args...)>
+struct ForeignWrapper<F>
+{
+	// Exceptions become Wren runtime errors instead of unwinding through the VM
+	static void call(WrenVM* vm)
+	{
+		try
+		{
+			call(vm, std::index_sequence_for<Args...>{});
+		}
+		catch (const std::exception& e)
+		{
+			wrenSetSlotString(vm, 0, e.what());
+			wrenAbortFiber(vm, 0);
+		}
+	}
+
+private:
+	template<size_t... I>
+	static void call(WrenVM* vm, std::index_sequence<I...>)
+	{
+		if constexpr (std::is_void_v<R>)
+			F(SlotTraits<std::decay_t<Args>>::get(vm, int(I) + 1)...);
+		else
+			SlotTraits<std::decay_t<R>>::set(vm, 0, F(SlotTraits<std::decay_t<Args>>::get(vm, int(I) + 1)...));
+	}
+};
+
+// The wrapper of a static or free function, usable in a constexpr ForeignBinding
+// table: { "sample.Sample.Add(_,_)", foreign_wrapper<&Sample::Add> }
+template<auto F>
+constexpr void (*foreign_wrapper)(WrenVM* vm) = &ForeignWrapper<F>::call;
+
 class ForeignFunctions
 {
 public:
@@ -22,6 +287,13 @@ public:
 		m_Mapping[name] = func;
 	}
 
+	// bind<&Sample::Add>("sample.Sample.Add(_,_)"), without a generated wrapper
+	template<auto F>
+	void bind(const char* name)
+	{
+		bind(name, foreign_wrapper<F>);
+	}
+
 	wrapper get(const std::string& name) const
 	{
 		auto it = m_Mapping.find(name);
@@ -32,18 +304,28 @@ public:
 		return nullptr;
 	}
 
+	void enumerate(EnumerateCallback callback, void* context) const
+	{
+		for (const auto& [name, func] : m_Mapping)
+		{
+			callback(context, name.c_str(), func);
+		}
+	}
+
+	static void register_module(WrenVM* vm, const char* module_name, const char* code)
+	{
+		WrenInterpretResult result = wrenInterpret(vm, module_name, code);
+		if (result != WREN_RESULT_SUCCESS)
+		{
+			std::cerr << "Failed to register native module " << module_name << std::endl;
+		}
+	}
+
 	void register_modules(WrenVM* vm) const
 	{
 		for (const auto& [module_name, code] : m_ModuleCode)
 		{
-			WrenInterpretResult result = wrenInterpret(
-				vm,
-				module_name.c_str(),
-				code.c_str());
-			if (result != WREN_RESULT_SUCCESS)
-			{
-				std::cerr << "Failed to register native module " << module_name << std::endl;
-			}
+			register_module(vm, module_name.c_str(), code.c_str());
 		}
 	}
 
@@ -51,3 +333,108 @@ private:
 	std::unordered_map<std::string, wrapper> m_Mapping;
 	std::unordered_map<std::string, std::string> m_ModuleCode;
 };
+
+// Entries of the tables generate_bindings.py writes to initializers.h.  They
+// are built at compile time, so a plugin using them has nothing to fill in
+// Initialize and looks functions up without allocating.
+struct ForeignBinding
+{
+	std::string_view			name;	// Points to a string literal, so name.data() is null terminated
+	ForeignFunctions::wrapper	func;
+};
+
+struct ForeignModuleCode
+{
+	const char*		module_name;
+	const char*		code;
+};
+
+// "module.Class" of a foreign class, with the methods that create and
+// finalize its objects
+struct ForeignClassBinding
+{
+	std::string_view			name;
+	WrenForeignMethodFn			allocate;
+	WrenFinalizerFn				finalize;
+};
+
+// Strictly increasing, so the table is searchable and has no duplicates
+template<typename Table>
+constexpr bool is_sorted_bindings(const Table& table)
+{
+	for (size_t i = 1; i < std::size(table); ++i)
+	{
+		if (!(table[i - 1].name < table[i].name))
+			return false;
+	}
+	return true;
+}
+
+// The entry named name in a sorted table, or nullptr
+template<typename Entry>
+const Entry* find_entry(const Entry* begin, const Entry* end, std::string_view name)
+{
+	const Entry* it = std::lower_bound(begin, end, name, [](const Entry& entry, std::string_view key)
+	{
+		return entry.name < key;
+	});
+	return it != end && it->name == name ? it : nullptr;
+}
+
+inline ForeignFunctions::wrapper find_binding(const ForeignBinding* begin, const ForeignBinding* end, std::string_view name)
+{
+	const ForeignBinding* binding = find_entry(begin, end, name);
+	return binding ? binding->func : nullptr;
+}
+
+template<typename Table>
+ForeignFunctions::wrapper find_binding(const Table& table, std::string_view name)
+{
+	return find_binding(std::data(table), std::data(table) + std::size(table), name);
+}
+
+// Objects of generated foreign classes are stored in the Wren object, which
+// Wren allocates anyway.  Wren finalizes the object even when the
+// constructor threw, so a flag after it tells whether there is one.
+template<typename T>
+struct ForeignObject
+{
+	alignas(T) unsigned char	storage[sizeof(T)];
+	bool						constructed;
+};
+
+template<typename T>
+T& get_foreign_object(WrenVM* vm, int slot)
+{
+	return *std::launder(reinterpret_cast<T*>(wrenGetSlotForeign(vm, slot)));
+}
+
+// For the allocate method: the constructor arguments are in slots 1..n and
+// the new object goes to slot 0
+template<typename T, typename... Args>
+void new_foreign_object(WrenVM* vm, Args&&... args)
+{
+	static_assert(alignof(T) <= alignof(void*), "Wren only aligns foreign storage for pointers");
+	auto* object = static_cast<ForeignObject<T>*>(wrenSetSlotNewForeign(vm, 0, 0, sizeof(ForeignObject<T>)));
+	object->constructed = false;
+	new (object->storage) T(std::forward<Args>(args)...);
+	object->constructed = true;
+}
+
+template<typename T>
+void delete_foreign_object(void* data)
+{
+	auto* object = static_cast<ForeignObject<T>*>(data);
+	if (object->constructed)
+		std::launder(reinterpret_cast<T*>(object->storage))->~T();
+	object->constructed = false;
+}
+
+template<size_t N>
+void register_modules(WrenVM* vm, const ForeignModuleCode (&modules)[N])
+{
+	for (const auto& module : modules)
+	{
+		ForeignFunctions::register_module(vm, module.module_name, module.code);
+	}
+}
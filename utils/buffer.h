@@ -0,0 +1,111 @@
+#pragma once
+
+#include <cstddef>
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include <wren.hpp>
+#include "binder.h"
+
+// Native memory shared by Wren scripts and plugins without copying.  Copies
+// and slices of a Buffer are views of the same storage, which is released
+// with the last of them.
+class Buffer
+{
+	std::shared_ptr<uint8_t>	m_Storage;
+	uint8_t*					m_Data = nullptr;
+	size_t						m_Size = 0;
+	bool						m_ReadOnly = false;
+public:
+	Buffer() = default;
+
+	// Zero filled
+	explicit Buffer(size_t size)
+		: m_Storage(new uint8_t[size](), std::default_delete<uint8_t[]>())
+		, m_Data(m_Storage.get())
+		, m_Size(size)
+	{
+	}
+
+	// Takes over memory allocated elsewhere; deleter(data) releases it.
+	// Nothing may write to read-only memory, which scripts are refused.
+	template<typename Deleter>
+	Buffer(uint8_t* data, size_t size, Deleter deleter, bool read_only = false)
+		: m_Storage(data, std::move(deleter))
+		, m_Data(data)
+		, m_Size(size)
+		, m_ReadOnly(read_only)
+	{
+	}
+
+	uint8_t* data() const
+	{
+		return m_Data;
+	}
+
+	size_t size() const
+	{
+		return m_Size;
+	}
+
+	bool empty() const
+	{
+		return m_Size == 0;
+	}
+
+	bool read_only() const
+	{
+		return m_ReadOnly;
+	}
+
+	// A view of [offset, offset + length), clamped to the end of this one
+	Buffer slice(size_t offset, size_t length) const
+	{
+		Buffer view(*this);
+		offset = std::min(offset, m_Size);
+		view.m_Data = m_Data + offset;
+		view.m_Size = std::min(length, m_Size - offset);
+		return view;
+	}
+};
+
+// The built-in Wren module the Buffer class is defined in
+constexpr const char* BUFFER_MODULE = "buffer";
+
+// A Wren Buffer object keeps its Buffer in the object's foreign storage, so
+// arguments are passed by reference and results are moved in.  The API only
+// tells that a slot holds some foreign object, so the Wren side must check
+// the argument is a Buffer, as the code generate_bindings.py writes does.
+template<>
+struct SlotTraits<Buffer>
+{
+	static Buffer& get(WrenVM* vm, int slot)
+	{
+		if (wrenGetSlotType(vm, slot) != WREN_TYPE_FOREIGN)
+			throw std::invalid_argument("Expected a Buffer.");
+		return *static_cast<Buffer*>(wrenGetSlotForeign(vm, slot));
+	}
+
+	// The class is looked up in a scratch slot
+	static constexpr int scratch_slots = 1;
+
+	static Buffer& get(WrenVM* vm, int slot, ScratchSlots)
+	{
+		return get(vm, slot);
+	}
+
+	static void set(WrenVM* vm, int slot, Buffer value)
+	{
+		set(vm, slot, std::move(value), ScratchSlots{ reserve_scratch_slots(vm, scratch_slots) });
+	}
+
+	static void set(WrenVM* vm, int slot, Buffer value, ScratchSlots scratch)
+	{
+		wrenGetVariable(vm, BUFFER_MODULE, "Buffer", scratch.first);
+		void* memory = wrenSetSlotNewForeign(vm, slot, scratch.first, sizeof(Buffer));
+		new (memory) Buffer(std::move(value));
+	}
+};
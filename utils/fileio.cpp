@@ -0,0 +1,130 @@
+#include "fileio.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <stdexcept>
+#include <system_error>
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static std::runtime_error file_error(const char* what, const std::string& path, const std::string& reason)
+{
+	return std::runtime_error(std::string(what) + " '" + path + "': " + reason);
+}
+
+// Streams don't set errno, so the reason is only known when the path
+// itself is the problem
+static std::runtime_error stream_error(const char* what, const std::string& path)
+{
+	std::error_code error;
+	(void)std::filesystem::status(path, error);
+	return file_error(what, path, error ? error.message() : "I/O error");
+}
+
+#ifndef WIN32
+// Empty when the file is too small to be worth mapping, or can't be mapped
+static Buffer map_file(const std::string& path)
+{
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		throw file_error("Cannot open", path, std::strerror(errno));
+	struct stat st;
+	if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || size_t(st.st_size) < MAP_THRESHOLD)
+	{
+		close(fd);
+		return Buffer();
+	}
+	size_t size = size_t(st.st_size);
+	void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (data == MAP_FAILED)
+		return Buffer();
+	return Buffer(static_cast<uint8_t*>(data), size, [size](uint8_t* p) { munmap(p, size); }, true);
+}
+#endif
+
+Buffer read_file(const std::string& path)
+{
+#ifndef WIN32
+	Buffer mapped = map_file(path);
+	if (!mapped.empty())
+		return mapped;
+#endif
+	std::ifstream f(path, std::ios::binary);
+	if (!f)
+		throw stream_error("Cannot open", path);
+	std::ostringstream os;
+	os << f.rdbuf();
+	std::string content = os.str();
+	Buffer buffer(content.size());
+	std::memcpy(buffer.data(), content.data(), content.size());
+	return buffer;
+}
+
+void write_file(const std::string& path, const uint8_t* data, size_t size)
+{
+	std::ofstream f(path, std::ios::binary | std::ios::trunc);
+	if (!f)
+		throw stream_error("Cannot create", path);
+	f.write(reinterpret_cast<const char*>(data), std::streamsize(size));
+	f.close();
+	if (!f)
+		throw stream_error("Cannot write", path);
+}
+
+uint64_t get_file_size(const std::string& path)
+{
+	std::error_code error;
+	uint64_t size = std::filesystem::file_size(path, error);
+	if (error)
+		throw std::runtime_error("Cannot get the size of '" + path + "': " + error.message());
+	return size;
+}
+
+std::vector<std::string> list_directory(const std::string& path)
+{
+	std::error_code error;
+	std::vector<std::string> names;
+	for (std::filesystem::directory_iterator it(path, error), end; !error && it != end; it.increment(error))
+		names.push_back(it->path().filename().string());
+	if (error)
+		throw std::runtime_error("Cannot list '" + path + "': " + error.message());
+	std::sort(names.begin(), names.end());
+	return names;
+}
+
+FileReader::FileReader(std::string path, size_t chunk_size)
+	: m_Path(std::move(path))
+	, m_ChunkSize(std::max<size_t>(chunk_size, 1))
+{
+}
+
+Buffer FileReader::read()
+{
+	if (!m_Opened)
+	{
+		m_File.open(m_Path, std::ios::binary);
+		if (!m_File)
+			throw stream_error("Cannot open", m_Path);
+		m_Opened = true;
+	}
+	if (!m_File.is_open())
+		return Buffer();
+	Buffer chunk(m_ChunkSize);
+	m_File.read(reinterpret_cast<char*>(chunk.data()), std::streamsize(m_ChunkSize));
+	size_t count = size_t(m_File.gcount());
+	if (m_File.bad())
+		throw stream_error("Cannot read", m_Path);
+	return count == m_ChunkSize ? chunk : chunk.slice(0, count);
+}
+
+void FileReader::close()
+{
+	m_File.close();
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "buffer.h"
+
+// Blocking file operations, run on worker threads by the io module.  Errors
+// throw std::runtime_error naming the file.
+
+// Regular files from this size up are mapped into memory instead of read
+constexpr size_t MAP_THRESHOLD = 256 * 1024;
+
+// The whole file.  A mapped file is read-only.  It stays backed by the file,
+// so if another process truncates the file, touching the cut off part of
+// the Buffer raises SIGBUS; copy the Buffer when that can happen.
+Buffer read_file(const std::string& path);
+void write_file(const std::string& path, const uint8_t* data, size_t size);
+uint64_t get_file_size(const std::string& path);
+// Names of the entries of a directory, sorted
+std::vector<std::string> list_directory(const std::string& path);
+
+// Reads a file in chunks.  The file is opened by the first read, so a
+// reader can be made on a thread that must not block.
+class FileReader
+{
+	std::string		m_Path;
+	size_t			m_ChunkSize;
+	std::ifstream	m_File;
+	bool			m_Opened = false;
+public:
+	FileReader(std::string path, size_t chunk_size);
+
+	// The next chunk, empty at the end of the file
+	Buffer read();
+	void close();
+};
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <wren.hpp>
+
+// The foreign methods of all native modules in one table, filled once when
+// the modules are loaded, so binding a method is a single lookup however
+// many modules there are.
+class ForeignRegistry
+{
+	struct Binding
+	{
+		WrenForeignMethodFn		func;
+		std::string				owner;
+	};
+
+	struct ClassBinding
+	{
+		WrenForeignClassMethods	methods;
+		std::string				owner;
+	};
+
+	std::unordered_map<std::string, Binding>		m_Bindings;
+	std::unordered_map<std::string, ClassBinding>	m_Classes;
+public:
+	// Returns false and keeps the existing binding when name is bound already
+	bool add(const std::string& name, WrenForeignMethodFn func, const std::string& owner)
+	{
+		return m_Bindings.emplace(name, Binding{ func, owner }).second;
+	}
+
+	WrenForeignMethodFn find(const std::string& name) const
+	{
+		auto it = m_Bindings.find(name);
+		return it != m_Bindings.end() ? it->second.func : nullptr;
+	}
+
+	// Who bound name, or an empty string
+	const std::string& get_owner(const std::string& name) const
+	{
+		static const std::string none;
+		auto it = m_Bindings.find(name);
+		return it != m_Bindings.end() ? it->second.owner : none;
+	}
+
+	// Same as add, for the "module.Class" of a foreign class
+	bool add_class(const std::string& name, WrenForeignClassMethods methods, const std::string& owner)
+	{
+		return m_Classes.emplace(name, ClassBinding{ methods, owner }).second;
+	}
+
+	bool find_class(const std::string& name, WrenForeignClassMethods& methods) const
+	{
+		auto it = m_Classes.find(name);
+		if (it == m_Classes.end())
+			return false;
+		methods = it->second.methods;
+		return true;
+	}
+
+	const std::string& get_class_owner(const std::string& name) const
+	{
+		static const std::string none;
+		auto it = m_Classes.find(name);
+		return it != m_Classes.end() ? it->second.owner : none;
+	}
+
+	size_t size() const
+	{
+		return m_Bindings.size();
+	}
+
+	void clear()
+	{
+		m_Bindings.clear();
+		m_Classes.clear();
+	}
+};
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+// Storage for many objects of one type, carved out of slabs of SlabSize
+// slots.  Destroyed objects leave their slot on a free list for the next
+// one, and slabs are only released with the pool, so creating and dropping
+// objects doesn't go through malloc.  Not thread safe.
+template<typename T, size_t SlabSize = 256>
+class ObjectPool
+{
+	union Slot
+	{
+		Slot*	next;
+		alignas(T) unsigned char storage[sizeof(T)];
+	};
+
+	std::vector<std::unique_ptr<Slot[]>>	m_Slabs;
+	Slot*									m_Free = nullptr;
+	size_t									m_Count = 0;
+
+	void grow()
+	{
+		m_Slabs.emplace_back(new Slot[SlabSize]);
+		Slot* slab = m_Slabs.back().get();
+		for (size_t i = 0; i + 1 < SlabSize; ++i)
+			slab[i].next = &slab[i + 1];
+		slab[SlabSize - 1].next = m_Free;
+		m_Free = slab;
+	}
+public:
+	ObjectPool() = default;
+	ObjectPool(const ObjectPool&) = delete;
+	ObjectPool& operator=(const ObjectPool&) = delete;
+
+	template<typename... Args>
+	T* create(Args&&... args)
+	{
+		if (!m_Free)
+			grow();
+		Slot* slot = m_Free;
+		Slot* next = slot->next;
+		// The slot stays free if the constructor throws
+		T* object = new (slot->storage) T(std::forward<Args>(args)...);
+		m_Free = next;
+		++m_Count;
+		return object;
+	}
+
+	void destroy(T* object)
+	{
+		object->~T();
+		Slot* slot = reinterpret_cast<Slot*>(object);
+		slot->next = m_Free;
+		m_Free = slot;
+		--m_Count;
+	}
+
+	// Live objects
+	size_t size() const
+	{
+		return m_Count;
+	}
+
+	size_t capacity() const
+	{
+		return m_Slabs.size() * SlabSize;
+	}
+};
@@ -83,3 +83,42 @@ std::string trim(const std::string line)
 	}
 	return sline;
 }
+
+static bool glob_match_impl(const char* pattern, const char* text)
+{
+	while (*pattern)
+	{
+		if (*pattern == '*')
+		{
+			bool cross_separator = (pattern[1] == '*');
+			pattern += cross_separator ? 2 : 1;
+			if (cross_separator && *pattern == '/')
+			{
+				// "**/" also matches zero directories
+				if (glob_match_impl(pattern + 1, text))
+					return true;
+			}
+			for (const char* t = text;; ++t)
+			{
+				if (glob_match_impl(pattern, t))
+					return true;
+				if (!*t || (!cross_separator && *t == '/'))
+					return false;
+			}
+		}
+		if (!*text)
+			return false;
+		if (*pattern != '?' && *pattern != *text)
+			return false;
+		if (*pattern == '?' && *text == '/')
+			return false;
+		++pattern;
+		++text;
+	}
+	return *text == 0;
+}
+
+bool glob_match(const std::string& pattern, const std::string& text)
+{
+	return glob_match_impl(pattern.c_str(), text.c_str());
+}
@@ -9,3 +9,7 @@ bool endswith(const std::string& line, const std::string& suffix);
 bool startswith(const std::string& line, const std::string& prefix);
 std::string get_leading_white_space(const std::string& line);
 std::string trim(const std::string line);
+
+// Shell style wildcard match.  '*' matches within a path component, '**' also
+// crosses '/' and '?' matches a single character.
+bool glob_match(const std::string& pattern, const std::string& text);
@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// A fixed set of worker threads, each with its own queue of jobs.  A worker
+// takes the newest job of its own queue, and when that is empty steals the
+// oldest job of another, so jobs submitted from a job (the chunks of a
+// parallel_for) stay on the thread that made them unless another is idle.
+// Jobs must not throw.  The destructor runs the jobs still queued, then
+// joins the workers.
+class ThreadPool
+{
+	struct Queue
+	{
+		std::mutex							mutex;
+		std::deque<std::function<void()>>	jobs;
+	};
+
+	// The pool and queue of the worker running on this thread, if any
+	struct Current
+	{
+		const ThreadPool*	pool = nullptr;
+		size_t				index = 0;
+	};
+
+	std::vector<std::unique_ptr<Queue>>	m_Queues;
+	std::vector<std::thread>			m_Threads;
+	std::mutex							m_Mutex;
+	std::condition_variable				m_WakeUp;
+	std::atomic<size_t>					m_Queued{ 0 };
+	std::atomic<size_t>					m_Next{ 0 };
+	bool								m_Stop = false;
+
+	static Current& current()
+	{
+		static thread_local Current current;
+		return current;
+	}
+
+	bool is_worker() const
+	{
+		return current().pool == this;
+	}
+
+	bool pop(size_t index, bool newest, std::function<void()>& job)
+	{
+		Queue& queue = *m_Queues[index];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.jobs.empty())
+			return false;
+		if (newest)
+		{
+			job = std::move(queue.jobs.back());
+			queue.jobs.pop_back();
+		}
+		else
+		{
+			job = std::move(queue.jobs.front());
+			queue.jobs.pop_front();
+		}
+		m_Queued.fetch_sub(1);
+		return true;
+	}
+
+	// Runs one queued job, its own first when called on a worker
+	bool run_one()
+	{
+		std::function<void()> job;
+		size_t first = 0;
+		if (is_worker())
+		{
+			first = current().index;
+			if (pop(first, true, job))
+			{
+				job();
+				return true;
+			}
+		}
+		for (size_t i = 1; i <= m_Queues.size(); ++i)
+		{
+			if (pop((first + i) % m_Queues.size(), false, job))
+			{
+				job();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void work(size_t index)
+	{
+		current() = { this, index };
+		for (;;)
+		{
+			if (run_one())
+				continue;
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_WakeUp.wait(lock, [this] { return m_Stop || m_Queued.load() > 0; });
+			if (m_Stop && m_Queued.load() == 0)
+				return;
+		}
+	}
+public:
+	explicit ThreadPool(size_t threads = std::max(1u, std::thread::hardware_concurrency()))
+	{
+		threads = std::max<size_t>(threads, 1);
+		for (size_t i = 0; i < threads; ++i)
+			m_Queues.push_back(std::make_unique<Queue>());
+		for (size_t i = 0; i < threads; ++i)
+			m_Threads.emplace_back(&ThreadPool::work, this, i);
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Stop = true;
+		}
+		m_WakeUp.notify_all();
+		for (auto& thread : m_Threads)
+			thread.join();
+	}
+
+	size_t size() const
+	{
+		return m_Threads.size();
+	}
+
+	// Queues job on the calling worker, or on the workers in turn when called
+	// from another thread
+	void submit(std::function<void()> job)
+	{
+		size_t index = is_worker() ? current().index : m_Next.fetch_add(1) % m_Queues.size();
+		{
+			std::lock_guard<std::mutex> lock(m_Queues[index]->mutex);
+			m_Queues[index]->jobs.push_back(std::move(job));
+		}
+		m_Queued.fetch_add(1);
+		// Taken so a worker can't miss the job between checking and waiting
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+		}
+		m_WakeUp.notify_one();
+	}
+
+	// Calls body(begin, end) over [0, count) in chunks of grain, on the
+	// workers and the calling thread, and returns when all are done.  The
+	// caller runs other queued jobs while it waits, and sleeps once there are
+	// none.  The first exception a chunk throws is rethrown here.
+	template<typename Body>
+	void parallel_for(size_t count, size_t grain, Body body)
+	{
+		grain = std::max<size_t>(grain, 1);
+		size_t chunks = (count + grain - 1) / grain;
+		if (chunks <= 1)
+		{
+			body(size_t(0), count);
+			return;
+		}
+		std::mutex mutex;
+		std::condition_variable done;
+		size_t remaining = chunks;
+		std::exception_ptr error;
+		auto run_chunk = [&](size_t chunk)
+		{
+			std::exception_ptr thrown;
+			try
+			{
+				body(chunk * grain, std::min(count, (chunk + 1) * grain));
+			}
+			catch (...)
+			{
+				thrown = std::current_exception();
+			}
+			// Notified under the lock, as the waiter destroys done on return
+			std::lock_guard<std::mutex> lock(mutex);
+			if (thrown && !error)
+				error = thrown;
+			if (--remaining == 0)
+				done.notify_one();
+		};
+		for (size_t chunk = 1; chunk < chunks; ++chunk)
+			submit([&run_chunk, chunk] { run_chunk(chunk); });
+		run_chunk(0);
+		// Once nothing is queued, the chunks left are running on other threads
+		for (;;)
+		{
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (remaining == 0)
+					break;
+			}
+			if (!run_one())
+			{
+				std::unique_lock<std::mutex> lock(mutex);
+				done.wait(lock, [&] { return remaining == 0; });
+				break;
+			}
+		}
+		if (error)
+			std::rethrow_exception(error);
+	}
+};